@@ -18,9 +18,11 @@
 #include "zip/zip_file.h"
 #include "base/utils.h"
 #include "base/macros.h"
+#include "base/time_profile.h"
 #include "common/bit.h"
 #include "common/elf.h"
 #include "android.h"
+#include "heap_walk.h"
 #include "fdtrack/fdtrack.h"
 #include "unwindstack/Unwinder.h"
 #include "properties/property.h"
@@ -65,13 +67,41 @@
 #include "base/length_prefixed_array.h"
 #include "base/mem_map.h"
 #include "logcat/log.h"
+#include "runtime/class_index.h"
+#include "runtime/class_hierarchy.h"
+#include "runtime/class_layout.h"
+#include "runtime/code_index.h"
+#include "runtime/dex_pc_index.h"
+#include "runtime/method_index.h"
 #include <stdio.h>
 
 std::unique_ptr<Android> Android::INSTANCE = nullptr;
 
-void Android::Init() {
+void Android::Init(int sdk, int oat) {
     INSTANCE = std::make_unique<Android>();
-    INSTANCE->init();
+    INSTANCE->init(sdk, oat);
+}
+
+std::unique_ptr<Android> Android::Detach() {
+    // process-wide caches point into the current core
+    art::Runtime::Origin() = 0x0;
+    art::CacheHelper::Clean();
+    art::mirror::Class::CleanDescriptorCache();
+    art::ClassIndex::Clean();
+    art::ClassHierarchy::Clean();
+    art::ClassLayout::Clean();
+    art::CodeIndex::Clean();
+    art::DexPcIndex::Clean();
+    art::MethodIndex::Clean();
+    art::DexFile::CleanStringTables();
+    art::CodeInfo::CleanCache();
+    return std::move(INSTANCE);
+}
+
+void Android::Attach(std::unique_ptr<Android>& android, bool reload) {
+    INSTANCE = std::move(android);
+    if (INSTANCE && reload)
+        INSTANCE->reload();
 }
 
 Android::~Android() {
@@ -95,11 +125,15 @@ int Android::Sdk2Trunk(int sdk) {
     return kTrunkData[sdk];
 }
 
-void Android::init() {
-    preLoad();
+void Android::init(int saved_sdk, int saved_oat) {
+    {
+        TimeProfile::Scope scope("android: preload");
+        preLoad();
+    }
+    TimeProfile::Scope scope("android: properties");
     trunk = android::Property::GetInt32("ro.build.version.trunk");
-    sdk = android::Property::GetInt32("ro.build.version.sdk");
-    if (trunk > Sdk2Trunk(sdk)) {
+    sdk = saved_sdk ? saved_sdk : android::Property::GetInt32("ro.build.version.sdk");
+    if (!saved_sdk && trunk > Sdk2Trunk(sdk)) {
         LOGW("current trunk(%d) no match sdk(%d).\n", trunk, sdk);
         int trunk_size = sizeof(kTrunkData) / sizeof(kTrunkData[0]);
         for (int cur = sdk + 1; cur < trunk_size; ++cur) {
@@ -126,9 +160,27 @@ void Android::init() {
     time = android::Property::Get("ro.build.date.utc", INVALID_VALUE);
     debuggable = android::Property::Get("ro.debuggable", INVALID_VALUE);
     preLoadLater();
+    if (saved_oat) {
+        // seeds the header, OatPrepare no longer looks up kOatVersion.
+        oat = saved_oat;
+        oat_header_.kOatVersion = saved_oat;
+        oatPreLoadLater();
+    }
     CoreApi::RegisterSysRootListener(OnLibartLoad);
 }
 
+/*
+ * offset tables are process-wide, cores from the same build share them,
+ * only a core from another build needs to rebuild them on switch.
+ */
+void Android::reload() {
+    mSdkListeners.clear();
+    mOatListeners.clear();
+    preLoad();
+    preLoadLater();
+    if (oat) oatPreLoadLater();
+}
+
 void Android::preLoad() {
     android::Property::Init();
     android::Logcat::Init();
@@ -194,10 +246,10 @@ void Android::preLoad() {
 }
 
 void Android::preLoadLater() {
-    if (Sdk() > Q) {
+    if (sdk > Q) {
         realLibart = (CoreApi::Bits() == 64) ? LIBART64 : LIBART32;
     } else {
-        if (Sdk() > P) {
+        if (sdk > P) {
             realLibart = (CoreApi::Bits() == 64) ? LIBART64_LV29 : LIBART32_LV29;
         } else {
             realLibart = (CoreApi::Bits() == 64) ? LIBART64_LV28 : LIBART32_LV28;
@@ -205,6 +257,17 @@ void Android::preLoadLater() {
     }
 
     LOGI("Switch android(%d) env.\n", sdk);
+    art::mirror::Class::CleanDescriptorCache();
+    art::ClassIndex::Clean();
+    art::ClassHierarchy::Clean();
+    art::ClassLayout::Clean();
+    art::CodeIndex::Clean();
+    art::DexPcIndex::Clean();
+    art::MethodIndex::Clean();
+    art::DexFile::CleanStringTables();
+    art::CodeInfo::CleanCache();
+
+    TimeProfile::Scope scope("android: art offsets");
     for (const auto& listener : mSdkListeners) {
         listener->execute(sdk);
     }
@@ -212,6 +275,7 @@ void Android::preLoadLater() {
 
 void Android::oatPreLoadLater() {
     LOGI("Switch oat version(%d) env.\n", oat_header_.kOatVersion);
+    TimeProfile::Scope scope("android: art offsets");
     for (const auto& listener : mOatListeners) {
         listener->execute(oat_header_.kOatVersion);
     }
@@ -371,49 +435,7 @@ void Android::ForeachObjects(std::function<bool (art::mirror::Object& object)> f
 }
 
 void Android::ForeachObjects(std::function<bool (art::mirror::Object& object)> fn, int flag, bool check) {
-    art::Runtime& runtime = art::Runtime::Current();
-    art::gc::Heap& heap = runtime.GetHeap();
-
-    auto walkfn = [&](art::gc::space::Space* space) {
-        LOGD("Walk [%s] ...\n", space->GetName());
-        try {
-            if (space->IsVaildSpace()) {
-                space->Walk(fn, check);
-            } else {
-                LOGE("%s invalid space.\n", space->GetName());
-            }
-        } catch (InvalidAddressException& e) {
-            LOGW("Walk [%s] was interrupted!\n", space->GetName());
-        }
-    };
-
-    for (const auto& space : heap.GetContinuousSpaces()) {
-        if (space->IsImageSpace()) {
-            if (flag & EACH_IMAGE_OBJECTS) walkfn(space.get());
-        } else if (space->IsZygoteSpace()) {
-            if (flag & EACH_ZYGOTE_OBJECTS) walkfn(space.get());
-        } else if (space->IsRegionSpace() || space->IsBumpPointerSpace()) {
-            if (flag & EACH_APP_OBJECTS) walkfn(space.get());
-        } else if (space->IsMallocSpace()) {
-            if (space->IsRosAllocSpace()) {
-                if (flag & EACH_APP_OBJECTS) walkfn(space.get());
-            } else if (space->IsDlMallocSpace()) {
-                if (flag & EACH_APP_OBJECTS) walkfn(space.get());
-            }
-        } else if (space->IsFakeSpace()) {
-            if (flag & EACH_FAKE_OBJECTS) walkfn(space.get());
-        } else {
-            if (space->GetType() != art::gc::space::kSpaceTypeInvalidSpace) {
-                walkfn(space.get());
-            } else {
-                LOGE("please run sysroot libart.so and run env art -c, %s invalid space.\n", space->GetName());
-            }
-        }
-    }
-
-    for (const auto& space : heap.GetDiscontinuousSpaces()) {
-        if (flag & EACH_APP_OBJECTS) walkfn(space.get());
-    }
+    ForEachObject(fn, flag, check);
 }
 
 void Android::ForeachReferences(std::function<bool (art::mirror::Object& object)> fn) {
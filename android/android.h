@@ -18,6 +18,7 @@
 #define ANDROID_ANDROID_H_
 
 #include "api/core.h"
+#include "base/macros.h"
 #include "runtime/oat.h"
 #include "runtime/runtime.h"
 #include "runtime/art_field.h"
@@ -96,8 +97,12 @@ public:
     static bool IsReady() { return INSTANCE != nullptr; }
     static bool IsSdkReady() { return IsReady() && Sdk() >= M; }
     static bool IsOatReady() { return IsReady() && Oat() > 0; }
-    static void Init();
+    // sdk and oat known ahead (restored session) skip the property probe
+    static void Init(int sdk = 0, int oat = 0);
     static void Reset() { Init(); }
+    // park and restore android env when switching loaded cores
+    static std::unique_ptr<Android> Detach();
+    static void Attach(std::unique_ptr<Android>& android, bool reload);
     static void Dump();
     static int Sdk2Trunk(int sdk);
     static int Trunk() { return INSTANCE->trunk; }
@@ -176,6 +181,17 @@ public:
      */
     static void ForeachObjects(std::function<bool (art::mirror::Object& object)> fn);
     static void ForeachObjects(std::function<bool (art::mirror::Object& object)> fn, int flag, bool check);
+    /*
+     * Header only ForeachObjects, the visitor is inlined into the image,
+     * zygote and region space walkers. Other spaces take the std::function
+     * path. Keep ForeachObjects for plugins. Defined in heap_walk.h.
+     */
+    template <typename Visitor>
+    static void ForEachObject(Visitor&& visitor, int flag, bool check);
+    template <typename Visitor>
+    static void ForEachObject(Visitor&& visitor) {
+        ForEachObject(visitor, EACH_IMAGE_OBJECTS | EACH_ZYGOTE_OBJECTS | EACH_APP_OBJECTS | EACH_FAKE_OBJECTS, false);
+    }
 
     static constexpr int EACH_LOCAL_REFERENCES = 1 << 0;
     static constexpr int EACH_GLOBAL_REFERENCES = 1 << 1;
@@ -194,7 +210,8 @@ public:
     static void ForeachReferences(std::function<bool (art::mirror::Object& object, int type, uint64_t idx)> fn, int flag);
 
 private:
-    void init();
+    void init(int saved_sdk, int saved_oat);
+    void reload();
     void onSdkChanged(int sdk);
     void onOatChanged(int oat);
     void preLoad();
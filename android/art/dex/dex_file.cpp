@@ -19,6 +19,7 @@
 #include "logger/log.h"
 #include "dex/dex_file.h"
 #include "base/leb128.h"
+#include "common/exception.h"
 #include "dex/descriptors_names.h"
 
 struct DexFile_OffsetTable __DexFile_offset__;
@@ -26,6 +27,9 @@ struct DexFile_SizeTable __DexFile_size__;
 
 namespace art {
 
+std::mutex DexFile::kStringTablesLock;
+std::unordered_map<uint64_t, std::shared_ptr<DexFile::StringTables>> DexFile::kStringTables;
+
 void DexFile::Init() {
     Android::RegisterSdkListener(Android::M, art::DexFile::Init23);
     Android::RegisterSdkListener(Android::N, art::DexFile::Init24);
@@ -409,8 +413,89 @@ const char* DexFile::StringDataAndUtf16LengthByIdx(dex::StringIndex idx, uint32_
         *utf16_length = 0;
         return nullptr;
     }
+
+    return reinterpret_cast<const char*>(CoreApi::GetReal(StringDataVaddrByIdx(idx, utf16_length)));
+}
+
+uint64_t DexFile::StringDataVaddrByIdx(dex::StringIndex idx, uint32_t* utf16_length) {
+    StringTables& tables = GetStringTables();
+    bool cached = idx.index_ < tables.num_strings;
+    if (cached) {
+        uint64_t vaddr = tables.strings[idx.index_].load(std::memory_order_acquire);
+        if (vaddr) {
+            *utf16_length = tables.utf16_lengths[idx.index_].load(std::memory_order_relaxed);
+            return vaddr;
+        }
+    }
+
     dex::StringId string_id = GetStringId(idx);
-    return GetStringDataAndUtf16Length(string_id, utf16_length);
+    api::MemoryRef ref(DataBegin().Ptr() + string_id.string_data_off(), string_id);
+    const uint8_t* begin = reinterpret_cast<const uint8_t *>(ref.Real());
+    const uint8_t* ptr = begin;
+    *utf16_length = DecodeUnsignedLeb128(&ptr);
+    uint64_t vaddr = ref.Ptr() + (ptr - begin);
+
+    if (cached) {
+        tables.utf16_lengths[idx.index_].store(*utf16_length, std::memory_order_relaxed);
+        tables.strings[idx.index_].store(vaddr, std::memory_order_release);
+    }
+    return vaddr;
+}
+
+const char* DexFile::GetTypeDescriptor(dex::TypeIndex idx, const char* def) {
+    StringTables& tables = GetStringTables();
+    bool cached = idx.index_ < tables.num_types;
+    if (cached) {
+        uint64_t vaddr = tables.descriptors[idx.index_].load(std::memory_order_acquire);
+        if (vaddr)
+            return reinterpret_cast<const char*>(CoreApi::GetReal(vaddr));
+    }
+
+    dex::TypeId type_id = GetTypeId(idx);
+    if (!type_id.IsValid()) {
+        dumpReason(type_id.Ptr());
+        return def;
+    }
+    dex::StringIndex descriptor_idx(type_id.descriptor_idx());
+    if (!descriptor_idx.IsValid())
+        return nullptr;
+
+    uint32_t utf16_length;
+    uint64_t vaddr = StringDataVaddrByIdx(descriptor_idx, &utf16_length);
+    if (cached)
+        tables.descriptors[idx.index_].store(vaddr, std::memory_order_release);
+    return reinterpret_cast<const char*>(CoreApi::GetReal(vaddr));
+}
+
+DexFile::StringTables& DexFile::GetStringTables() {
+    if (!string_tables_cache) {
+        std::lock_guard<std::mutex> lock(kStringTablesLock);
+        std::shared_ptr<StringTables>& tables = kStringTables[Ptr()];
+        if (!tables) {
+            tables = std::make_shared<StringTables>();
+            // header: string_ids_size at 0x38, type_ids_size at 0x40, standard and compact.
+            try {
+                api::MemoryRef dex_header(header(), this);
+                uint64_t limit = data_size();
+                uint32_t num_strings = dex_header.value32Of(0x38);
+                uint32_t num_types = dex_header.value32Of(0x40);
+                if (static_cast<uint64_t>(num_strings) * SIZEOF(StringId) <= limit)
+                    tables->num_strings = num_strings;
+                if (static_cast<uint64_t>(num_types) * SIZEOF(TypeId) <= limit)
+                    tables->num_types = num_types;
+            } catch (InvalidAddressException& e) {}
+            tables->strings.reset(new std::atomic<uint64_t>[tables->num_strings]());
+            tables->utf16_lengths.reset(new std::atomic<uint32_t>[tables->num_strings]());
+            tables->descriptors.reset(new std::atomic<uint64_t>[tables->num_types]());
+        }
+        string_tables_cache = tables;
+    }
+    return *string_tables_cache;
+}
+
+void DexFile::CleanStringTables() {
+    std::lock_guard<std::mutex> lock(kStringTablesLock);
+    kStringTables.clear();
 }
 
 dex::StringId DexFile::GetStringId(dex::StringIndex idx) {
@@ -436,8 +521,7 @@ const char* DexFile::GetFieldTypeDescriptor(dex::FieldId& field_id, const char*
         return def;
     }
     dex::TypeIndex idx(field_id.type_idx());
-    dex::TypeId type_id = GetTypeId(idx);
-    return GetTypeDescriptor(type_id, def);
+    return GetTypeDescriptor(idx, def);
 }
 
 const char* DexFile::GetFieldDeclaringClassDescriptor(dex::FieldId& field_id, const char* def) {
@@ -446,8 +530,7 @@ const char* DexFile::GetFieldDeclaringClassDescriptor(dex::FieldId& field_id, co
         return def;
     }
     dex::TypeIndex class_idx(field_id.class_idx());
-    dex::TypeId class_id = GetTypeId(class_idx);
-    return GetTypeDescriptor(class_id, def);
+    return GetTypeDescriptor(class_idx, def);
 }
 
 const char* DexFile::GetFieldName(dex::FieldId& field_id, const char* def) {
@@ -481,8 +564,7 @@ std::string DexFile::GetMethodParametersDescriptor(dex::ProtoId& proto_id) {
         result.append("(");
         for (uint32_t i = 0; i < list.size(); ++i) {
             dex::TypeIndex idx(ref.value16Of(i * SIZEOF(TypeItem)));
-            dex::TypeId type_id = GetTypeId(idx);
-            result.append(GetTypeDescriptor(type_id, "V"));
+            result.append(GetTypeDescriptor(idx, "V"));
         }
         result.append(")");
         return result;
@@ -507,9 +589,8 @@ std::string DexFile::PrettyMethodParameters(dex::MethodId& method_id) {
                 result.append(", ");
             }
             dex::TypeIndex idx(ref.value16Of(i * SIZEOF(TypeItem)));
-            dex::TypeId type_id = GetTypeId(idx);
             std::string tmp;
-            AppendPrettyDescriptor(GetTypeDescriptor(type_id, "V"), &tmp);
+            AppendPrettyDescriptor(GetTypeDescriptor(idx, "V"), &tmp);
             result.append(tmp);
         }
         result.append(")");
@@ -524,8 +605,7 @@ const char* DexFile::GetMethodDeclaringClassDescriptor(dex::MethodId& method_id,
         return def;
     }
     dex::TypeIndex class_idx(method_id.class_idx());
-    dex::TypeId class_id = GetTypeId(class_idx);
-    return GetTypeDescriptor(class_id, def);
+    return GetTypeDescriptor(class_idx, def);
 }
 
 const char* DexFile::GetMethodReturnTypeDescriptor(dex::MethodId& method_id, const char* def) {
@@ -535,8 +615,7 @@ const char* DexFile::GetMethodReturnTypeDescriptor(dex::MethodId& method_id, con
     }
     dex::ProtoId proto_id = GetMethodPrototype(method_id);
     dex::TypeIndex return_type_idx(proto_id.return_type_idx());
-    dex::TypeId return_type_id = GetTypeId(return_type_idx);
-    return GetTypeDescriptor(return_type_id);
+    return GetTypeDescriptor(return_type_idx);
 }
 
 const char* DexFile::GetMethodShorty(dex::MethodId& method_id, uint32_t* length) {
@@ -22,6 +22,11 @@
 #include "dex/dex_file_structs.h"
 #include "runtime/oat/oat_file.h"
 #include "cxx/string.h"
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
 
 struct DexFile_OffsetTable {
     uint32_t begin_;
@@ -75,6 +80,7 @@ public:
     inline uint64_t data_begin() { return VALUEOF(DexFile, data_begin_); }
     inline uint64_t data_size() { return VALUEOF(DexFile, data_size_); }
     inline uint64_t location() { return Ptr() + OFFSET(DexFile, location_); }
+    inline uint64_t header() { return VALUEOF(DexFile, header_); }
     inline uint32_t location_checksum() { return value32Of(OFFSET(DexFile, location_checksum_)); }
     inline uint64_t type_ids() { return VALUEOF(DexFile, type_ids_); }
     inline uint64_t string_ids() { return VALUEOF(DexFile, string_ids_); }
@@ -92,6 +98,8 @@ public:
     dex::ProtoId GetProtoId(dex::ProtoIndex idx);
     inline const char* GetTypeDescriptor(dex::TypeId& type_id) { return GetTypeDescriptor(type_id, "L<invalid-class>;"); }
     const char* GetTypeDescriptor(dex::TypeId& type_id, const char* def);
+    inline const char* GetTypeDescriptor(dex::TypeIndex idx) { return GetTypeDescriptor(idx, "L<invalid-class>;"); }
+    const char* GetTypeDescriptor(dex::TypeIndex idx, const char* def);
     const char* StringDataByIdx(dex::StringIndex idx);
     const char* StringDataAndUtf16LengthByIdx(dex::StringIndex idx, uint32_t* utf16_length);
     dex::StringId GetStringId(dex::StringIndex idx);
@@ -115,7 +123,31 @@ public:
     inline bool IsStandardDexFile() { return !is_compact_dex(); }
     const char* GetMethodShorty(dex::MethodId& method_id, uint32_t* length);
     void dumpReason(uint64_t vaddr);
+
+    /*
+     * Core addresses of string data and type descriptors already read from
+     * this dex file, shared by all DexFile refs of the same address. Slots
+     * are sized once from the dex header and filled without a lock, a hit
+     * maps the address again, so a trimmed xz core is decoded again rather
+     * than read through a stale pointer.
+     */
+    struct StringTables {
+        uint32_t num_strings = 0;
+        uint32_t num_types = 0;
+        // 0 until filled, utf16 length is stored before the string.
+        std::unique_ptr<std::atomic<uint64_t>[]> strings;
+        std::unique_ptr<std::atomic<uint32_t>[]> utf16_lengths;
+        std::unique_ptr<std::atomic<uint64_t>[]> descriptors;
+    };
+    StringTables& GetStringTables();
+    static void CleanStringTables();
 private:
+    uint64_t StringDataVaddrByIdx(dex::StringIndex idx, uint32_t* utf16_length);
+
+    std::shared_ptr<StringTables> string_tables_cache;
+    static std::mutex kStringTablesLock;
+    static std::unordered_map<uint64_t, std::shared_ptr<StringTables>> kStringTables;
+
     // quick memoryref cache
     DEFINE_QUICK_CACHE(api::MemoryRef, data_begin);
     DEFINE_QUICK_CACHE_COPY(dex::TypeId, type_ids, data_begin);
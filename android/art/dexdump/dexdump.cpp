@@ -600,9 +600,8 @@ void Dexdump::AppendCodecArgsvAATypeBBBB(const char* op, api::MemoryRef& ref, st
     sb.append(std::to_string(vaa));
     sb.append(", ");
     dex::TypeIndex type(code1);
-    dex::TypeId tid = dex_file.GetTypeId(type);
     std::string result;
-    AppendPrettyDescriptor(dex_file.GetTypeDescriptor(tid), &result);
+    AppendPrettyDescriptor(dex_file.GetTypeDescriptor(type), &result);
     sb.append(result);
     sb.append(" // type@");
     sb.append(std::to_string(type.Index()));
@@ -630,9 +629,8 @@ void Dexdump::AppendCodecArgsvAvBTypeCCCC(const char* op, api::MemoryRef& ref, s
     sb.append(std::to_string(vb));
     sb.append(", ");
     dex::TypeIndex type(code1);
-    dex::TypeId tid = dex_file.GetTypeId(type);
     std::string result;
-    AppendPrettyDescriptor(dex_file.GetTypeDescriptor(tid), &result);
+    AppendPrettyDescriptor(dex_file.GetTypeDescriptor(type), &result);
     sb.append(result);
     sb.append(" // type@");
     sb.append(std::to_string(type.Index()));
@@ -984,9 +982,8 @@ void Dexdump::AppendCodecFilledNewArray(api::MemoryRef& ref, std::string& sb, De
     }
     sb.append("}, ");
     dex::TypeIndex type(code1);
-    dex::TypeId tid = dex_file.GetTypeId(type);
     std::string result;
-    AppendPrettyDescriptor(dex_file.GetTypeDescriptor(tid), &result);
+    AppendPrettyDescriptor(dex_file.GetTypeDescriptor(type), &result);
     sb.append(result);
     sb.append(" // type@");
     sb.append(std::to_string(type.Index()));
@@ -1013,9 +1010,8 @@ void Dexdump::AppendCodecFilledNewArrayRange(api::MemoryRef& ref, std::string& s
     sb.append(std::to_string(vaaaa + num - 1));
     sb.append("}, ");
     dex::TypeIndex type(code1);
-    dex::TypeId tid = dex_file.GetTypeId(type);
     std::string result;
-    AppendPrettyDescriptor(dex_file.GetTypeDescriptor(tid), &result);
+    AppendPrettyDescriptor(dex_file.GetTypeDescriptor(type), &result);
     sb.append(result);
     sb.append(" // type@");
     sb.append(std::to_string(type.Index()));
@@ -1602,9 +1598,8 @@ void Dexdump::AppendCodecInvokePolymorphic(api::MemoryRef& ref, std::string& sb,
     dex::ProtoIndex proto_idx(code3);
     dex::ProtoId pid = dex_file.GetProtoId(proto_idx);
     dex::TypeIndex return_type_idx(pid.return_type_idx());
-    dex::TypeId return_type_id = dex_file.GetTypeId(return_type_idx);
     sb.append(dex_file.GetMethodParametersDescriptor(pid));
-    sb.append(dex_file.GetTypeDescriptor(return_type_id));
+    sb.append(dex_file.GetTypeDescriptor(return_type_idx));
     sb.append(" // method@");
     sb.append(std::to_string(method_idx));
     sb.append(", ");
@@ -1649,9 +1644,8 @@ void Dexdump::AppendCodecInvokePolymorphicRange(api::MemoryRef& ref, std::string
     dex::ProtoIndex proto_idx(code3);
     dex::ProtoId pid = dex_file.GetProtoId(proto_idx);
     dex::TypeIndex return_type_idx(pid.return_type_idx());
-    dex::TypeId return_type_id = dex_file.GetTypeId(return_type_idx);
     sb.append(dex_file.GetMethodParametersDescriptor(pid));
-    sb.append(dex_file.GetTypeDescriptor(return_type_id));
+    sb.append(dex_file.GetTypeDescriptor(return_type_idx));
     sb.append(" // method@");
     sb.append(std::to_string(method_idx));
     sb.append(", ");
@@ -1757,9 +1751,8 @@ void Dexdump::AppendCodecConstMethodType(api::MemoryRef& ref, std::string& sb, D
     dex::ProtoIndex proto_idx(bbbb);
     dex::ProtoId pid = dex_file.GetProtoId(proto_idx);
     dex::TypeIndex return_type_idx(pid.return_type_idx());
-    dex::TypeId return_type_id = dex_file.GetTypeId(return_type_idx);
     sb.append(dex_file.GetMethodParametersDescriptor(pid));
-    sb.append(dex_file.GetTypeDescriptor(return_type_id));
+    sb.append(dex_file.GetTypeDescriptor(return_type_idx));
     sb.append(" // proto@");
     sb.append(std::to_string(bbbb));
 }
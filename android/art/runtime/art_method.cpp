@@ -249,8 +249,7 @@ dex::TypeIndex ArtMethod::GetReturnTypeIndex() {
 const char* ArtMethod::GetReturnTypeDescriptor() {
     DexFile& dex_file = GetDexFile();
     dex::TypeIndex type_idx(GetReturnTypeIndex());
-    dex::TypeId type_id = dex_file.GetTypeId(type_idx);
-    return dex_file.GetTypeDescriptor(type_id);
+    return dex_file.GetTypeDescriptor(type_idx);
 }
 
 std::string ArtMethod::PrettyReturnTypeDescriptor() {
@@ -461,6 +460,17 @@ static const OatFile::OatMethod FindOatMethodFor(ArtMethod& method,
     return oat_class.GetOatMethod(oat_method_index);
 }
 
+uint64_t ArtMethod::GetOatQuickCode() {
+    if (IsRuntimeMethod())
+        return 0x0;
+
+    bool found = false;
+    OatFile::OatMethod oat_method = FindOatMethodFor(*this, CoreApi::GetPointSize(), &found);
+    if (!found)
+        return 0x0;
+    return oat_method.GetQuickCode();
+}
+
 OatQuickMethodHeader ArtMethod::GetOatQuickMethodHeader(uint64_t pc) {
     if (IsRuntimeMethod()) {
         return 0x0;
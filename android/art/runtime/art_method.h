@@ -431,6 +431,8 @@ public:
     uint32_t EntryPointFromQuickCompiledCodeOffset(uint32_t pointer_size);
     uint64_t GetNativePointer(uint32_t offset, uint32_t pointer_size);
     OatQuickMethodHeader GetOatQuickMethodHeader(uint64_t pc);
+    // quick code of this method in its oat file, 0x0 if not compiled.
+    uint64_t GetOatQuickCode();
     inline const char* GetShorty() {
         uint32_t unused_length;
         return GetShorty(&unused_length);
@@ -0,0 +1,168 @@
+/*
+ * Copyright (C) 2024-present, Guanyou.Chen. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "logger/log.h"
+#include "runtime/class_hierarchy.h"
+#include "runtime/class_index.h"
+#include "runtime/mirror/iftable.h"
+#include "common/exception.h"
+#include <algorithm>
+
+namespace art {
+
+bool ClassHierarchy::kReady = false;
+bool ClassHierarchy::kAttempted = false;
+std::vector<ClassHierarchy::Node> ClassHierarchy::kNodes;
+std::vector<uint32_t> ClassHierarchy::kOrder;
+std::unordered_map<uint64_t, uint32_t> ClassHierarchy::kNodeIndex;
+std::unordered_map<uint64_t, std::vector<uint32_t>> ClassHierarchy::kImplementors;
+
+void ClassHierarchy::Build() {
+    Clean();
+
+    auto collect = [&](mirror::Class& clazz) -> bool {
+        kNodeIndex[clazz.Ptr()] = kNodes.size();
+        kNodes.push_back({clazz.Ptr(), INVALID_NODE, INVALID_NODE, INVALID_NODE});
+        return false;
+    };
+    ClassIndex::Foreach(collect);
+
+    std::vector<std::vector<uint32_t>> children(kNodes.size());
+    std::vector<uint32_t> roots;
+    for (uint32_t idx = 0; idx < kNodes.size(); ++idx) {
+        Node& node = kNodes[idx];
+        mirror::Class clazz = node.klass;
+        try {
+            mirror::Class super = clazz.GetSuperClass();
+            node.super = super.Ptr() ? NodeOf(super.Ptr()) : INVALID_NODE;
+
+            mirror::IfTable& iftable = clazz.GetIfTable();
+            int32_t ifcount = (iftable.Ptr() && iftable.IsValid()) ? iftable.Count() : 0;
+            for (int32_t i = 0; i < ifcount; ++i)
+                kImplementors[iftable.GetInterface(i)].push_back(idx);
+        } catch (InvalidAddressException& e) {
+            node.super = INVALID_NODE;
+        }
+
+        if (node.super != INVALID_NODE) {
+            children[node.super].push_back(idx);
+        } else {
+            roots.push_back(idx);
+        }
+    }
+
+    // iterative dfs, the superclass chain of a deep app can exceed stack.
+    kOrder.reserve(kNodes.size());
+    std::vector<std::pair<uint32_t, uint32_t>> stack;
+    for (const auto& root : roots) {
+        kNodes[root].pre = kOrder.size();
+        kOrder.push_back(root);
+        stack.push_back(std::pair<uint32_t, uint32_t>(root, 0));
+        while (!stack.empty()) {
+            auto& top = stack.back();
+            if (top.second < children[top.first].size()) {
+                uint32_t child = children[top.first][top.second++];
+                kNodes[child].pre = kOrder.size();
+                kOrder.push_back(child);
+                stack.push_back(std::pair<uint32_t, uint32_t>(child, 0));
+            } else {
+                kNodes[top.first].last = kOrder.size() - 1;
+                stack.pop_back();
+            }
+        }
+    }
+    kReady = true;
+    LOGD("ClassHierarchy build %ld classes, %ld interfaces.\n", kNodes.size(), kImplementors.size());
+}
+
+void ClassHierarchy::Prepare() {
+    if (kReady || kAttempted)
+        return;
+
+    try {
+        Build();
+    } catch (InvalidAddressException& e) {
+        LOGW("ClassHierarchy build was interrupted!\n");
+        Clean();
+    }
+    kAttempted = true;
+}
+
+void ClassHierarchy::Clean() {
+    kReady = false;
+    kAttempted = false;
+    kNodes.clear();
+    kOrder.clear();
+    kNodeIndex.clear();
+    kImplementors.clear();
+}
+
+uint32_t ClassHierarchy::NodeOf(uint64_t klass) {
+    auto it = kNodeIndex.find(klass);
+    return it != kNodeIndex.end() ? it->second : INVALID_NODE;
+}
+
+bool ClassHierarchy::IsSubClassOf(mirror::Class& klass, mirror::Class& super) {
+    Prepare();
+    uint32_t k = NodeOf(klass.Ptr());
+    uint32_t s = NodeOf(super.Ptr());
+    if (k == INVALID_NODE || s == INVALID_NODE
+            || kNodes[k].pre == INVALID_NODE || kNodes[s].pre == INVALID_NODE)
+        return false;
+    return kNodes[s].pre <= kNodes[k].pre && kNodes[k].pre <= kNodes[s].last;
+}
+
+bool ClassHierarchy::Implements(mirror::Class& klass, mirror::Class& interface) {
+    Prepare();
+    auto it = kImplementors.find(interface.Ptr());
+    uint32_t k = NodeOf(klass.Ptr());
+    if (it == kImplementors.end() || k == INVALID_NODE)
+        return false;
+    return std::binary_search(it->second.begin(), it->second.end(), k);
+}
+
+bool ClassHierarchy::InstanceOf(mirror::Class& klass, mirror::Class& target) {
+    return IsSubClassOf(klass, target) || Implements(klass, target);
+}
+
+void ClassHierarchy::ForeachSubClass(mirror::Class& super, std::function<bool (mirror::Class& clazz)> fn) {
+    Prepare();
+    uint32_t s = NodeOf(super.Ptr());
+    if (s == INVALID_NODE || kNodes[s].pre == INVALID_NODE)
+        return;
+
+    for (uint32_t pre = kNodes[s].pre + 1; pre <= kNodes[s].last; ++pre) {
+        mirror::Class clazz = kNodes[kOrder[pre]].klass;
+        if (fn(clazz))
+            break;
+    }
+}
+
+void ClassHierarchy::ForeachImplementor(mirror::Class& interface, std::function<bool (mirror::Class& clazz)> fn) {
+    Prepare();
+    auto it = kImplementors.find(interface.Ptr());
+    if (it == kImplementors.end())
+        return;
+
+    for (const auto& idx : it->second) {
+        mirror::Class clazz = kNodes[idx].klass;
+        if (fn(clazz))
+            break;
+    }
+}
+
+} // namespace art
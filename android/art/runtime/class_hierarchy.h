@@ -0,0 +1,77 @@
+/*
+ * Copyright (C) 2024-present, Guanyou.Chen. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef ANDROID_ART_RUNTIME_CLASS_HIERARCHY_H_
+#define ANDROID_ART_RUNTIME_CLASS_HIERARCHY_H_
+
+#include "runtime/mirror/class.h"
+#include <stdint.h>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+namespace art {
+
+/*
+ * Superclass tree of all indexed classes numbered in pre-order, each
+ * class owns the interval [pre, last] of its subtree, so a subclass
+ * test is two compares. Interfaces form a DAG and keep their flattened
+ * implementor lists from iftable instead.
+ *
+ * Like ClassIndex, consumers call Prepare() from their prepare() so the
+ * tree is built once in the parent instead of in every command child.
+ */
+class ClassHierarchy {
+public:
+    static constexpr uint32_t INVALID_NODE = 0xFFFFFFFF;
+
+    struct Node {
+        uint64_t klass;
+        uint32_t super;
+        // INVALID_NODE if not reached from a root, e.g. a superclass cycle.
+        uint32_t pre;
+        uint32_t last;
+    };
+
+    static bool IsReady() { return kReady; }
+    static void Build();
+    static void Prepare();
+    static void Clean();
+
+    // klass == super is a subclass too.
+    static bool IsSubClassOf(mirror::Class& klass, mirror::Class& super);
+    static bool Implements(mirror::Class& klass, mirror::Class& interface);
+    static bool InstanceOf(mirror::Class& klass, mirror::Class& target);
+    static void ForeachSubClass(mirror::Class& super, std::function<bool (mirror::Class& clazz)> fn);
+    static void ForeachImplementor(mirror::Class& interface, std::function<bool (mirror::Class& clazz)> fn);
+private:
+    static uint32_t NodeOf(uint64_t klass);
+
+    static bool kReady;
+    // Prepare() ran, a failed build is not retried on every lookup.
+    static bool kAttempted;
+    static std::vector<Node> kNodes;
+    // pre-order number to node
+    static std::vector<uint32_t> kOrder;
+    static std::unordered_map<uint64_t, uint32_t> kNodeIndex;
+    // interface to sorted implementor nodes
+    static std::unordered_map<uint64_t, std::vector<uint32_t>> kImplementors;
+};
+
+} // namespace art
+
+#endif // ANDROID_ART_RUNTIME_CLASS_HIERARCHY_H_
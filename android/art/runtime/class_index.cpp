@@ -0,0 +1,183 @@
+/*
+ * Copyright (C) 2024-present, Guanyou.Chen. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "logger/log.h"
+#include "android.h"
+#include "heap_walk.h"
+#include "runtime/class_index.h"
+#include "common/exception.h"
+#include <string.h>
+#include <algorithm>
+#include <regex>
+
+namespace art {
+
+bool ClassIndex::kReady = false;
+bool ClassIndex::kAttempted = false;
+std::vector<ClassIndex::Entry> ClassIndex::kEntries;
+std::unordered_map<std::string, uint32_t> ClassIndex::kDescriptors;
+std::unordered_multimap<std::string, uint32_t> ClassIndex::kSimpleNames;
+
+void ClassIndex::Build() {
+    Clean();
+
+    // only a finished walk makes the index ready.
+    std::vector<Entry> entries;
+    auto callback = [&](mirror::Object& object) -> bool {
+        if (!object.IsClass())
+            return false;
+
+        mirror::Class clazz = object;
+        try {
+            entries.push_back({clazz.CachedDescriptor(), clazz.Ptr()});
+        } catch (InvalidAddressException& e) {
+            LOGD("Skip class 0x%" PRIx64 " without descriptor.\n", clazz.Ptr());
+        }
+        return false;
+    };
+    Android::ForEachObject(callback);
+
+    Load(entries);
+    LOGD("ClassIndex build %ld classes.\n", kEntries.size());
+}
+
+void ClassIndex::Load(std::vector<Entry>& entries) {
+    Clean();
+
+    auto compare = [](const Entry& a, const Entry& b) -> bool {
+        int ret = a.descriptor.compare(b.descriptor);
+        return ret ? ret < 0 : a.klass < b.klass;
+    };
+    std::sort(entries.begin(), entries.end(), compare);
+
+    kEntries = std::move(entries);
+    for (uint32_t idx = 0; idx < kEntries.size(); ++idx) {
+        const std::string& descriptor = kEntries[idx].descriptor;
+        kDescriptors.insert(std::pair<std::string, uint32_t>(descriptor, idx));
+        std::size_t pos = descriptor.find_last_of('.');
+        kSimpleNames.insert(std::pair<std::string, uint32_t>(
+                pos != std::string::npos ? descriptor.substr(pos + 1) : descriptor, idx));
+    }
+    kReady = true;
+    kAttempted = true;
+}
+
+void ClassIndex::Prepare() {
+    if (kReady || kAttempted)
+        return;
+
+    try {
+        Build();
+    } catch (InvalidAddressException& e) {
+        LOGW("ClassIndex build was interrupted!\n");
+    }
+    kAttempted = true;
+}
+
+void ClassIndex::Clean() {
+    kReady = false;
+    kAttempted = false;
+    kEntries.clear();
+    kDescriptors.clear();
+    kSimpleNames.clear();
+}
+
+bool ClassIndex::Visit(uint32_t idx, std::function<bool (mirror::Class& clazz)>& fn) {
+    mirror::Class clazz = kEntries[idx].klass;
+    return fn(clazz);
+}
+
+mirror::Class ClassIndex::Find(const char* descriptor) {
+    Prepare();
+    auto it = kDescriptors.find(descriptor);
+    if (it != kDescriptors.end())
+        return kEntries[it->second].klass;
+    return 0x0;
+}
+
+void ClassIndex::Find(const char* descriptor, std::function<bool (mirror::Class& clazz)> fn) {
+    Prepare();
+    auto it = kDescriptors.find(descriptor);
+    if (it == kDescriptors.end())
+        return;
+
+    for (uint32_t idx = it->second; idx < kEntries.size(); ++idx) {
+        if (kEntries[idx].descriptor != descriptor || Visit(idx, fn))
+            break;
+    }
+}
+
+void ClassIndex::FindBySimpleName(const char* name, std::function<bool (mirror::Class& clazz)> fn) {
+    Prepare();
+    auto range = kSimpleNames.equal_range(name);
+    std::vector<uint32_t> matches;
+    for (auto it = range.first; it != range.second; ++it)
+        matches.push_back(it->second);
+
+    std::sort(matches.begin(), matches.end());
+    for (const auto& idx : matches) {
+        if (Visit(idx, fn))
+            break;
+    }
+}
+
+void ClassIndex::FindByPrefix(const char* prefix, std::function<bool (mirror::Class& clazz)> fn) {
+    Prepare();
+    std::size_t len = strlen(prefix);
+    auto compare = [](const Entry& entry, const char* value) -> bool {
+        return entry.descriptor.compare(value) < 0;
+    };
+    auto it = std::lower_bound(kEntries.begin(), kEntries.end(), prefix, compare);
+    for (; it != kEntries.end(); ++it) {
+        if (it->descriptor.compare(0, len, prefix))
+            break;
+        if (Visit(it - kEntries.begin(), fn))
+            break;
+    }
+}
+
+void ClassIndex::FindByPackage(const char* package, std::function<bool (mirror::Class& clazz)> fn) {
+    std::string prefix = package;
+    prefix.append(".");
+    auto callback = [&](mirror::Class& clazz) -> bool {
+        const std::string& descriptor = clazz.CachedDescriptor();
+        // skip sub packages
+        if (descriptor.find('.', prefix.length()) != std::string::npos)
+            return false;
+        return fn(clazz);
+    };
+    FindByPrefix(prefix.c_str(), callback);
+}
+
+void ClassIndex::FindByRegex(const char* regex, std::function<bool (mirror::Class& clazz)> fn) {
+    Prepare();
+    std::regex pattern(regex);
+    for (uint32_t idx = 0; idx < kEntries.size(); ++idx) {
+        if (std::regex_search(kEntries[idx].descriptor, pattern) && Visit(idx, fn))
+            break;
+    }
+}
+
+void ClassIndex::Foreach(std::function<bool (mirror::Class& clazz)> fn) {
+    Prepare();
+    for (uint32_t idx = 0; idx < kEntries.size(); ++idx) {
+        if (Visit(idx, fn))
+            break;
+    }
+}
+
+} // namespace art
@@ -0,0 +1,83 @@
+/*
+ * Copyright (C) 2024-present, Guanyou.Chen. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef ANDROID_ART_RUNTIME_CLASS_INDEX_H_
+#define ANDROID_ART_RUNTIME_CLASS_INDEX_H_
+
+#include "runtime/mirror/class.h"
+#include <stdint.h>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace art {
+
+/*
+ * Pretty descriptor index of all class objects in heap, built by one
+ * walk on first lookup. Entries are sorted by descriptor, so a package
+ * or prefix is a contiguous range.
+ *
+ * Command main() runs in a forked child and an index built there dies
+ * with it, so consumers call Prepare() from their prepare(), the index
+ * is then built once in the parent and inherited by every child.
+ * Lookups go through Prepare() too, after an interrupted build they
+ * see an empty index instead of walking the heap again.
+ *
+ *   ClassIndex::Find("android.app.ActivityThread");
+ *   ClassIndex::FindBySimpleName("ActivityThread", fn);
+ *   ClassIndex::FindByPackage("android.app", fn);
+ */
+class ClassIndex {
+public:
+    struct Entry {
+        std::string descriptor;
+        uint64_t klass;
+    };
+
+    static bool IsReady() { return kReady; }
+    static void Build();
+    static void Prepare();
+    static void Clean();
+    // index of entries from Build() or a saved session, sorted here.
+    static void Load(std::vector<Entry>& entries);
+    static const std::vector<Entry>& GetEntries() { return kEntries; }
+    static uint32_t Size() { return kEntries.size(); }
+
+    // first class of the descriptor, 0x0 if not found.
+    static mirror::Class Find(const char* descriptor);
+    // classes of the same descriptor from different class loaders.
+    static void Find(const char* descriptor, std::function<bool (mirror::Class& clazz)> fn);
+    static void FindBySimpleName(const char* name, std::function<bool (mirror::Class& clazz)> fn);
+    static void FindByPackage(const char* package, std::function<bool (mirror::Class& clazz)> fn);
+    static void FindByPrefix(const char* prefix, std::function<bool (mirror::Class& clazz)> fn);
+    static void FindByRegex(const char* regex, std::function<bool (mirror::Class& clazz)> fn);
+    static void Foreach(std::function<bool (mirror::Class& clazz)> fn);
+private:
+    static bool Visit(uint32_t idx, std::function<bool (mirror::Class& clazz)>& fn);
+
+    static bool kReady;
+    // Prepare() ran, a failed build is not retried on every lookup.
+    static bool kAttempted;
+    static std::vector<Entry> kEntries;
+    static std::unordered_map<std::string, uint32_t> kDescriptors;
+    static std::unordered_multimap<std::string, uint32_t> kSimpleNames;
+};
+
+} // namespace art
+
+#endif // ANDROID_ART_RUNTIME_CLASS_INDEX_H_
@@ -0,0 +1,50 @@
+/*
+ * Copyright (C) 2024-present, Guanyou.Chen. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "runtime/class_layout.h"
+#include "runtime/art_field.h"
+
+namespace art {
+
+std::unordered_map<uint64_t, ClassLayout::Layout> ClassLayout::kLayouts;
+
+const ClassLayout::Layout& ClassLayout::Get(mirror::Class& klass) {
+    auto it = kLayouts.find(klass.Ptr());
+    if (it != kLayouts.end())
+        return it->second;
+
+    Layout layout;
+    auto callback = [&](ArtField& field) -> bool {
+        Android::BasicType type = Android::SignatureToBasicTypeAndSize(field.GetTypeDescriptor(), nullptr, "B");
+        layout.fields.push_back({field.Ptr(), field.offset(), type});
+        if (type == Android::basic_object)
+            layout.references.push_back(field.offset());
+        return false;
+    };
+
+    mirror::Class super = klass;
+    do {
+        uint32_t begin = layout.fields.size();
+        Android::ForeachInstanceField(super, callback);
+        layout.segments.push_back({super.Ptr(), begin, static_cast<uint32_t>(layout.fields.size())});
+        super = super.GetSuperClass();
+    } while (super.Ptr());
+
+    return kLayouts.emplace(klass.Ptr(), std::move(layout)).first->second;
+}
+
+} // namespace art
@@ -0,0 +1,79 @@
+/*
+ * Copyright (C) 2024-present, Guanyou.Chen. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef ANDROID_ART_RUNTIME_CLASS_LAYOUT_H_
+#define ANDROID_ART_RUNTIME_CLASS_LAYOUT_H_
+
+#include "android.h"
+#include "runtime/mirror/class.h"
+#include "runtime/mirror/object.h"
+#include <stdint.h>
+#include <unordered_map>
+#include <vector>
+
+namespace art {
+
+/*
+ * Compiled instance field layout of a class, covering the whole
+ * superclass chain. Field types are decoded from the dex signature
+ * once per class, object decoding is then a loop over a flat vector.
+ * Segments keep the per-class ranges in ForeachInstanceField order,
+ * most derived class first, as hprof and print need them.
+ */
+class ClassLayout {
+public:
+    struct Field {
+        // ArtField
+        uint64_t field;
+        uint32_t offset;
+        Android::BasicType type;
+    };
+
+    struct Segment {
+        uint64_t klass;
+        uint32_t begin;
+        uint32_t end;
+    };
+
+    struct Layout {
+        std::vector<Field> fields;
+        std::vector<Segment> segments;
+        std::vector<uint32_t> references;
+    };
+
+    static const Layout& Get(mirror::Class& klass);
+    static void Clean() { kLayouts.clear(); }
+
+    // visitor(offset, ref) returns true to stop.
+    template <typename Visitor>
+    static void VisitReferences(mirror::Object& object, mirror::Class& klass, Visitor&& visitor) {
+        VisitReferences(object, Get(klass).references, visitor);
+    }
+    template <typename Visitor>
+    static void VisitReferences(mirror::Object& object, const std::vector<uint32_t>& references, Visitor&& visitor) {
+        for (uint32_t offset : references) {
+            if (visitor(offset, object.value32Of(offset)))
+                break;
+        }
+    }
+private:
+    static std::unordered_map<uint64_t, Layout> kLayouts;
+};
+
+} // namespace art
+
+#endif // ANDROID_ART_RUNTIME_CLASS_LAYOUT_H_
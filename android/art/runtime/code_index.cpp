@@ -0,0 +1,223 @@
+/*
+ * Copyright (C) 2024-present, Guanyou.Chen. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "logger/log.h"
+#include "api/core.h"
+#include "common/elf.h"
+#include "common/exception.h"
+#include "common/link_map.h"
+#include "android.h"
+#include "runtime/code_index.h"
+#include "runtime/class_index.h"
+#include "runtime/class_linker.h"
+#include "runtime/runtime.h"
+#include "runtime/art_method.h"
+#include "runtime/oat_quick_method_header.h"
+#include "runtime/jit/jit.h"
+#include "runtime/jit/jit_code_cache.h"
+#include "runtime/entrypoints/runtime_asm_entrypoints.h"
+#include <algorithm>
+
+namespace art {
+
+bool CodeIndex::kReady = false;
+bool CodeIndex::kAttempted = false;
+std::vector<CodeIndex::Entry> CodeIndex::kEntries;
+
+static const char* kQuickStubs[] = {
+    "art_quick_generic_jni_trampoline",
+    "art_quick_resolution_trampoline",
+    "art_quick_to_interpreter_bridge",
+    "art_quick_imt_conflict_trampoline",
+    "art_quick_proxy_invoke_handler",
+    "art_invoke_obsolete_method_stub",
+    "art_quick_deoptimize",
+    "art_quick_invoke_stub",
+    "art_quick_invoke_static_stub",
+    "art_quick_osr_stub",
+    "art_jni_dlsym_lookup_stub",
+    "art_jni_dlsym_lookup_critical_stub",
+};
+
+void CodeIndex::Add(uint64_t code_start, uint64_t code_size, uint64_t method, int type, const char* name) {
+    if (!code_start || !code_size)
+        return;
+    kEntries.push_back({code_start, code_size, method, type, name});
+}
+
+void CodeIndex::Build() {
+    Clean();
+
+    BuildStubCode();
+    BuildJitCode();
+    BuildOatCode();
+
+    // stable, so entries of the same code keep the add order.
+    std::stable_sort(kEntries.begin(), kEntries.end(),
+            [](const Entry& a, const Entry& b) { return a.code_start < b.code_start; });
+    // identical code is deduplicated by dex2oat, the first method wins.
+    auto last = std::unique(kEntries.begin(), kEntries.end(),
+            [](const Entry& a, const Entry& b) { return a.code_start == b.code_start; });
+    kEntries.erase(last, kEntries.end());
+    kReady = true;
+    LOGD("CodeIndex build %ld code ranges.\n", kEntries.size());
+}
+
+void CodeIndex::Prepare() {
+    if (kReady || kAttempted)
+        return;
+
+    try {
+        Build();
+    } catch (InvalidAddressException& e) {
+        LOGW("CodeIndex build was interrupted!\n");
+        // drop the unsorted partial entries.
+        Clean();
+    }
+    kAttempted = true;
+}
+
+void CodeIndex::BuildStubCode() {
+    LinkMap* libart = CoreApi::FindLinkMap(Android::GetRealLibart().c_str());
+    if (libart) {
+        for (const auto& name : kQuickStubs) {
+            SymbolEntry symbol = libart->DlSymEntry(name);
+            if (!symbol.IsValid())
+                continue;
+            uint64_t start = libart->l_addr() + symbol.offset;
+            if (CoreApi::GetMachine() == EM_ARM)
+                start &= (CoreApi::GetPointMask() - 1);
+            Add(start, symbol.size, 0x0, TYPE_STUB, name);
+        }
+    }
+
+    if (Android::Sdk() >= Android::R) {
+        try {
+            OatQuickMethodHeader& nterp = OatQuickMethodHeader::GetNterpMethodHeader();
+            if (nterp.Ptr())
+                Add(nterp.GetCodeStart(), nterp.GetCodeSize(), 0x0, TYPE_NTERP, "nterp");
+        } catch (InvalidAddressException& e) {
+            LOGD("Skip nterp method header.\n");
+        }
+    }
+}
+
+void CodeIndex::BuildJitCode() {
+    Runtime& runtime = Runtime::Current();
+    if (!runtime.Ptr())
+        return;
+
+    try {
+        jit::Jit& jit = runtime.GetJit();
+        if (!jit.Ptr())
+            return;
+
+        jit::JitCodeCache& code_cache = jit.GetCodeCache();
+        for (const auto& entry : code_cache.GetCodeEntries()) {
+            int type = entry.type == jit::JitCodeCache::CODE_JNI_STUB ? TYPE_JNI_STUB : TYPE_JIT;
+            // unowned code still resolves as jit code.
+            Add(entry.code_start, entry.code_size, entry.method, type, entry.method ? nullptr : "<unknown>");
+        }
+    } catch (InvalidAddressException& e) {
+        LOGD("Skip jit code cache.\n");
+    }
+}
+
+void CodeIndex::BuildOatCode() {
+    Runtime& runtime = Runtime::Current();
+    if (!runtime.Ptr())
+        return;
+
+    ClassLinker& class_linker = runtime.GetClassLinker();
+    jit::Jit& jit = runtime.GetJit();
+    auto is_stub = [&](uint64_t entry_point) -> bool {
+        return class_linker.IsQuickGenericJniStub(entry_point)
+                || class_linker.IsQuickResolutionStub(entry_point)
+                || class_linker.IsQuickToInterpreterBridge(entry_point)
+                || entry_point == GetQuickProxyInvokeHandler()
+                || entry_point == GetInvokeObsoleteMethodStub()
+                || entry_point == GetExecuteNterpImplEntryPoint();
+    };
+
+    auto add_code = [&](uint64_t entry_point, ArtMethod& method) {
+        if (!entry_point || is_stub(entry_point))
+            return;
+        if (jit.Ptr() && jit.GetCodeCache().ContainsPc(entry_point))
+            return;
+        OatQuickMethodHeader method_header = OatQuickMethodHeader::FromEntryPoint(entry_point);
+        Add(method_header.GetCodeStart(), method_header.GetCodeSize(), method.Ptr(), TYPE_OAT, nullptr);
+    };
+
+    auto visit_method = [&](ArtMethod& method) -> bool {
+        if (method.IsRuntimeMethod() || method.IsAbstract())
+            return false;
+        try {
+            add_code(method.GetOatQuickCode(), method);
+        } catch (InvalidAddressException& e) {}
+        try {
+            add_code(method.GetEntryPointFromQuickCompiledCode(), method);
+        } catch (InvalidAddressException& e) {}
+        return false;
+    };
+
+    auto visit_class = [&](mirror::Class& clazz) -> bool {
+        try {
+            Android::ForeachArtMethods(clazz, visit_method);
+        } catch (InvalidAddressException& e) {
+            LOGD("Skip methods of class 0x%" PRIx64 ".\n", clazz.Ptr());
+        }
+        return false;
+    };
+    ClassIndex::Foreach(visit_class);
+}
+
+void CodeIndex::Clean() {
+    kReady = false;
+    kAttempted = false;
+    kEntries.clear();
+}
+
+const CodeIndex::Entry* CodeIndex::Lookup(uint64_t pc) {
+    Prepare();
+    if (CoreApi::GetMachine() == EM_ARM)
+        pc &= (CoreApi::GetPointMask() - 1);
+    return Find(kEntries, pc);
+}
+
+const CodeIndex::Entry* CodeIndex::Find(const std::vector<Entry>& entries, uint64_t pc) {
+    auto it = std::upper_bound(entries.begin(), entries.end(), pc,
+            [](uint64_t value, const Entry& entry) { return value < entry.code_start; });
+    if (it == entries.begin())
+        return nullptr;
+    --it;
+    if (pc < it->code_start + it->code_size)
+        return &(*it);
+    return nullptr;
+}
+
+const char* CodeIndex::TypeToString(int type) {
+    switch (type) {
+        case TYPE_OAT: return "OAT";
+        case TYPE_JIT: return "JIT";
+        case TYPE_JNI_STUB: return "JNI_STUB";
+        case TYPE_NTERP: return "NTERP";
+        case TYPE_STUB: return "STUB";
+    }
+    return "UNKNOWN";
+}
+
+} // namespace art
@@ -0,0 +1,80 @@
+/*
+ * Copyright (C) 2024-present, Guanyou.Chen. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef ANDROID_ART_RUNTIME_CODE_INDEX_H_
+#define ANDROID_ART_RUNTIME_CODE_INDEX_H_
+
+#include <stdint.h>
+#include <vector>
+
+namespace art {
+
+/*
+ * Code ranges of oat compiled methods, jit code cache, nterp and quick
+ * stubs merged in one array sorted by code start, built on first lookup.
+ *
+ * Consumers call Prepare() from their prepare(), the index is then built
+ * once in the parent and inherited by the forked command children.
+ *
+ *   const CodeIndex::Entry* entry = CodeIndex::Lookup(pc);
+ *   if (entry && entry->method) {
+ *       ArtMethod method = entry->method;
+ *       ...
+ *   }
+ */
+class CodeIndex {
+public:
+    static constexpr int TYPE_OAT = 0;
+    static constexpr int TYPE_JIT = 1;
+    static constexpr int TYPE_JNI_STUB = 2;
+    static constexpr int TYPE_NTERP = 3;
+    static constexpr int TYPE_STUB = 4;
+
+    struct Entry {
+        uint64_t code_start;
+        uint64_t code_size;
+        // ArtMethod, 0x0 for nterp, quick stubs and unowned jit code
+        uint64_t method;
+        int type;
+        // set whenever method is 0x0, symbol of quick stubs
+        const char* name;
+    };
+
+    static bool IsReady() { return kReady; }
+    static void Build();
+    static void Prepare();
+    static void Clean();
+    static uint32_t Size() { return kEntries.size(); }
+    static const Entry* Lookup(uint64_t pc);
+    // entry of sorted entries whose [code_start, code_start + code_size) holds pc.
+    static const Entry* Find(const std::vector<Entry>& entries, uint64_t pc);
+    static const char* TypeToString(int type);
+private:
+    static void Add(uint64_t code_start, uint64_t code_size, uint64_t method, int type, const char* name);
+    static void BuildOatCode();
+    static void BuildJitCode();
+    static void BuildStubCode();
+
+    static bool kReady;
+    // Prepare() ran, a failed build is not retried on every lookup.
+    static bool kAttempted;
+    static std::vector<Entry> kEntries;
+};
+
+} // namespace art
+
+#endif // ANDROID_ART_RUNTIME_CODE_INDEX_H_
@@ -0,0 +1,99 @@
+/*
+ * Copyright (C) 2024-present, Guanyou.Chen. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "logger/log.h"
+#include "android.h"
+#include "runtime/dex_pc_index.h"
+#include "runtime/class_index.h"
+#include "common/exception.h"
+#include <algorithm>
+
+namespace art {
+
+bool DexPcIndex::kReady = false;
+bool DexPcIndex::kAttempted = false;
+std::vector<DexPcIndex::Entry> DexPcIndex::kEntries;
+
+void DexPcIndex::Build() {
+    Clean();
+
+    auto visit_method = [&](ArtMethod& method) -> bool {
+        try {
+            dex::CodeItem item = method.GetCodeItem();
+            if (item.Ptr()) {
+                uint64_t begin = item.Ptr() + item.code_offset_;
+                uint64_t end = begin + (item.insns_count_ << 1);
+                if (end > begin)
+                    kEntries.push_back({begin, end, method.Ptr()});
+            }
+        } catch (InvalidAddressException& e) {}
+        return false;
+    };
+
+    auto visit_class = [&](mirror::Class& clazz) -> bool {
+        try {
+            Android::ForeachArtMethods(clazz, visit_method);
+        } catch (InvalidAddressException& e) {
+            LOGD("Skip methods of class 0x%" PRIx64 ".\n", clazz.Ptr());
+        }
+        return false;
+    };
+    ClassIndex::Foreach(visit_class);
+
+    std::sort(kEntries.begin(), kEntries.end(),
+            [](const Entry& a, const Entry& b) { return a.begin < b.begin; });
+    // copied methods share the code item of their origin, keep one.
+    auto last = std::unique(kEntries.begin(), kEntries.end(),
+            [](const Entry& a, const Entry& b) { return a.begin == b.begin; });
+    kEntries.erase(last, kEntries.end());
+    kReady = true;
+    LOGD("DexPcIndex build %ld code items.\n", kEntries.size());
+}
+
+void DexPcIndex::Prepare() {
+    if (kReady || kAttempted)
+        return;
+
+    try {
+        Build();
+    } catch (InvalidAddressException& e) {
+        LOGW("DexPcIndex build was interrupted!\n");
+        // drop the unsorted partial entries.
+        Clean();
+    }
+    kAttempted = true;
+}
+
+void DexPcIndex::Clean() {
+    kReady = false;
+    kAttempted = false;
+    kEntries.clear();
+}
+
+ArtMethod DexPcIndex::Lookup(uint64_t dex_pc) {
+    Prepare();
+    auto it = std::upper_bound(kEntries.begin(), kEntries.end(), dex_pc,
+            [](uint64_t value, const Entry& entry) { return value < entry.begin; });
+    if (it == kEntries.begin())
+        return 0x0;
+    --it;
+    if (dex_pc < it->end)
+        return it->method;
+    return 0x0;
+}
+
+} // namespace art
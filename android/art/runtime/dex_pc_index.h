@@ -0,0 +1,60 @@
+/*
+ * Copyright (C) 2024-present, Guanyou.Chen. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef ANDROID_ART_RUNTIME_DEX_PC_INDEX_H_
+#define ANDROID_ART_RUNTIME_DEX_PC_INDEX_H_
+
+#include "runtime/art_method.h"
+#include <stdint.h>
+#include <vector>
+
+namespace art {
+
+/*
+ * Dex instruction ranges of all methods of loaded classes, sorted by
+ * start, built on first lookup.
+ *
+ * Consumers call Prepare() from their prepare(), the index is then built
+ * once in the parent and inherited by the forked command children.
+ *
+ *   ArtMethod method = DexPcIndex::Lookup(dex_pc);
+ */
+class DexPcIndex {
+public:
+    struct Entry {
+        uint64_t begin;
+        uint64_t end;
+        uint64_t method;
+    };
+
+    static bool IsReady() { return kReady; }
+    static void Build();
+    static void Prepare();
+    static void Clean();
+    static uint32_t Size() { return kEntries.size(); }
+    // method whose code item contains dex_pc, 0x0 if not found.
+    static ArtMethod Lookup(uint64_t dex_pc);
+private:
+    static bool kReady;
+    // Prepare() ran, a failed build is not retried on every lookup.
+    static bool kAttempted;
+    static std::vector<Entry> kEntries;
+};
+
+} // namespace art
+
+#endif // ANDROID_ART_RUNTIME_DEX_PC_INDEX_H_
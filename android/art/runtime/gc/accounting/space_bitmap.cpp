@@ -66,102 +66,27 @@ void ContinuousSpaceBitmap::Init29() {
     }
 }
 
-void ContinuousSpaceBitmap::VisitMarkedRange(uint64_t visit_begin, uint64_t visit_end,
-                                             std::function<bool (mirror::Object& object)> visitor, bool check) {
+void ContinuousSpaceBitmap::VisitMarkedAddress(uint64_t visit_begin, uint64_t visit_end,
+                                               std::function<void (uint64_t addr)> fn) {
+    if (visit_begin >= visit_end)
+        return;
+
     api::MemoryRef bitmap_begin_ref(bitmap_begin());
-    api::MemoryRef heap_begin_ref(heap_begin());
-    heap_begin_ref.Prepare(false);
+    uint64_t heap_begin_ = heap_begin();
     int point_bit = CoreApi::GetPointSize();
 
-    uint64_t offset_start = visit_begin - heap_begin_ref.Ptr();
-    uint64_t offset_end = visit_end - heap_begin_ref.Ptr();
-
-    uint64_t index_start = OffsetToIndex(offset_start, point_bit);
-    uint64_t index_end = OffsetToIndex(offset_end, point_bit);
-
-    uint64_t bit_start = (offset_start / kObjectAlignment) % (kBitsPerByte * point_bit);
-    uint64_t bit_end = (offset_end / kObjectAlignment) % (kBitsPerByte * point_bit);
-
-    // Index(begin)  ...    Index(end)
-    // [xxxxx???][........][????yyyy]
-    //      ^                   ^
-    //      |                   #---- Bit of visit_end
-    //      #---- Bit of visit_begin
-    //
-
-    // Left edge.
-    uint64_t left_edge = bitmap_begin_ref.valueOf((index_start * point_bit));
-    // Mark of lower bits that are not in range.
-    left_edge &= ~((static_cast<uint64_t>(1) << bit_start) - 1);
-
-    // Right edge. Either unique, or left_edge.
-    uint64_t right_edge;
-
-    if (index_start < index_end) {
-        // Left edge != right edge.
-
-        // Traverse left edge.
-        if (left_edge != 0) {
-            uint64_t ptr_base = IndexToOffset(index_start, point_bit) + heap_begin_ref.Ptr();
-            do {
-                uint64_t shift = __builtin_ctzll(left_edge);
-                mirror::Object obj(ptr_base + shift * kObjectAlignment, heap_begin_ref);
-                if (obj.IsNonLargeValid()) {
-                    visitor(obj);
-                } else if (check) {
-                    LOGE("0x%" PRIx64 " is bad object on [0x%" PRIx64 ", 0x%" PRIx64 ").\n", obj.Ptr(), visit_begin, visit_end);
-                }
-                left_edge ^= ((static_cast<uint64_t>(1)) << shift);
-            } while (left_edge != 0);
+    uint64_t index_start = OffsetToIndex(visit_begin - heap_begin_, point_bit);
+    uint64_t index_end = OffsetToIndex(visit_end - 1 - heap_begin_, point_bit);
+    for (uint64_t i = index_start; i <= index_end; ++i) {
+        uint64_t w = bitmap_begin_ref.valueOf((i * point_bit));
+        uint64_t ptr_base = IndexToOffset(i, point_bit) + heap_begin_;
+        while (w != 0) {
+            uint64_t shift = __builtin_ctzll(w);
+            uint64_t addr = ptr_base + shift * kObjectAlignment;
+            if (addr >= visit_begin && addr < visit_end)
+                fn(addr);
+            w ^= (static_cast<uint64_t>(1)) << shift;
         }
-
-        // Traverse the middle, full part.
-        for (uint64_t i = index_start + 1; i < index_end; ++i) {
-            uint64_t w = bitmap_begin_ref.valueOf((i * point_bit));
-            if (w != 0) {
-                uint64_t ptr_base = IndexToOffset(i, point_bit) + heap_begin_ref.Ptr();
-                // Iterate on the bits set in word `w`, from the least to the most significant bit.
-                do {
-                    uint64_t shift = __builtin_ctzll(w);
-                    mirror::Object obj(ptr_base + shift * kObjectAlignment, heap_begin_ref);
-                    if (obj.IsNonLargeValid()) {
-                        visitor(obj);
-                    } else if (check) {
-                        LOGE("0x%" PRIx64 " is bad object on [0x%" PRIx64 ", 0x%" PRIx64 ").\n", obj.Ptr(), visit_begin, visit_end);
-                    }
-                    w ^= (static_cast<uint64_t>(1)) << shift;
-                } while (w != 0);
-            }
-        }
-
-        // Right edge is unique.
-        // But maybe we don't have anything to do: visit_end starts in a new word...
-        if (bit_end == 0) {
-            // Do not read memory, as it could be after the end of the bitmap.
-            right_edge = 0;
-        } else {
-            right_edge = bitmap_begin_ref.valueOf((index_end * point_bit));
-        }
-    } else {
-        // Right edge = left edge.
-        right_edge = left_edge;
-    }
-
-    // Right edge handling.
-    right_edge &= ((static_cast<uint64_t>(1) << bit_end) - 1);
-    if (right_edge != 0) {
-        uint64_t ptr_base = IndexToOffset(index_end, point_bit) + heap_begin_ref.Ptr();
-        // Iterate on the bits set in word `right_edge`, from the least to the most significant bit.
-        do {
-            uint64_t shift = __builtin_ctzll(right_edge);
-            mirror::Object obj(ptr_base + shift * kObjectAlignment, heap_begin_ref);
-            if (obj.IsNonLargeValid()) {
-                visitor(obj);
-            } else if (check) {
-                LOGE("0x%" PRIx64 " is bad object on [0x%" PRIx64 ", 0x%" PRIx64 ").\n", obj.Ptr(), visit_begin, visit_end);
-            }
-            right_edge ^= (static_cast<uint64_t>(1)) << shift;
-        } while (right_edge != 0);
     }
 }
 
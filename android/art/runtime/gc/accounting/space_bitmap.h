@@ -17,8 +17,12 @@
 #ifndef ANDROID_ART_RUNTIME_GC_ACCOUNTING_SPACE_BITMAP_H_
 #define ANDROID_ART_RUNTIME_GC_ACCOUNTING_SPACE_BITMAP_H_
 
+#include "logger/log.h"
+#include "api/core.h"
 #include "api/memory_ref.h"
 #include "runtime/mirror/object.h"
+#include "runtime/gc/walk_sampler.h"
+#include "runtime/runtime_globals.h"
 #include <functional>
 
 struct ContinuousSpaceBitmap_OffsetTable {
@@ -49,11 +53,127 @@ public:
     inline uint64_t bitmap_size() { return VALUEOF(ContinuousSpaceBitmap, bitmap_size_); }
     inline uint64_t heap_begin() { return VALUEOF(ContinuousSpaceBitmap, heap_begin_); }
 
-    void VisitMarkedRange(uint64_t visit_begin, uint64_t visit_end, std::function<bool (mirror::Object& object)> fn, bool check);
+    // header only, visitor is inlined into the bit scan.
+    template <typename Visitor>
+    void VisitMarkedRange(uint64_t visit_begin, uint64_t visit_end, Visitor&& visitor, bool check);
+    // visit every marked address in range, without object validation.
+    void VisitMarkedAddress(uint64_t visit_begin, uint64_t visit_end, std::function<void (uint64_t addr)> fn);
     uint64_t OffsetToIndex(uint64_t offset, int point_bit);
     uint64_t IndexToOffset(uint64_t index, int point_bit);
 };
 
+template <typename Visitor>
+inline void ContinuousSpaceBitmap::VisitMarkedRange(uint64_t visit_begin, uint64_t visit_end,
+                                                    Visitor&& visitor, bool check) {
+    api::MemoryRef bitmap_begin_ref(bitmap_begin());
+    api::MemoryRef heap_begin_ref(heap_begin());
+    heap_begin_ref.Prepare(false);
+    int point_bit = CoreApi::GetPointSize();
+
+    uint64_t offset_start = visit_begin - heap_begin_ref.Ptr();
+    uint64_t offset_end = visit_end - heap_begin_ref.Ptr();
+
+    uint64_t index_start = OffsetToIndex(offset_start, point_bit);
+    uint64_t index_end = OffsetToIndex(offset_end, point_bit);
+
+    uint64_t bit_start = (offset_start / kObjectAlignment) % (kBitsPerByte * point_bit);
+    uint64_t bit_end = (offset_end / kObjectAlignment) % (kBitsPerByte * point_bit);
+
+    // a sampled walk only advises the edges, the picked words fault in on read.
+    bool sampled = WalkSampler::IsEnabled();
+    CoreApi::PrefetchScope prefetch(bitmap_begin_ref.Ptr() + index_start * point_bit,
+                                    (sampled ? 1 : index_end - index_start + 1) * point_bit);
+    CoreApi::PrefetchScope prefetch_end(bitmap_begin_ref.Ptr() + index_end * point_bit,
+                                        sampled ? point_bit : 0);
+
+    // Index(begin)  ...    Index(end)
+    // [xxxxx???][........][????yyyy]
+    //      ^                   ^
+    //      |                   #---- Bit of visit_end
+    //      #---- Bit of visit_begin
+    //
+
+    // Left edge.
+    uint64_t left_edge = bitmap_begin_ref.valueOf((index_start * point_bit));
+    // Mark of lower bits that are not in range.
+    left_edge &= ~((static_cast<uint64_t>(1) << bit_start) - 1);
+
+    // Right edge. Either unique, or left_edge.
+    uint64_t right_edge;
+
+    if (index_start < index_end) {
+        // Left edge != right edge.
+
+        // Traverse left edge.
+        if (left_edge != 0) {
+            uint64_t ptr_base = IndexToOffset(index_start, point_bit) + heap_begin_ref.Ptr();
+            do {
+                uint64_t shift = __builtin_ctzll(left_edge);
+                mirror::Object obj(ptr_base + shift * kObjectAlignment, heap_begin_ref);
+                if (obj.IsNonLargeValid()) {
+                    visitor(obj);
+                } else if (check) {
+                    LOGE("0x%" PRIx64 " is bad object on [0x%" PRIx64 ", 0x%" PRIx64 ").\n", obj.Ptr(), visit_begin, visit_end);
+                }
+                left_edge ^= ((static_cast<uint64_t>(1)) << shift);
+            } while (left_edge != 0);
+        }
+
+        // Traverse the middle, full part.
+        for (uint64_t i = index_start + 1; i < index_end; ++i) {
+            uint64_t unit = bitmap_begin_ref.Ptr() + i * point_bit;
+            // pick before the read, an unpicked word is never paged in.
+            if (!WalkSampler::Pick(unit))
+                continue;
+            WalkSampler::Scope scope(unit);
+            uint64_t w = bitmap_begin_ref.valueOf((i * point_bit));
+            if (w != 0) {
+                uint64_t ptr_base = IndexToOffset(i, point_bit) + heap_begin_ref.Ptr();
+                // Iterate on the bits set in word `w`, from the least to the most significant bit.
+                do {
+                    uint64_t shift = __builtin_ctzll(w);
+                    mirror::Object obj(ptr_base + shift * kObjectAlignment, heap_begin_ref);
+                    if (obj.IsNonLargeValid()) {
+                        visitor(obj);
+                    } else if (check) {
+                        LOGE("0x%" PRIx64 " is bad object on [0x%" PRIx64 ", 0x%" PRIx64 ").\n", obj.Ptr(), visit_begin, visit_end);
+                    }
+                    w ^= (static_cast<uint64_t>(1)) << shift;
+                } while (w != 0);
+            }
+        }
+
+        // Right edge is unique.
+        // But maybe we don't have anything to do: visit_end starts in a new word...
+        if (bit_end == 0) {
+            // Do not read memory, as it could be after the end of the bitmap.
+            right_edge = 0;
+        } else {
+            right_edge = bitmap_begin_ref.valueOf((index_end * point_bit));
+        }
+    } else {
+        // Right edge = left edge.
+        right_edge = left_edge;
+    }
+
+    // Right edge handling.
+    right_edge &= ((static_cast<uint64_t>(1) << bit_end) - 1);
+    if (right_edge != 0) {
+        uint64_t ptr_base = IndexToOffset(index_end, point_bit) + heap_begin_ref.Ptr();
+        // Iterate on the bits set in word `right_edge`, from the least to the most significant bit.
+        do {
+            uint64_t shift = __builtin_ctzll(right_edge);
+            mirror::Object obj(ptr_base + shift * kObjectAlignment, heap_begin_ref);
+            if (obj.IsNonLargeValid()) {
+                visitor(obj);
+            } else if (check) {
+                LOGE("0x%" PRIx64 " is bad object on [0x%" PRIx64 ", 0x%" PRIx64 ").\n", obj.Ptr(), visit_begin, visit_end);
+            }
+            right_edge ^= (static_cast<uint64_t>(1)) << shift;
+        } while (right_edge != 0);
+    }
+}
+
 } // namespace space
 } // namespace gc
 } // namespace art
@@ -125,6 +125,20 @@ cxx::vector& Heap::GetDiscontinuousSpacesCache() {
     return discontinuous_spaces_cache;
 }
 
+void Heap::SetContinuousSpacesCache(uint64_t addr) {
+    continuous_spaces_cache = addr;
+    continuous_spaces_cache.copyRef(this);
+    continuous_spaces_cache.SetEntrySize(CoreApi::GetPointSize());
+    continuous_spaces_second_cache.clear();
+}
+
+void Heap::SetDiscontinuousSpacesCache(uint64_t addr) {
+    discontinuous_spaces_cache = addr;
+    discontinuous_spaces_cache.copyRef(this);
+    discontinuous_spaces_cache.SetEntrySize(CoreApi::GetPointSize());
+    discontinuous_spaces_second_cache.clear();
+}
+
 std::vector<std::unique_ptr<space::ContinuousSpace>>& Heap::GetContinuousSpaces() {
     if (!continuous_spaces_second_cache.size()) {
         for (const auto& value : GetContinuousSpacesCache()) {
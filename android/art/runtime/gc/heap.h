@@ -58,6 +58,8 @@ public:
 
     cxx::vector& GetContinuousSpacesCache();
     cxx::vector& GetDiscontinuousSpacesCache();
+    void SetContinuousSpacesCache(uint64_t addr);
+    void SetDiscontinuousSpacesCache(uint64_t addr);
     std::vector<std::unique_ptr<space::ContinuousSpace>>& GetContinuousSpaces();
     std::vector<std::unique_ptr<space::DiscontinuousSpace>>& GetDiscontinuousSpaces();
     void CleanCache() {
@@ -106,6 +106,7 @@ void BumpPointerSpace::SlowWalk(std::function<bool (mirror::Object& object)> vis
 
     mirror::Object object_cache = pos;
     object_cache.Prepare(false);
+    CoreApi::PrefetchScope prefetch(Begin(), end - Begin());
 
     // slow walk
     while (pos < end) {
@@ -132,6 +133,7 @@ void BumpPointerSpace::Walk(std::function<bool (mirror::Object& object)> visitor
 
     mirror::Object object_cache = pos;
     object_cache.Prepare(false);
+    CoreApi::PrefetchScope prefetch(Begin(), end - Begin());
 
     uint64_t main_block_size_tmp = main_block_size();
     std::deque<uint64_t>& block_sizes_ = GetBlockSizes();
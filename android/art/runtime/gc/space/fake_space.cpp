@@ -49,6 +49,7 @@ void FakeSpace::Walk(std::function<bool (mirror::Object& object)> visitor) {
     uint64_t top = End();
     mirror::Object object_cache = pos;
     object_cache.Prepare(false);
+    CoreApi::PrefetchScope prefetch(Begin(), top - Begin());
 
     while (pos < top) {
         mirror::Object object(pos, object_cache);
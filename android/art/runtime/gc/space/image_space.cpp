@@ -15,6 +15,7 @@
  */
 
 #include "logger/log.h"
+#include "api/core.h"
 #include "runtime/gc/space/image_space.h"
 #include "runtime/runtime_globals.h"
 #include "runtime/image.h"
@@ -31,21 +32,7 @@ void ImageSpace::Init() {
 }
 
 void ImageSpace::Walk(std::function<bool (mirror::Object& object)> visitor, bool check) {
-    uint64_t pos = Begin() + SIZEOF(ImageHeader);
-    uint64_t top = End();
-    mirror::Object object_cache = pos;
-    object_cache.Prepare(false);
-
-    while (pos < top) {
-        mirror::Object object(pos, object_cache);
-        if (object.IsNonLargeValid()) {
-            visitor(object);
-            pos = GetNextObject(object);
-        } else {
-            pos = object.NextValidOffset(top);
-            if (check && pos < top) LOGE("Region:[0x%" PRIx64 ", 0x%" PRIx64 ") %s has bad object!!\n", object.Ptr(), pos, GetName());
-        }
-    }
+    WalkInternal(visitor, check);
 }
 
 } // namespace space
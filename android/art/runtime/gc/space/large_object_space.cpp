@@ -492,6 +492,7 @@ void FreeListSpace::Walk(std::function<bool (mirror::Object& object)> visitor, b
 
     AllocationInfo cur_info = GetAlloctionInfoCache();
     AllocationInfo end_info = GetAllocationInfoForAddress(free_end_start);
+    CoreApi::PrefetchScope prefetch(begin(), free_end_start - begin());
 
     while (cur_info.Ptr() < end_info.Ptr()) {
         if (!cur_info.IsFree()) {
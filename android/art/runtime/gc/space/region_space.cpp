@@ -19,6 +19,7 @@
 #include "android.h"
 #include "common/exception.h"
 #include "runtime/gc/space/region_space.h"
+#include "runtime/gc/walk_sampler.h"
 #include "runtime/mirror/class.h"
 #include "runtime/mirror/object.h"
 #include "runtime/runtime_globals.h"
@@ -211,62 +212,6 @@ void RegionSpace::Walk(std::function<bool (mirror::Object& object)> fn, bool che
     WalkInternal(fn, false, check);
 }
 
-void RegionSpace::WalkInternal(std::function<bool (mirror::Object& object)> visitor, bool only, bool check) {
-    Region regions_(regions(), this);
-    uint64_t num_regions_ = num_regions();
-    for (int i = 0; i < num_regions_; ++i) {
-        Region r(regions_.Ptr() + i * SIZEOF(Region), regions_);
-        uint64_t pos = r.Begin();
-        uint64_t top = r.Top();
-
-        if (r.IsFree() || (only && r.IsInToSpace()))
-            continue;
-
-        if (r.IsLarge()) {
-            mirror::Object object = r.Begin();
-            if (object.GetClass().Ptr() != 0x0) {
-                visitor(object);
-            }
-        } else if (r.IsLargeTail()) {
-            // Do nothing.
-        } else {
-            try {
-                WalkNonLargeRegion(visitor, r, check);
-            } catch (InvalidAddressException& e) {
-                LOGW("[0x%" PRIx64 "] Region:[0x%" PRIx64 ", 0x%" PRIx64 ") walkspace exception!\n", r.Ptr(), pos, top);
-            }
-        }
-    }
-}
-
-void RegionSpace::WalkNonLargeRegion(std::function<bool (mirror::Object& object)> visitor, RegionSpace::Region& region, bool check) {
-    uint64_t pos = region.Begin();
-    uint64_t begin = pos;
-    uint64_t top = region.Top();
-    mirror::Object object_cache = pos;
-    object_cache.Prepare(false);
-    uint64_t bit_mask = CoreApi::GetPointMask();
-
-    const bool need_bitmap =
-        region.LiveBytes() != (static_cast<uint64_t>(-1) & bit_mask) &&
-        region.LiveBytes() != static_cast<uint64_t>(top - pos);
-
-    if (need_bitmap) {
-        GetLiveBitmap().VisitMarkedRange(pos, top, visitor, check);
-    } else {
-        while (pos < top) {
-            mirror::Object object(pos, object_cache);
-            if (object.IsNonLargeValid()) {
-                visitor(object);
-                pos = GetNextObject(object);
-            } else {
-                pos = object.NextValidOffset(top);
-                if (check && pos < top) LOGE("Region:[0x%" PRIx64 ", 0x%" PRIx64 ") %s has bad object!!\n", object.Ptr(), pos, GetName());
-            }
-        }
-    }
-}
-
 accounting::ContinuousSpaceBitmap& RegionSpace::GetLiveBitmap() {
     if (!mark_bitmap_cache.Ptr()) {
         if (Android::Sdk() > Android::Q) {
@@ -17,9 +17,14 @@
 #ifndef ANDROID_ART_RUNTIME_GC_SPACE_REGION_SPACE_H_
 #define ANDROID_ART_RUNTIME_GC_SPACE_REGION_SPACE_H_
 
+#include "logger/log.h"
+#include "api/core.h"
+#include "common/exception.h"
 #include "runtime/gc/space/space.h"
 #include "runtime/mirror/object.h"
+#include "runtime/mirror/class.h"
 #include "runtime/gc/accounting/space_bitmap.h"
+#include "runtime/gc/walk_sampler.h"
 #include <functional>
 
 struct RegionSpace_OffsetTable {
@@ -84,7 +89,8 @@ public:
     bool IsRosAllocSpace() { return false; }
     bool IsDlMallocSpace() { return false; }
     void Walk(std::function<bool (mirror::Object& object)> fn, bool check);
-    void WalkInternal(std::function<bool (mirror::Object& object)> fn, bool only, bool check);
+    template <typename Visitor>
+    void WalkInternal(Visitor&& visitor, bool only, bool check);
 
     enum class RegionType : uint8_t {
         kRegionTypeAll,              // All types.
@@ -114,6 +120,7 @@ public:
         inline uint64_t live_bytes() { return VALUEOF(Region, live_bytes_); }
         inline uint64_t begin() { return VALUEOF(Region, begin_); }
         inline uint64_t top() { return VALUEOF(Region, top_); }
+        inline uint64_t end() { return VALUEOF(Region, end_); }
         inline uint64_t objects_allocated() { return VALUEOF(Region, objects_allocated_); }
         inline uint8_t state() { return *reinterpret_cast<uint8_t*>(Real() + OFFSET(Region, state_)); }
         inline uint8_t type() { return *reinterpret_cast<uint8_t*>(Real() + OFFSET(Region, type_)); }
@@ -124,11 +131,13 @@ public:
         inline bool IsLargeTail() { return state() == static_cast<uint8_t>(RegionState::kRegionStateLargeTail); }
         inline uint64_t Begin() { return begin(); }
         inline uint64_t Top() { return top(); }
+        inline uint64_t End() { return end(); }
         inline uint64_t LiveBytes() { return live_bytes(); }
         inline uint64_t ObjectsAllocated() { return objects_allocated(); }
     };
 
-    void WalkNonLargeRegion(std::function<bool (mirror::Object& object)> fn, RegionSpace::Region& region, bool check);
+    template <typename Visitor>
+    void WalkNonLargeRegion(Visitor&& visitor, RegionSpace::Region& region, bool check);
     accounting::ContinuousSpaceBitmap& GetLiveBitmap();
 
 private:
@@ -136,6 +145,67 @@ private:
     accounting::ContinuousSpaceBitmap mark_bitmap_cache = 0x0;
 };
 
+template <typename Visitor>
+inline void RegionSpace::WalkInternal(Visitor&& visitor, bool only, bool check) {
+    Region regions_(regions(), this);
+    uint64_t num_regions_ = num_regions();
+    for (int i = 0; i < num_regions_; ++i) {
+        Region r(regions_.Ptr() + i * SIZEOF(Region), regions_);
+        uint64_t pos = r.Begin();
+        uint64_t top = r.Top();
+
+        if (r.IsFree() || (only && r.IsInToSpace()) || r.IsLargeTail())
+            continue;
+
+        if (!WalkSampler::Pick(r.Ptr()))
+            continue;
+
+        WalkSampler::Scope scope(r.Ptr());
+        // only the picked region, a sampled walk must not page in the whole space.
+        CoreApi::PrefetchScope prefetch(pos, top - pos);
+        if (r.IsLarge()) {
+            mirror::Object object = r.Begin();
+            if (object.GetClass().Ptr() != 0x0) {
+                visitor(object);
+            }
+        } else {
+            try {
+                WalkNonLargeRegion(visitor, r, check);
+            } catch (InvalidAddressException& e) {
+                LOGW("[0x%" PRIx64 "] Region:[0x%" PRIx64 ", 0x%" PRIx64 ") walkspace exception!\n", r.Ptr(), pos, top);
+            }
+        }
+    }
+}
+
+template <typename Visitor>
+inline void RegionSpace::WalkNonLargeRegion(Visitor&& visitor, RegionSpace::Region& region, bool check) {
+    uint64_t pos = region.Begin();
+    uint64_t top = region.Top();
+    mirror::Object object_cache = pos;
+    object_cache.Prepare(false);
+    uint64_t bit_mask = CoreApi::GetPointMask();
+
+    const bool need_bitmap =
+        region.LiveBytes() != (static_cast<uint64_t>(-1) & bit_mask) &&
+        region.LiveBytes() != static_cast<uint64_t>(top - pos);
+
+    if (need_bitmap) {
+        GetLiveBitmap().VisitMarkedRange(pos, top, visitor, check);
+    } else {
+        while (pos < top) {
+            mirror::Object object(pos, object_cache);
+            if (object.IsNonLargeValid()) {
+                visitor(object);
+                pos = GetNextObject(object);
+            } else {
+                pos = object.NextValidOffset(top);
+                if (check && pos < top) LOGE("Region:[0x%" PRIx64 ", 0x%" PRIx64 ") %s has bad object!!\n", object.Ptr(), pos, GetName());
+            }
+        }
+    }
+}
+
 } // namespace space
 } // namespace gc
 } // namespace art
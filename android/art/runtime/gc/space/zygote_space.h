@@ -17,6 +17,7 @@
 #ifndef ANDROID_ART_RUNTIME_GC_SPACE_ZYGOTE_SPACE_H_
 #define ANDROID_ART_RUNTIME_GC_SPACE_ZYGOTE_SPACE_H_
 
+#include "api/core.h"
 #include "runtime/gc/space/space.h"
 #include <functional>
 
@@ -47,8 +48,30 @@ public:
     bool IsRosAllocSpace() { return false; }
     bool IsDlMallocSpace() { return false; }
     void Walk(std::function<bool (mirror::Object& object)> fn, bool check);
+    template <typename Visitor>
+    void WalkInternal(Visitor&& visitor, bool check);
 };
 
+template <typename Visitor>
+inline void ZygoteSpace::WalkInternal(Visitor&& visitor, bool check) {
+    uint64_t pos = Begin();
+    uint64_t top = End();
+    mirror::Object object_cache = pos;
+    object_cache.Prepare(false);
+    CoreApi::PrefetchScope prefetch(Begin(), top - Begin());
+
+    while (pos < top) {
+        mirror::Object object(pos, object_cache);
+        if (object.IsNonLargeValid()) {
+            visitor(object);
+            pos = GetNextObject(object);
+        } else {
+            pos = object.NextValidOffset(top);
+            if (check && pos < top) LOGE("Region:[0x%" PRIx64 ", 0x%" PRIx64 ") %s has bad object!!\n", object.Ptr(), pos, GetName());
+        }
+    }
+}
+
 } // namespace space
 } // namespace gc
 } // namespace art
@@ -0,0 +1,413 @@
+/*
+ * Copyright (C) 2024-present, Guanyou.Chen. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "logger/log.h"
+#include "api/core.h"
+#include "android.h"
+#include "common/bit.h"
+#include "common/exception.h"
+#include "runtime/gc/verification.h"
+#include "runtime/runtime.h"
+#include "runtime/gc/heap.h"
+#include "runtime/gc/space/space.h"
+#include "runtime/gc/space/region_space.h"
+#include "runtime/gc/space/large_object_space.h"
+#include "runtime/mirror/class.h"
+#include "runtime/mirror/array.h"
+#include "runtime/runtime_globals.h"
+#include "runtime/image.h"
+#include "runtime/class_layout.h"
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+namespace art {
+namespace gc {
+
+/*
+ * Merges adjacent bad objects of a unit into one range, and fills
+ * the nearest valid object after a range once the walk reaches it.
+ */
+class CorruptionTracker {
+public:
+    CorruptionTracker(Verification::Unit& u) : unit(u), pending(u.corruptions.size()) {}
+
+    void Valid(uint64_t addr) {
+        for (; pending < unit.corruptions.size(); ++pending)
+            unit.corruptions[pending].next = addr;
+        prev = addr;
+    }
+
+    void Corrupt(uint64_t begin, uint64_t end, int reason, uint64_t detail) {
+        if (pending < unit.corruptions.size()) {
+            Verification::Corruption& last = unit.corruptions.back();
+            if (last.end == begin) {
+                last.end = end;
+                last.reason |= reason;
+                return;
+            }
+        }
+        unit.corruptions.push_back({begin, end, reason, detail, prev, 0x0});
+    }
+private:
+    Verification::Unit& unit;
+    uint64_t pending;
+    uint64_t prev = 0x0;
+};
+
+void Verification::CollectUnits() {
+    art::Runtime& runtime = art::Runtime::Current();
+    art::gc::Heap& heap = runtime.GetHeap();
+    uint64_t bit_mask = CoreApi::GetPointMask();
+
+    for (const auto& space : heap.GetContinuousSpaces()) {
+        space::ContinuousSpace* sp = space.get();
+        if (!sp->IsVaildSpace())
+            continue;
+        ranges.push_back(std::pair<uint64_t, uint64_t>(sp->Begin(), sp->End()));
+
+        Unit unit = {UNIT_SPACE, 0x0, sp->Begin(), sp->End(), 0, sp->GetName(), sp, 0, 0, {}};
+        if (sp->IsImageSpace()) {
+            if (!(flag & Android::EACH_IMAGE_OBJECTS)) continue;
+            unit.mode = UNIT_LINEAR;
+            unit.begin += SIZEOF(ImageHeader);
+        } else if (sp->IsZygoteSpace()) {
+            if (!(flag & Android::EACH_ZYGOTE_OBJECTS)) continue;
+            unit.mode = UNIT_LINEAR;
+        } else if (sp->IsFakeSpace()) {
+            if (!(flag & Android::EACH_FAKE_OBJECTS)) continue;
+        } else if (sp->IsRegionSpace()) {
+            if (!(flag & Android::EACH_APP_OBJECTS)) continue;
+            space::RegionSpace* region_space = static_cast<space::RegionSpace*>(sp);
+            // warm up the quick cache before it is shared by workers
+            region_space->GetLiveBitmap();
+
+            space::RegionSpace::Region regions(region_space->regions(), region_space);
+            uint64_t num_regions = region_space->num_regions();
+            for (uint64_t i = 0; i < num_regions; ++i) {
+                space::RegionSpace::Region r(regions.Ptr() + i * SIZEOF(Region), regions);
+                if (r.IsFree() || r.IsLargeTail())
+                    continue;
+
+                unit.region = r.Ptr();
+                unit.begin = r.Begin();
+                unit.end = r.Top();
+                unit.live_bytes = r.LiveBytes();
+                if (r.IsLarge()) {
+                    unit.mode = UNIT_LARGE;
+                } else if (unit.live_bytes != (static_cast<uint64_t>(-1) & bit_mask)
+                        && unit.live_bytes != unit.end - unit.begin) {
+                    unit.mode = UNIT_BITMAP;
+                } else {
+                    unit.mode = UNIT_LINEAR;
+                }
+                units.push_back(unit);
+            }
+            continue;
+        } else {
+            if (!(flag & Android::EACH_APP_OBJECTS)) continue;
+            if (sp->GetType() == space::kSpaceTypeInvalidSpace) {
+                LOGE("please run sysroot libart.so and run env art -c, %s invalid space.\n", sp->GetName());
+                continue;
+            }
+        }
+        units.push_back(unit);
+    }
+
+    for (const auto& space : heap.GetDiscontinuousSpaces()) {
+        space::DiscontinuousSpace* dsp = space.get();
+        if (!dsp->IsLargeObjectSpace())
+            continue;
+
+        space::LargeObjectSpace* sp = reinterpret_cast<space::LargeObjectSpace *>(dsp);
+        ranges.push_back(std::pair<uint64_t, uint64_t>(sp->Begin(), sp->End()));
+        if (!(flag & Android::EACH_APP_OBJECTS) || !sp->IsVaildSpace())
+            continue;
+        units.push_back({UNIT_SPACE, 0x0, sp->Begin(), sp->End(), 0, sp->GetName(), dsp, 0, 0, {}});
+    }
+
+    std::sort(ranges.begin(), ranges.end());
+    std::vector<std::pair<uint64_t, uint64_t>> merged;
+    for (const auto& range : ranges) {
+        if (!merged.empty() && range.first <= merged.back().second) {
+            merged.back().second = std::max(merged.back().second, range.second);
+        } else {
+            merged.push_back(range);
+        }
+    }
+    ranges.swap(merged);
+}
+
+bool Verification::IsKnownAddress(uint64_t addr) {
+    auto it = std::upper_bound(ranges.begin(), ranges.end(), addr,
+            [](uint64_t value, const std::pair<uint64_t, uint64_t>& range) {
+        return value < range.first;
+    });
+    if (it == ranges.begin())
+        return false;
+    --it;
+    return addr < it->second;
+}
+
+void Verification::Verify(int threads) {
+    CollectUnits();
+
+    // large units first, they bound the total time.
+    std::vector<uint32_t> order(units.size());
+    for (uint32_t i = 0; i < order.size(); ++i) order[i] = i;
+    std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+        bool space_a = units[a].mode == UNIT_SPACE;
+        bool space_b = units[b].mode == UNIT_SPACE;
+        if (space_a != space_b) return space_a;
+        return units[a].end - units[a].begin > units[b].end - units[b].begin;
+    });
+
+    nthreads = threads > 0 ? threads : std::thread::hardware_concurrency();
+    nthreads = std::max(1, std::min<int>(nthreads, units.size()));
+
+    std::atomic<uint32_t> next(0);
+    auto worker = [&]() {
+        LayoutCache layouts;
+        uint32_t i;
+        while ((i = next.fetch_add(1)) < order.size()) {
+            Unit& unit = units[order[i]];
+            try {
+                VerifyUnit(unit, layouts);
+            } catch (InvalidAddressException& e) {
+                unit.corruptions.push_back({unit.begin, unit.end, CORRUPT_UNREADABLE, 0x0, 0x0, 0x0});
+            }
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (int i = 1; i < nthreads; ++i)
+        workers.emplace_back(worker);
+    worker();
+    for (auto& thread : workers)
+        thread.join();
+}
+
+void Verification::VerifyUnit(Unit& unit, LayoutCache& layouts) {
+    switch (unit.mode) {
+        case UNIT_LINEAR:
+            VerifyLinear(unit, layouts);
+            break;
+        case UNIT_BITMAP:
+            VerifyBitmap(unit, layouts);
+            break;
+        case UNIT_LARGE:
+            VerifyLarge(unit, layouts);
+            break;
+        case UNIT_SPACE:
+            VerifySpace(unit, layouts);
+            break;
+    }
+}
+
+void Verification::VerifyLinear(Unit& unit, LayoutCache& layouts) {
+    CorruptionTracker tracker(unit);
+    uint64_t pos = unit.begin;
+    mirror::Object object_cache = pos;
+    object_cache.Prepare(false);
+
+    while (pos < unit.end) {
+        mirror::Object object(pos, object_cache);
+        uint64_t size = 0;
+        uint64_t detail = 0;
+        int reason = CheckObject(object, unit.end, &size, &detail, layouts);
+        if (!(reason & (CORRUPT_CLASS | CORRUPT_SIZE))) {
+            uint64_t next = RoundUp(pos + size, kObjectAlignment);
+            if (reason) {
+                tracker.Corrupt(pos, next, reason, detail);
+            } else {
+                tracker.Valid(pos);
+            }
+            unit.objects++;
+            unit.bytes += next - pos;
+            pos = next;
+        } else {
+            uint64_t next = std::min(object.NextValidOffset(unit.end), unit.end);
+            tracker.Corrupt(pos, next, reason, detail);
+            pos = next;
+        }
+    }
+}
+
+void Verification::VerifyBitmap(Unit& unit, LayoutCache& layouts) {
+    CorruptionTracker tracker(unit);
+    space::RegionSpace* region_space = reinterpret_cast<space::RegionSpace*>(unit.space);
+    mirror::Object object_cache = unit.begin;
+    object_cache.Prepare(false);
+    uint64_t prev_end = unit.begin;
+
+    auto visitor = [&](uint64_t addr) {
+        mirror::Object object(addr, object_cache);
+        uint64_t size = 0;
+        uint64_t detail = 0;
+        int reason = CheckObject(object, unit.end, &size, &detail, layouts);
+        // marked inside the previous object
+        if (addr < prev_end)
+            reason |= CORRUPT_BITMAP;
+
+        if (reason & (CORRUPT_CLASS | CORRUPT_SIZE)) {
+            // the bitmap marks something that is not an object
+            tracker.Corrupt(addr, addr + kObjectAlignment, reason | CORRUPT_BITMAP, detail);
+            return;
+        }
+
+        uint64_t end = RoundUp(addr + size, kObjectAlignment);
+        if (reason) {
+            tracker.Corrupt(addr, end, reason, detail);
+        } else {
+            tracker.Valid(addr);
+        }
+        unit.objects++;
+        unit.bytes += end - addr;
+        prev_end = std::max(prev_end, end);
+    };
+    region_space->GetLiveBitmap().VisitMarkedAddress(unit.begin, unit.end, visitor);
+}
+
+void Verification::VerifyLarge(Unit& unit, LayoutCache& layouts) {
+    CorruptionTracker tracker(unit);
+    mirror::Object object(unit.begin);
+    object.Prepare(false);
+    uint64_t size = 0;
+    uint64_t detail = 0;
+    int reason = CheckObject(object, std::max(unit.end, unit.begin + kObjectAlignment), &size, &detail, layouts);
+    if (reason) {
+        tracker.Corrupt(unit.begin, unit.end, reason, detail);
+    } else {
+        tracker.Valid(unit.begin);
+        unit.objects++;
+        unit.bytes += size;
+    }
+}
+
+void Verification::VerifySpace(Unit& unit, LayoutCache& layouts) {
+    CorruptionTracker tracker(unit);
+    space::Space* sp = reinterpret_cast<space::Space*>(unit.space);
+    uint64_t prev_end = 0x0;
+
+    auto visitor = [&](mirror::Object& object) -> bool {
+        uint64_t size = 0;
+        uint64_t detail = 0;
+        int reason = CheckObject(object, unit.end, &size, &detail, layouts);
+        if (object.Ptr() < prev_end)
+            reason |= CORRUPT_BITMAP;
+
+        uint64_t end = RoundUp(object.Ptr() + std::max(size, (uint64_t)kObjectAlignment), kObjectAlignment);
+        if (reason) {
+            tracker.Corrupt(object.Ptr(), end, reason, detail);
+        } else {
+            tracker.Valid(object.Ptr());
+        }
+        unit.objects++;
+        unit.bytes += size;
+        prev_end = std::max(prev_end, end);
+        return false;
+    };
+    sp->Walk(visitor, false);
+}
+
+int Verification::CheckObject(mirror::Object& object, uint64_t end, uint64_t* size, uint64_t* detail, LayoutCache& layouts) {
+    int reason = 0;
+    if (object.Ptr() % kObjectAlignment)
+        reason |= CORRUPT_ALIGN;
+
+    mirror::Class klass = 0x0;
+    try {
+        klass = object.GetClass();
+        if (!klass.Ptr() || !IsKnownAddress(klass.Ptr()) || !klass.IsClass()) {
+            *detail = klass.Ptr();
+            return reason | CORRUPT_CLASS;
+        }
+    } catch (InvalidAddressException& e) {
+        *detail = klass.Ptr();
+        return reason | CORRUPT_CLASS;
+    }
+
+    try {
+        *size = object.SizeOf();
+    } catch (InvalidAddressException& e) {
+        *size = 0;
+    }
+    if ((int64_t)*size < (int64_t)kObjectAlignment || object.Ptr() + *size > end) {
+        *detail = *size;
+        return reason | CORRUPT_SIZE;
+    }
+
+    try {
+        if (object.IsObjectArray()) {
+            mirror::Array array = object;
+            int32_t length = array.GetLength();
+            api::MemoryRef data(array.GetRawData(sizeof(uint32_t), 0), array);
+            uint32_t* refs = reinterpret_cast<uint32_t *>(data.Real(0, length * sizeof(uint32_t)));
+            for (int32_t i = 0; i < length; ++i) {
+                if (refs[i] && (refs[i] % kObjectAlignment || !IsKnownAddress(refs[i]))) {
+                    *detail = refs[i];
+                    return reason | CORRUPT_REFERENCE;
+                }
+            }
+        } else {
+            auto callback = [&](uint32_t offset, uint32_t ref) -> bool {
+                if (offset + sizeof(uint32_t) > *size)
+                    return false;
+                if (ref && (ref % kObjectAlignment || !IsKnownAddress(ref))) {
+                    *detail = ref;
+                    reason |= CORRUPT_REFERENCE;
+                    return true;
+                }
+                return false;
+            };
+            ClassLayout::VisitReferences(object, GetReferenceOffsets(klass, layouts), callback);
+        }
+    } catch (InvalidAddressException& e) {
+        reason |= CORRUPT_UNREADABLE;
+    }
+    return reason;
+}
+
+const std::vector<uint32_t>& Verification::GetReferenceOffsets(mirror::Class& klass, LayoutCache& layouts) {
+    auto it = layouts.find(klass.Ptr());
+    if (it != layouts.end())
+        return it->second;
+
+    std::lock_guard<std::mutex> lock(layouts_lock);
+    std::vector<uint32_t> offsets;
+    try {
+        offsets = ClassLayout::Get(klass).references;
+    } catch (InvalidAddressException& e) {
+        // unknown layout, skip reference check
+    }
+    return layouts.insert(std::make_pair(klass.Ptr(), std::move(offsets))).first->second;
+}
+
+std::string Verification::ReasonToString(int reason) {
+    static const char* kNames[] = {"class", "size", "align", "bitmap", "reference", "unreadable"};
+    std::string result;
+    for (int i = 0; i < sizeof(kNames) / sizeof(kNames[0]); ++i) {
+        if (!(reason & (1 << i)))
+            continue;
+        if (result.length()) result.append(",");
+        result.append(kNames[i]);
+    }
+    return result;
+}
+
+} // namespace gc
+} // namespace art
@@ -0,0 +1,110 @@
+/*
+ * Copyright (C) 2024-present, Guanyou.Chen. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef ANDROID_ART_RUNTIME_GC_VERIFICATION_H_
+#define ANDROID_ART_RUNTIME_GC_VERIFICATION_H_
+
+#include "runtime/mirror/object.h"
+#include <stdint.h>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace art {
+namespace gc {
+
+/*
+ * Heap integrity check. Every RegionSpace region and every other
+ * continuous or large object space is one unit, units are verified
+ * by a pool of threads. Each object is checked for a valid class
+ * pointer, a sane size, alignment, live bitmap agreement and that
+ * its references point into a known space. Bad objects are merged
+ * into corrupt ranges with the nearest valid objects around them.
+ */
+class Verification {
+public:
+    static constexpr int CORRUPT_CLASS = 1 << 0;
+    static constexpr int CORRUPT_SIZE = 1 << 1;
+    static constexpr int CORRUPT_ALIGN = 1 << 2;
+    static constexpr int CORRUPT_BITMAP = 1 << 3;
+    static constexpr int CORRUPT_REFERENCE = 1 << 4;
+    static constexpr int CORRUPT_UNREADABLE = 1 << 5;
+
+    static constexpr int UNIT_LINEAR = 0;  // objects are contiguous from begin to end
+    static constexpr int UNIT_BITMAP = 1;  // objects are marked in the live bitmap
+    static constexpr int UNIT_LARGE = 2;   // single large object
+    static constexpr int UNIT_SPACE = 3;   // walked by the space itself
+
+    struct Corruption {
+        uint64_t begin;
+        uint64_t end;
+        int reason;
+        // bad class pointer, bad size or bad reference target
+        uint64_t detail;
+        // nearest valid objects, 0x0 if none in this unit
+        uint64_t prev;
+        uint64_t next;
+    };
+
+    struct Unit {
+        int mode;
+        // RegionSpace::Region, 0x0 for a whole space
+        uint64_t region;
+        uint64_t begin;
+        uint64_t end;
+        uint64_t live_bytes;
+        const char* name;
+        void* space;
+        uint64_t objects;
+        uint64_t bytes;
+        std::vector<Corruption> corruptions;
+    };
+
+    // class -> reference field offsets
+    typedef std::unordered_map<uint64_t, std::vector<uint32_t>> LayoutCache;
+
+    Verification(int flag) : flag(flag) {}
+    // threads <= 0 means hardware concurrency
+    void Verify(int threads);
+    std::vector<Unit>& GetUnits() { return units; }
+    int GetThreads() { return nthreads; }
+    static std::string ReasonToString(int reason);
+private:
+    void CollectUnits();
+    bool IsKnownAddress(uint64_t addr);
+    void VerifyUnit(Unit& unit, LayoutCache& layouts);
+    void VerifyLinear(Unit& unit, LayoutCache& layouts);
+    void VerifyBitmap(Unit& unit, LayoutCache& layouts);
+    void VerifyLarge(Unit& unit, LayoutCache& layouts);
+    void VerifySpace(Unit& unit, LayoutCache& layouts);
+    int CheckObject(mirror::Object& object, uint64_t end, uint64_t* size, uint64_t* detail, LayoutCache& layouts);
+    const std::vector<uint32_t>& GetReferenceOffsets(mirror::Class& klass, LayoutCache& layouts);
+
+    int flag;
+    int nthreads = 0;
+    std::vector<Unit> units;
+    // sorted, non-overlapping [begin, end) of known spaces
+    std::vector<std::pair<uint64_t, uint64_t>> ranges;
+    // ClassLayout is not thread safe, each thread keeps its own copy in front
+    std::mutex layouts_lock;
+};
+
+} // namespace gc
+} // namespace art
+
+#endif // ANDROID_ART_RUNTIME_GC_VERIFICATION_H_
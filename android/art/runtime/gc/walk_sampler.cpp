@@ -0,0 +1,67 @@
+/*
+ * Copyright (C) 2024-present, Guanyou.Chen. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "runtime/gc/walk_sampler.h"
+
+namespace art {
+namespace gc {
+
+bool WalkSampler::kEnabled = false;
+double WalkSampler::kRate = 1.0;
+uint64_t WalkSampler::kSeed = 0;
+uint64_t WalkSampler::kUnit = 0;
+uint64_t WalkSampler::kTotal = 0;
+uint64_t WalkSampler::kPicked = 0;
+
+void WalkSampler::Enable(double rate, uint64_t seed) {
+    kEnabled = rate < 1.0;
+    kRate = rate;
+    kSeed = seed;
+    kUnit = 0;
+    kTotal = 0;
+    kPicked = 0;
+}
+
+void WalkSampler::Disable() {
+    kEnabled = false;
+    kRate = 1.0;
+    kUnit = 0;
+}
+
+bool WalkSampler::Pick(uint64_t unit) {
+    // walked in full, or a sub unit of a picked unit
+    if (!kEnabled || kUnit)
+        return true;
+
+    // splitmix64
+    uint64_t z = unit ^ kSeed;
+    z += 0x9e3779b97f4a7c15ULL;
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    z ^= z >> 31;
+
+    kTotal++;
+    if ((z >> 11) * (1.0 / 9007199254740992.0) >= kRate)
+        return false;
+
+    kPicked++;
+    kUnit = unit;
+    return true;
+}
+
+} // namespace gc
+} // namespace art
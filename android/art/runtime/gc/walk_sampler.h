@@ -0,0 +1,72 @@
+/*
+ * Copyright (C) 2024-present, Guanyou.Chen. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef ANDROID_ART_RUNTIME_GC_WALK_SAMPLER_H_
+#define ANDROID_ART_RUNTIME_GC_WALK_SAMPLER_H_
+
+#include <stdint.h>
+
+namespace art {
+namespace gc {
+
+/*
+ * Bernoulli sampling of heap walk units (RegionSpace regions and live
+ * bitmap words). A walker asks Pick(unit) before reading a unit and
+ * skips it on false, objects visited inside a picked unit carry
+ * Weight() = 1 / rate. Units are chosen by a seeded hash of their
+ * address, so the same seed samples the same units.
+ *
+ *   if (!WalkSampler::Pick(region.Ptr()))
+ *       continue;
+ *   WalkSampler::Scope scope(region.Ptr());
+ *   ... visit region ...
+ */
+class WalkSampler {
+public:
+    static void Enable(double rate, uint64_t seed);
+    static void Disable();
+    static bool IsEnabled() { return kEnabled; }
+    static double Rate() { return kRate; }
+    static bool Pick(uint64_t unit);
+    static void Leave(uint64_t unit) { if (kUnit == unit) kUnit = 0; }
+    // 0 when current object is not inside a sampled unit.
+    static uint64_t Unit() { return kUnit; }
+    static double Weight() { return kUnit ? 1.0 / kRate : 1.0; }
+    static uint64_t TotalUnits() { return kTotal; }
+    static uint64_t PickedUnits() { return kPicked; }
+
+    // Leave(unit) at scope exit, also when the visitor or a read throws.
+    class Scope {
+    public:
+        explicit Scope(uint64_t unit) : unit_(unit) {}
+        ~Scope() { Leave(unit_); }
+    private:
+        uint64_t unit_;
+    };
+private:
+    static bool kEnabled;
+    static double kRate;
+    static uint64_t kSeed;
+    static uint64_t kUnit;
+    static uint64_t kTotal;
+    static uint64_t kPicked;
+};
+
+} // namespace gc
+} // namespace art
+
+#endif // ANDROID_ART_RUNTIME_GC_WALK_SAMPLER_H_
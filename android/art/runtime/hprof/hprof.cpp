@@ -23,7 +23,9 @@
 #include "runtime/mirror/class.h"
 #include "runtime/mirror/array.h"
 #include "runtime/runtime_globals.h"
+#include "runtime/class_layout.h"
 #include "android.h"
+#include "heap_walk.h"
 #include <vector>
 #include <unordered_map>
 #include <stdio.h>
@@ -410,7 +412,7 @@ private:
         auto callback = [&](art::mirror::Object& object) -> bool {
             return DumpHeapObject(object);
         };
-        Android::ForeachObjects(callback);
+        Android::ForEachObject(callback);
         output_->StartNewRecord(HPROF_TAG_HEAP_DUMP_END, 0x0);
         output_->EndRecord();
     }
@@ -481,8 +483,7 @@ private:
     }
 
     HprofStringId LookupClassNameId(mirror::Class& c) {
-        std::string desc = c.PrettyDescriptor();
-        return LookupStringId(desc);
+        return LookupStringId(c.CachedDescriptor());
     }
 
     HprofClassObjectId LookupClassId(mirror::Class& c) {
@@ -835,16 +836,16 @@ void Hprof::DumpHeapArray(mirror::Array& array, mirror::Class& klass) {
         // Dump the raw, packed element values.
         if (size == 1) {
             api::MemoryRef ref(array.GetRawData(sizeof(uint8_t), 0), array);
-            __ AddU1List(reinterpret_cast<uint8_t*>(ref.Real()), length);
+            __ AddU1List(reinterpret_cast<uint8_t*>(ref.Real(0, length * sizeof(uint8_t))), length);
         } else if (size == 2) {
             api::MemoryRef ref(array.GetRawData(sizeof(uint16_t), 0), array);
-            __ AddU2List(reinterpret_cast<uint16_t*>(ref.Real()), length);
+            __ AddU2List(reinterpret_cast<uint16_t*>(ref.Real(0, length * sizeof(uint16_t))), length);
         } else if (size == 4) {
             api::MemoryRef ref(array.GetRawData(sizeof(uint32_t), 0), array);
-            __ AddU4List(reinterpret_cast<uint32_t*>(ref.Real()), length);
+            __ AddU4List(reinterpret_cast<uint32_t*>(ref.Real(0, length * sizeof(uint32_t))), length);
         } else if (size == 8) {
             api::MemoryRef ref(array.GetRawData(sizeof(uint64_t), 0), array);
-            __ AddU8List(reinterpret_cast<uint64_t*>(ref.Real()), length);
+            __ AddU8List(reinterpret_cast<uint64_t*>(ref.Real(0, length * sizeof(uint64_t))), length);
         }
     }
 }
@@ -864,25 +865,22 @@ void Hprof::DumpHeapInstanceObject(mirror::Object& object, mirror::Class& klass)
     mirror::Object string_value = 0x0;
     mirror::Object fake_object_array = 0x0;
 
-    mirror::Class super = klass;
-    do {
-        auto instance_field_writer = [&](ArtField& field) -> bool {
-            Android::BasicType type = Android::SignatureToBasicTypeAndSize(field.GetTypeDescriptor(), nullptr, "B");
-            switch (type) {
+    const ClassLayout::Layout& layout = ClassLayout::Get(klass);
+    for (const auto& segment : layout.segments) {
+        mirror::Class super(segment.klass, klass);
+        for (uint32_t i = segment.begin; i < segment.end; ++i) {
+            const ClassLayout::Field& field = layout.fields[i];
+            switch (field.type) {
                 case Android::basic_byte:
-                    __ AddU1(field.GetByte(object));
-                    break;
                 case Android::basic_boolean:
-                    __ AddU1(field.GetBoolean(object));
+                    __ AddU1(object.value8Of(field.offset));
                     break;
                 case Android::basic_char:
-                    __ AddU2(field.GetChar(object));
-                    break;
                 case Android::basic_short:
-                    __ AddU2(field.GetShort(object));
+                    __ AddU2(object.value16Of(field.offset));
                     break;
                 case Android::basic_int:
-                    if (field.offset() == OFFSET(String, count_) && super.IsStringClass()) {
+                    if (field.offset == OFFSET(String, count_) && super.IsStringClass()) {
                         mirror::String str = object;
                         __ AddU4(str.GetLength());
                         break;
@@ -890,16 +888,14 @@ void Hprof::DumpHeapInstanceObject(mirror::Object& object, mirror::Class& klass)
                 [[fallthrough]];
                 case Android::basic_float:
                 case Android::basic_object:
-                    __ AddU4(field.Get32(object));
+                    __ AddU4(object.value32Of(field.offset));
                     break;
                 case Android::basic_double:
                 case Android::basic_long:
-                    __ AddU8(field.Get64(object));
+                    __ AddU8(object.value64Of(field.offset));
                     break;
             }
-            return false;
-        };
-        Android::ForeachInstanceField(super, instance_field_writer);
+        }
 
         if (super.IsStringClass()) {
             mirror::String str = object;
@@ -913,8 +909,7 @@ void Hprof::DumpHeapInstanceObject(mirror::Object& object, mirror::Class& klass)
             //fake_object_array = object.Ptr() + (kObjectAlignment / 2);
             //__ AddObjectId(fake_object_array);
         }
-        super = super.GetSuperClass();
-    } while (super.Ptr());
+    }
 
     __ UpdateU4(size_patch_offset, output_->Length() - (size_patch_offset + 4));
 
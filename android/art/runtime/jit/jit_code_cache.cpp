@@ -19,7 +19,9 @@
 #include "android.h"
 #include "runtime/jit/jit_code_cache.h"
 #include "cxx/vector.h"
-#include <limits>
+#include "common/exception.h"
+#include "base/time_profile.h"
+#include <algorithm>
 
 struct JitCodeCache_OffsetTable __JitCodeCache_offset__;
 struct JniStubsMapPair_OffsetTable __JniStubsMapPair_offset__;
@@ -327,19 +329,124 @@ bool JitCodeCache::ContainsPc(uint64_t pc) {
 }
 
 uint64_t JitCodeCache::GetJniStubCode(ArtMethod& method) {
-    for (const auto& value : GetJniStubsMap()) {
-        JniStubsMapPair pair = value;
-        JniStubData data = pair.second();
-        cxx::vector methods_(data.methods(), data);
-        methods_.SetEntrySize(CoreApi::GetPointSize());
-        for (const auto& m : methods_) {
-            api::MemoryRef ref = m;
-            if (ref.valueOf() == method.Ptr()) {
-                return data.code();
+    GetCodeEntries();
+    auto it = jni_stub_codes.find(method.Ptr());
+    if (it != jni_stub_codes.end())
+        return it->second;
+    return 0x0;
+}
+
+std::vector<JitCodeCache::CodeEntry>& JitCodeCache::GetCodeEntries() {
+    if (code_entries_ready)
+        return code_entries;
+
+    code_entries_ready = true;
+    TimeProfile::Scope profile("jit: code map");
+    uint32_t point_size = CoreApi::GetPointSize();
+
+    auto add = [&](uint64_t code, uint64_t method, int type) {
+        if (!code)
+            return;
+        uint64_t size = 0;
+        try {
+            size = OatQuickMethodHeader::FromCodePointer(code).GetCodeSize();
+        } catch (InvalidAddressException& e) {
+            // do nothing
+        }
+        code_entries.push_back({code, size, method, type});
+    };
+
+    // SafeMap<const void*, ArtMethod*> method_code_map_
+    try {
+        for (const auto& value : GetMethodCodeMap()) {
+            api::MemoryRef ref = value;
+            add(ref.valueOf(), ref.valueOf(point_size), CODE_METHOD);
+        }
+    } catch (InvalidAddressException& e) {
+        LOGD("Read method_code_map_ interrupted.\n");
+    }
+
+    // SafeMap<JniStubKey, JniStubData> jni_stubs_map_
+    if (Android::Sdk() >= Android::P) {
+        try {
+            for (const auto& value : GetJniStubsMap()) {
+                JniStubsMapPair pair = value;
+                JniStubData data = pair.second();
+                uint64_t code = data.code();
+                cxx::vector methods_(data.methods(), data);
+                methods_.SetEntrySize(point_size);
+                uint64_t first = 0x0;
+                for (const auto& m : methods_) {
+                    api::MemoryRef ref = m;
+                    if (!first) first = ref.valueOf();
+                    jni_stub_codes[ref.valueOf()] = code;
+                }
+                add(code, first, CODE_JNI_STUB);
             }
+        } catch (InvalidAddressException& e) {
+            LOGD("Read jni_stubs_map_ interrupted.\n");
         }
     }
-    return 0x0;
+
+    if (Android::Sdk() >= Android::R) {
+        try {
+            ZygoteMap& zygote_map = GetZygoteMap();
+            api::MemoryRef array_ = zygote_map.array();
+            uint64_t size = zygote_map.size();
+            for (uint64_t i = 0; i < size; ++i) {
+                uint64_t method = array_.valueOf(i * 2 * point_size);
+                uint64_t code = array_.valueOf(i * 2 * point_size + point_size);
+                if (method) add(code, method, CODE_ZYGOTE);
+            }
+        } catch (InvalidAddressException& e) {
+            LOGD("Read zygote_map_ interrupted.\n");
+        }
+    }
+
+    // stable, so entries of the same code keep the add order and
+    // method_code_map_ wins over jni stubs and the zygote map.
+    std::stable_sort(code_entries.begin(), code_entries.end(),
+            [](const CodeEntry& a, const CodeEntry& b) { return a.code_start < b.code_start; });
+    auto last = std::unique(code_entries.begin(), code_entries.end(),
+            [](const CodeEntry& a, const CodeEntry& b) { return a.code_start == b.code_start; });
+    code_entries.erase(last, code_entries.end());
+    return code_entries;
+}
+
+void JitCodeCache::PrepareCodeEntries() {
+    if (!Android::IsSdkReady())
+        return;
+
+    try {
+        Runtime& runtime = Runtime::Current();
+        if (!runtime.Ptr())
+            return;
+        Jit& jit = runtime.GetJit();
+        if (jit.Ptr() && jit.GetCodeCache().Ptr())
+            jit.GetCodeCache().GetCodeEntries();
+    } catch (InvalidAddressException& e) {
+        LOGD("Prepare jit code entries interrupted.\n");
+    }
+}
+
+JitCodeCache::CodeEntry* JitCodeCache::LookupCodeEntry(uint64_t pc) {
+    std::vector<CodeEntry>& entries = GetCodeEntries();
+    auto it = std::upper_bound(entries.begin(), entries.end(), pc,
+            [](uint64_t value, const CodeEntry& entry) { return value < entry.code_start; });
+    if (it == entries.begin())
+        return nullptr;
+    --it;
+
+    if (it->code_size) {
+        if (pc < it->code_start + it->code_size)
+            return &(*it);
+        return nullptr;
+    }
+
+    // unknown size, ask the method header.
+    if (OatQuickMethodHeader::FromCodePointer(it->code_start).Contains(pc))
+        return &(*it);
+    return nullptr;
 }
 
 uint64_t ZygoteMap::GetCodeFor(ArtMethod& method, uint64_t pc) {
@@ -374,26 +481,10 @@ uint64_t ZygoteMap::GetCodeFor(ArtMethod& method, uint64_t pc) {
 }
 
 OatQuickMethodHeader JitCodeCache::LookupMethodCodeMap(uint64_t pc, ArtMethod& /*method*/) {
-    if (!GetMethodCodeMap().size()) {
+    CodeEntry* entry = LookupCodeEntry(pc);
+    if (!entry)
         return 0x0;
-    }
-
-    uint64_t code_ptr;
-    uint32_t point_size = CoreApi::GetPointSize();
-    uint64_t nice = std::numeric_limits<uint64_t>::max();
-    for (const auto& value : GetMethodCodeMap()) {
-        api::MemoryRef ref = value;
-        uint64_t tmp_pc = ref.valueOf();
-        if (pc < tmp_pc)
-            continue;
-
-        if (pc - tmp_pc <= nice) {
-            nice = pc - tmp_pc;
-            code_ptr = tmp_pc;
-        }
-    }
-
-    return OatQuickMethodHeader::FromCodePointer(code_ptr);
+    return OatQuickMethodHeader::FromCodePointer(entry->code_start);
 }
 
 OatQuickMethodHeader JitCodeCache::LookupMethodHeader(uint64_t pc, ArtMethod& method) {
@@ -406,38 +497,10 @@ OatQuickMethodHeader JitCodeCache::LookupMethodHeader(uint64_t pc, ArtMethod& me
         return method_header;
     }
 
-    // SafeMap<JniStubKey, JniStubData> jni_stubs_map_ GUARDED_BY(lock_);
-    // SafeMap<const void*, ArtMethod*> method_code_map_ GUARDED_BY(lock_);
-    if (Android::Sdk() >= Android::P) {
-        if (method.Ptr() && method.IsNative()) {
-            uint64_t entry_point = GetJniStubCode(method);
-            if (!entry_point)
-                return 0x0;
-
-            method_header = OatQuickMethodHeader::FromCodePointer(entry_point);
-            if (!method_header.Contains(pc)) {
-                return 0x0;
-            }
-        } else {
-            if (Android::Sdk() >= Android::R) {
-                if (GetSharedRegion().IsInExecSpace(pc)) {
-                    uint64_t code_ptr = GetZygoteMap().GetCodeFor(method, pc);
-                    if (code_ptr) {
-                        return OatQuickMethodHeader::FromCodePointer(code_ptr);
-                    }
-                }
-            }
-
-            method_header = LookupMethodCodeMap(pc, method);
-            if (!method_header.Contains(pc)) {
-                return 0x0;
-            }
-        }
-    } else {
-        method_header = LookupMethodCodeMap(pc, method);
-        if (!method_header.Contains(pc)) {
-            return 0x0;
-        }
+    // jni stubs, zygote map and method_code_map_ are merged in one sorted table
+    method_header = LookupMethodCodeMap(pc, method);
+    if (!method_header.Ptr() || !method_header.Contains(pc)) {
+        return 0x0;
     }
 
     return method_header;
@@ -22,6 +22,8 @@
 #include "runtime/jit/jit_memory_region.h"
 #include "base/mem_map.h"
 #include "cxx/map.h"
+#include <unordered_map>
+#include <vector>
 
 struct JitCodeCache_OffsetTable {
     uint32_t code_map_;
@@ -78,6 +80,18 @@ public:
 
 class JitCodeCache : public api::MemoryRef {
 public:
+    static constexpr int CODE_METHOD = 0;
+    static constexpr int CODE_JNI_STUB = 1;
+    static constexpr int CODE_ZYGOTE = 2;
+
+    struct CodeEntry {
+        uint64_t code_start;
+        // 0 if the method header is unreadable
+        uint64_t code_size;
+        uint64_t method;
+        int type;
+    };
+
     JitCodeCache(uint64_t v) : api::MemoryRef(v) {}
     JitCodeCache(const api::MemoryRef& ref) : api::MemoryRef(ref) {}
     JitCodeCache(uint64_t v, api::MemoryRef& ref) : api::MemoryRef(v, ref) {}
@@ -117,6 +131,16 @@ public:
     bool ContainsPc(uint64_t pc);
     uint64_t GetJniStubCode(ArtMethod& method);
 
+    /*
+     * method_code_map_, jni_stubs_map_ and the zygote map read once into
+     * a host array sorted by code start, pc lookups are binary searches.
+     */
+    std::vector<CodeEntry>& GetCodeEntries();
+    CodeEntry* LookupCodeEntry(uint64_t pc);
+    // read the code entries of the current runtime in the command parent,
+    // forked command children inherit them with the runtime caches.
+    static void PrepareCodeEntries();
+
     class JniStubKey : public api::MemoryRef {
     public:
         JniStubKey(uint64_t v) : api::MemoryRef(v) {}
@@ -158,6 +182,11 @@ private:
     cxx::map method_code_map_cache = 0x0;
     MemMap zygote_exec_pages_cache = 0x0;
     ZygoteMap zygote_map_cache = 0x0;
+
+    bool code_entries_ready = false;
+    std::vector<CodeEntry> code_entries;
+    // ArtMethod -> jni stub code
+    std::unordered_map<uint64_t, uint64_t> jni_stub_codes;
 };
 
 } // namespace jit
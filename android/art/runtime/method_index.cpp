@@ -0,0 +1,231 @@
+/*
+ * Copyright (C) 2024-present, Guanyou.Chen. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "logger/log.h"
+#include "android.h"
+#include "runtime/method_index.h"
+#include "runtime/class_index.h"
+#include "runtime/class_linker.h"
+#include "runtime/runtime.h"
+#include "runtime/jit/jit.h"
+#include "runtime/jit/jit_code_cache.h"
+#include "runtime/entrypoints/runtime_asm_entrypoints.h"
+#include "common/exception.h"
+#include <algorithm>
+#include <atomic>
+#include <regex>
+#include <thread>
+
+namespace art {
+
+bool MethodIndex::kReady = false;
+bool MethodIndex::kAttempted = false;
+std::vector<MethodIndex::Entry> MethodIndex::kEntries;
+std::unordered_multimap<uint32_t, uint32_t> MethodIndex::kDexMethodIndexes;
+
+void MethodIndex::Build(int threads) {
+    Clean();
+
+    // classes of one dex cache share the dex file reads, keep them in one task.
+    std::unordered_map<uint64_t, uint32_t> groups;
+    std::vector<std::vector<uint64_t>> tasks;
+    auto group_class = [&](mirror::Class& clazz) -> bool {
+        uint64_t dex_cache = 0x0;
+        try {
+            dex_cache = clazz.dex_cache();
+        } catch (InvalidAddressException& e) {}
+
+        auto it = groups.find(dex_cache);
+        if (it == groups.end()) {
+            it = groups.insert(std::pair<uint64_t, uint32_t>(dex_cache, tasks.size())).first;
+            tasks.emplace_back();
+        }
+        tasks[it->second].push_back(clazz.Ptr());
+        return false;
+    };
+    ClassIndex::Foreach(group_class);
+
+    std::vector<uint32_t> order(tasks.size());
+    for (uint32_t i = 0; i < order.size(); ++i) order[i] = i;
+    std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+        return tasks[a].size() > tasks[b].size();
+    });
+
+    int nthreads = threads > 0 ? threads : std::thread::hardware_concurrency();
+    nthreads = std::max(1, std::min<int>(nthreads, tasks.size()));
+
+    std::vector<std::vector<Entry>> results(tasks.size());
+    std::atomic<uint32_t> next(0);
+    auto worker = [&]() {
+        uint32_t i;
+        while ((i = next.fetch_add(1)) < order.size())
+            NameMethods(tasks[order[i]], results[order[i]]);
+    };
+
+    std::vector<std::thread> workers;
+    for (int i = 1; i < nthreads; ++i)
+        workers.emplace_back(worker);
+    worker();
+    for (auto& thread : workers)
+        thread.join();
+
+    // entry point kinds read runtime and jit caches, resolve them here.
+    std::vector<Entry> entries;
+    for (auto& result : results) {
+        for (auto& entry : result) {
+            entry.code = ResolveCode(entry.entry_point);
+            entries.push_back(std::move(entry));
+        }
+    }
+
+    Load(entries);
+    LOGD("MethodIndex build %ld methods with %d threads.\n", kEntries.size(), nthreads);
+}
+
+void MethodIndex::Load(std::vector<Entry>& entries) {
+    Clean();
+
+    auto compare = [](const Entry& a, const Entry& b) -> bool {
+        int ret = a.name.compare(b.name);
+        return ret ? ret < 0 : a.method < b.method;
+    };
+    std::sort(entries.begin(), entries.end(), compare);
+
+    kEntries = std::move(entries);
+    for (uint32_t idx = 0; idx < kEntries.size(); ++idx)
+        kDexMethodIndexes.insert(std::pair<uint32_t, uint32_t>(kEntries[idx].dex_method_idx, idx));
+    kReady = true;
+    kAttempted = true;
+}
+
+void MethodIndex::Prepare(int threads) {
+    if (kReady || kAttempted)
+        return;
+
+    try {
+        Build(threads);
+    } catch (InvalidAddressException& e) {
+        LOGW("MethodIndex build was interrupted!\n");
+        // drop the unsorted partial entries.
+        Clean();
+    }
+    kAttempted = true;
+}
+
+void MethodIndex::NameMethods(std::vector<uint64_t>& classes, std::vector<Entry>& entries) {
+    std::string descriptor;
+    auto visit_method = [&](ArtMethod& method) -> bool {
+        try {
+            if (method.IsRuntimeMethod())
+                return false;
+
+            Entry entry;
+            entry.name = method.PrettyReturnTypeDescriptor();
+            entry.name.append(" ").append(descriptor).append(".");
+            entry.name.append(method.GetName());
+            entry.name.append(method.PrettyParameters());
+            entry.method = method.Ptr();
+            entry.entry_point = method.GetEntryPointFromQuickCompiledCode();
+            entry.dex_method_idx = method.GetDexMethodIndex();
+            entry.code = CODE_NONE;
+            entries.push_back(std::move(entry));
+        } catch (InvalidAddressException& e) {}
+        return false;
+    };
+
+    for (const auto& ptr : classes) {
+        mirror::Class clazz = ptr;
+        try {
+            descriptor = clazz.PrettyDescriptor();
+            Android::ForeachArtMethods(clazz, visit_method);
+        } catch (InvalidAddressException& e) {}
+    }
+}
+
+int MethodIndex::ResolveCode(uint64_t entry_point) {
+    if (!entry_point)
+        return CODE_NONE;
+
+    Runtime& runtime = Runtime::Current();
+    ClassLinker& class_linker = runtime.GetClassLinker();
+    if (class_linker.IsQuickGenericJniStub(entry_point))
+        return CODE_GENERIC_JNI;
+    if (class_linker.IsQuickResolutionStub(entry_point))
+        return CODE_RESOLUTION;
+    if (class_linker.IsQuickToInterpreterBridge(entry_point))
+        return CODE_INTERPRETER;
+    if (entry_point == GetQuickProxyInvokeHandler())
+        return CODE_PROXY;
+    if (entry_point == GetInvokeObsoleteMethodStub())
+        return CODE_OBSOLETE;
+    if (entry_point == GetExecuteNterpImplEntryPoint())
+        return CODE_NTERP;
+
+    try {
+        jit::Jit& jit = runtime.GetJit();
+        if (jit.Ptr() && jit.GetCodeCache().ContainsPc(entry_point))
+            return CODE_JIT;
+    } catch (InvalidAddressException& e) {}
+    return CODE_OAT;
+}
+
+void MethodIndex::Clean() {
+    kReady = false;
+    kAttempted = false;
+    kEntries.clear();
+    kDexMethodIndexes.clear();
+}
+
+void MethodIndex::FindByRegex(const char* regex, std::function<bool (Entry& entry)> fn) {
+    Prepare();
+    std::regex pattern(regex);
+    for (auto& entry : kEntries) {
+        if (std::regex_search(entry.name, pattern) && fn(entry))
+            break;
+    }
+}
+
+void MethodIndex::FindByDexMethodIndex(uint32_t dex_method_idx, std::function<bool (Entry& entry)> fn) {
+    Prepare();
+    auto range = kDexMethodIndexes.equal_range(dex_method_idx);
+    std::vector<uint32_t> matches;
+    for (auto it = range.first; it != range.second; ++it)
+        matches.push_back(it->second);
+
+    std::sort(matches.begin(), matches.end());
+    for (const auto& idx : matches) {
+        if (fn(kEntries[idx]))
+            break;
+    }
+}
+
+const char* MethodIndex::CodeToString(int code) {
+    switch (code) {
+        case CODE_NONE: return "NONE";
+        case CODE_OAT: return "OAT";
+        case CODE_JIT: return "JIT";
+        case CODE_NTERP: return "NTERP";
+        case CODE_INTERPRETER: return "INTERPRETER";
+        case CODE_GENERIC_JNI: return "GENERIC_JNI";
+        case CODE_RESOLUTION: return "RESOLUTION";
+        case CODE_PROXY: return "PROXY";
+        case CODE_OBSOLETE: return "OBSOLETE";
+    }
+    return "UNKNOWN";
+}
+
+} // namespace art
@@ -0,0 +1,88 @@
+/*
+ * Copyright (C) 2024-present, Guanyou.Chen. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef ANDROID_ART_RUNTIME_METHOD_INDEX_H_
+#define ANDROID_ART_RUNTIME_METHOD_INDEX_H_
+
+#include "runtime/art_method.h"
+#include <stdint.h>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace art {
+
+/*
+ * Pretty method index of all methods of loaded classes, sorted by name.
+ * Class methods are named in parallel, one dex cache per task.
+ *
+ * Consumers call Prepare() from their prepare(), the index is then built
+ * once in the parent and inherited by the forked command children.
+ *
+ *   MethodIndex::Prepare(threads);
+ *   MethodIndex::FindByRegex("android.app.ActivityThread.handle.*", fn);
+ *   MethodIndex::FindByDexMethodIndex(49967, fn);
+ */
+class MethodIndex {
+public:
+    static constexpr int CODE_NONE = 0;
+    static constexpr int CODE_OAT = 1;
+    static constexpr int CODE_JIT = 2;
+    static constexpr int CODE_NTERP = 3;
+    static constexpr int CODE_INTERPRETER = 4;
+    static constexpr int CODE_GENERIC_JNI = 5;
+    static constexpr int CODE_RESOLUTION = 6;
+    static constexpr int CODE_PROXY = 7;
+    static constexpr int CODE_OBSOLETE = 8;
+
+    struct Entry {
+        std::string name;
+        uint64_t method;
+        uint64_t entry_point;
+        uint32_t dex_method_idx;
+        int code;
+    };
+
+    static bool IsReady() { return kReady; }
+    static void Build() { Build(0); }
+    // threads 0 means hardware concurrency.
+    static void Build(int threads);
+    static void Prepare() { Prepare(0); }
+    static void Prepare(int threads);
+    static void Clean();
+    // index of entries from Build() or a saved session, sorted here.
+    static void Load(std::vector<Entry>& entries);
+    static const std::vector<Entry>& GetEntries() { return kEntries; }
+    static uint32_t Size() { return kEntries.size(); }
+    static void FindByRegex(const char* regex, std::function<bool (Entry& entry)> fn);
+    static void FindByDexMethodIndex(uint32_t dex_method_idx, std::function<bool (Entry& entry)> fn);
+    static const char* CodeToString(int code);
+private:
+    static void NameMethods(std::vector<uint64_t>& classes, std::vector<Entry>& entries);
+    static int ResolveCode(uint64_t entry_point);
+
+    static bool kReady;
+    // Prepare() ran, a failed build is not retried on every lookup.
+    static bool kAttempted;
+    static std::vector<Entry> kEntries;
+    static std::unordered_multimap<uint32_t, uint32_t> kDexMethodIndexes;
+};
+
+} // namespace art
+
+#endif // ANDROID_ART_RUNTIME_METHOD_INDEX_H_
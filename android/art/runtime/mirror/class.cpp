@@ -386,6 +386,24 @@ std::string Class::PrettyDescriptor() {
     return result;
 }
 
+std::unordered_map<uint64_t, const std::string*> Class::kDescriptorCache;
+std::unordered_set<std::string> Class::kDescriptors;
+
+const std::string& Class::CachedDescriptor() {
+    auto it = kDescriptorCache.find(Ptr());
+    if (LIKELY(it != kDescriptorCache.end()))
+        return *it->second;
+
+    const std::string& descriptor = *kDescriptors.insert(PrettyDescriptor()).first;
+    kDescriptorCache[Ptr()] = &descriptor;
+    return descriptor;
+}
+
+void Class::CleanDescriptorCache() {
+    kDescriptorCache.clear();
+    kDescriptors.clear();
+}
+
 const char* Class::GetDescriptor(std::string* storage) {
     uint64_t dim = 0u;
     Class* klass = this;
@@ -405,8 +423,7 @@ const char* Class::GetDescriptor(std::string* storage) {
             descriptor = Primitive::Descriptor(klass->GetPrimitiveType());
         } else {
             DexFile& dex_file = klass->GetDexFile();
-            dex::TypeId type_id = dex_file.GetTypeId(klass->GetDexTypeIndex());
-            descriptor = dex_file.GetTypeDescriptor(type_id);
+            descriptor = dex_file.GetTypeDescriptor(klass->GetDexTypeIndex());
         }
         if (dim == 0x0) {
             return descriptor;
@@ -29,6 +29,8 @@
 #include "dex/dex_file.h"
 #include <string>
 #include <functional>
+#include <unordered_map>
+#include <unordered_set>
 
 struct Class_OffsetTable {
     uint32_t class_loader_;
@@ -211,6 +213,9 @@ public:
     inline uint32_t SizeOf() { return GetClassSize(); }
     inline uint32_t GetClassSize() { return class_size(); }
     std::string PrettyDescriptor();
+    // PrettyDescriptor interned by class pointer, valid until CleanDescriptorCache
+    const std::string& CachedDescriptor();
+    static void CleanDescriptorCache();
     const char *GetDescriptor(std::string* storage);
     String GetName();
     inline DexFile& GetDexFile() { return GetDexCache().GetDexFile(); }
@@ -236,6 +241,9 @@ public:
     uint32_t NumFields();
 
 private:
+    static std::unordered_map<uint64_t, const std::string*> kDescriptorCache;
+    static std::unordered_set<std::string> kDescriptors;
+
     // quick memoryref cache
     DEFINE_QUICK_CACHE(DexCache, dex_cache);
     DEFINE_QUICK_CACHE(IfTable, iftable);
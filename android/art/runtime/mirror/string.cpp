@@ -66,11 +66,13 @@ StringCompressionFlag String::GetCompressionFlagFromCount(int32_t count) {
 }
 
 uint8_t* String::GetValueCompressed() {
-    return value_compressed();
+    uint64_t offset = OFFSET(String, value_compressed_);
+    return reinterpret_cast<uint8_t *>(Real(offset, sizeof(uint8_t) * GetLength()) + offset);
 }
 
 uint16_t* String::GetValue() {
-    return value();
+    uint64_t offset = OFFSET(String, value_);
+    return reinterpret_cast<uint16_t *>(Real(offset, sizeof(uint16_t) * GetLength()) + offset);
 }
 
 std::string String::ToModifiedUtf8() {
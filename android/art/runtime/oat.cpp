@@ -48,7 +48,8 @@ int OatHeader::AnalysiOatVersion() {
 
     uint64_t point_size = CoreApi::GetPointSize();
     auto callback = [&](LoadBlock *block) -> bool {
-        ElfHeader* header = reinterpret_cast<ElfHeader*>(block->begin());
+        ElfHeader* header = reinterpret_cast<ElfHeader*>(
+                block->begin(LoadBlock::OPT_READ_ALL, block->vaddr(), sizeof(ElfHeader)));
         if (memcmp(header->ident, ELFMAG, 4)) {
             return false;
         }
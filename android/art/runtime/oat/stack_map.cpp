@@ -24,11 +24,14 @@
 #include "base/bit_memory_region.h"
 #include "android.h"
 #include <string>
+#include <algorithm>
 
 namespace art {
 
 uint32_t CodeInfo::kNumHeaders = 0;
 uint32_t CodeInfo::kNumBitTables = 8;
+std::unordered_map<uint64_t, CodeInfo> CodeInfo::kDecodeCache;
+std::unordered_map<uint64_t, QuickMethodFrameInfo> CodeInfo::kFrameInfoCache;
 
 uint32_t StackMap::kNumStackMaps = 6;
 uint32_t StackMap::kColNumKind = 0;
@@ -304,10 +307,16 @@ uint32_t CodeInfo::DecodeCodeSize(uint64_t code_info_data) {
 }
 
 QuickMethodFrameInfo CodeInfo::DecodeFrameInfo(uint64_t code_info_data) {
+    auto it = kFrameInfoCache.find(code_info_data);
+    if (it != kFrameInfoCache.end())
+        return it->second;
+
     CodeInfo code_info = DecodeHeaderOnly(code_info_data);
-    return QuickMethodFrameInfo(code_info.frame_size_in_bytes_,
-                                code_info.core_spill_mask_,
-                                code_info.fp_spill_mask_);
+    QuickMethodFrameInfo frame_info(code_info.frame_size_in_bytes_,
+                                    code_info.core_spill_mask_,
+                                    code_info.fp_spill_mask_);
+    kFrameInfoCache.emplace(code_info_data, frame_info);
+    return frame_info;
 }
 
 CodeInfo CodeInfo::DecodeHeaderOnly(uint64_t code_info_data) {
@@ -483,6 +492,20 @@ CodeInfo CodeInfo::Decode(uint64_t code_info_data) {
     return code_info;
 }
 
+CodeInfo& CodeInfo::DecodeCached(uint64_t code_info_data) {
+    auto it = kDecodeCache.find(code_info_data);
+    if (it != kDecodeCache.end())
+        return it->second;
+
+    CodeInfo code_info = Decode(code_info_data);
+    return kDecodeCache.emplace(code_info_data, code_info).first->second;
+}
+
+void CodeInfo::CleanCache() {
+    kDecodeCache.clear();
+    kFrameInfoCache.clear();
+}
+
 void CodeInfo::ExtendNumRegister(ArtMethod& method) {
     if (OatHeader::OatVersion() < 150) {
         art::dex::CodeItem item = method.GetCodeItem();
@@ -648,46 +671,40 @@ void CodeInfo::NativeStackMaps(std::vector<GeneralStackMap>& maps) {
     }
 }
 
-uint32_t CodeInfo::NativePc2DexPc(uint32_t native_pc) {
-    uint32_t dex_pc = 0x0;
-    if (OatHeader::OatVersion() >= 144) {
-        StackMap& map = GetStackMap();
-        if (!map.IsValid()) {
-            return 0;
-        }
+int32_t CodeInfo::NativePc2Row(uint32_t native_pc) {
+    if (!native_maps_ready_) {
+        native_maps_ready_ = true;
+        NativeStackMaps(native_maps_);
+        native_maps_sorted_ = std::is_sorted(native_maps_.begin(), native_maps_.end(),
+                [](const GeneralStackMap& a, const GeneralStackMap& b) { return a.native_pc < b.native_pc; });
+    }
 
-        for (int row = 0; row < map.NumRows(); row++) {
-            uint32_t packed_native_pc = map.Get(row, StackMap::kColNumPackedNativePc);
-            uint32_t current_native_pc = StackMap::UnpackNativePc(packed_native_pc);
-            dex_pc = map.Get(row, StackMap::kColNumDexPc);
-            if (current_native_pc > native_pc)
-                break;
-        }
-    } else if (OatHeader::OatVersion() >= 124) {
-        for (int row = 0; row < number_of_stack_maps_; row++) {
-            BitMemoryRegion bit_region = encoding_.GetStackMap().BitRegion(region_, row);
-            uint32_t current_native_pc = encoding_.GetStackMap().encoding.GetNativePcEncoding().Load(bit_region);
-            dex_pc = encoding_.GetStackMap().encoding.GetDexPcEncoding().Load(bit_region);
-            if (current_native_pc > native_pc)
-                break;
-        }
-    } else if (OatHeader::OatVersion() >= 79) {
-        if (region_.size() == 0)
-            return dex_pc;
+    return FindRow(native_maps_, native_maps_sorted_, native_pc);
+}
 
-        uint32_t stack_map_size = encoding_.StackMapsSizeInByte();
-        MemoryRegion stack_region = region_.Subregion(encoding_.StackMapsOffset(), encoding_.StackMapsSize());
+int32_t CodeInfo::FindRow(std::vector<GeneralStackMap>& maps, bool sorted, uint32_t native_pc) {
+    if (maps.empty())
+        return -1;
 
-        for (int row = 0; row < number_of_stack_maps_; row++) {
-            BitMemoryRegion bit_region = stack_region.Subregion(row * stack_map_size, stack_map_size);
-            uint32_t current_native_pc = encoding_.GetStackMap().encoding.GetNativePcEncoding().Load(bit_region);
-            dex_pc = encoding_.GetStackMap().encoding.GetDexPcEncoding().Load(bit_region);
-            if (current_native_pc > native_pc)
-                break;
-        }
-    } else if (OatHeader::OatVersion() >= 64) {
+    int32_t last = maps.size() - 1;
+    if (sorted) {
+        auto it = std::upper_bound(maps.begin(), maps.end(), native_pc,
+                [](uint32_t value, const GeneralStackMap& map) { return value < map.native_pc; });
+        return it != maps.end() ? it - maps.begin() : last;
+    }
+
+    for (int32_t row = 0; row < last; row++) {
+        if (maps[row].native_pc > native_pc)
+            return row;
     }
-    return dex_pc;
+    return last;
+}
+
+uint32_t CodeInfo::NativePc2DexPc(uint32_t native_pc) {
+    int32_t row = NativePc2Row(native_pc);
+    if (row < 0)
+        return 0x0;
+    return native_maps_[row].dex_pc;
 }
 
 void CodeInfo::NativePc2VRegs(uint32_t native_pc, std::map<uint32_t, DexRegisterInfo>& vreg_map) {
@@ -744,16 +761,10 @@ void CodeInfo::NativePc2VRegsV2(uint32_t native_pc, std::map<uint32_t, DexRegist
     StackMap& map = GetStackMap();
     if (!map.IsValid()) return;
 
-    uint32_t current_row = BitTable::kNoValue;
-    uint32_t dex_register_map_index = BitTable::kNoValue;
-    for (int row = 0; row < map.NumRows(); row++) {
-        uint32_t packed_native_pc = map.Get(row, StackMap::kColNumPackedNativePc);
-        uint32_t current_native_pc = StackMap::UnpackNativePc(packed_native_pc);
-        current_row = row;
-        dex_register_map_index = map.Get(row, StackMap::kColNumDexRegisterMapIndex);
-        if (current_native_pc > native_pc)
-            break;
-    }
+    int32_t current_row = NativePc2Row(native_pc);
+    if (current_row < 0) return;
+
+    uint32_t dex_register_map_index = map.Get(current_row, StackMap::kColNumDexRegisterMapIndex);
 
     if (dex_register_map_index == BitTable::kNoValue) return;
     DexRegisterMap& dex_map = GetDexRegisterMap();
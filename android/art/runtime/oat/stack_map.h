@@ -24,6 +24,8 @@
 #include "base/bit_table.h"
 #include "base/globals.h"
 #include <map>
+#include <unordered_map>
+#include <vector>
 
 namespace art {
 
@@ -478,6 +480,13 @@ public:
     static uint32_t DecodeCodeSize(uint64_t code_info_data);
     static QuickMethodFrameInfo DecodeFrameInfo(uint64_t code_info_data);
 
+    /*
+     * Decoded once per code info, the same hot methods are on the stack
+     * of many threads. Cleaned when the core changes.
+     */
+    static CodeInfo& DecodeCached(uint64_t code_info_data);
+    static void CleanCache();
+
     CodeInfo(uint64_t code_info_data);
 
     enum Flags {
@@ -514,6 +523,10 @@ public:
     uint32_t NativePc2DexPc(uint32_t native_pc);
     void NativePc2VRegs(uint32_t native_pc, std::map<uint32_t, DexRegisterInfo>& vregs);
     void NativeStackMaps(std::vector<GeneralStackMap>& maps);
+    // row of the first stack map after native_pc, the last row if none, -1 if empty.
+    int32_t NativePc2Row(uint32_t native_pc);
+    // binary search when maps are sorted by native_pc, else the linear scan.
+    static int32_t FindRow(std::vector<GeneralStackMap>& maps, bool sorted, uint32_t native_pc);
     void ExtendNumRegister(ArtMethod& method);
 
     void Dump(const char* prefix);
@@ -566,6 +579,15 @@ private:
     DexRegisterMask dex_register_mask_;
     DexRegisterMap dex_register_map_;
     DexRegisterInfo dex_register_info_;
+
+    // stack maps in row order, decoded on first native pc lookup.
+    bool native_maps_ready_ = false;
+    bool native_maps_sorted_ = false;
+    std::vector<GeneralStackMap> native_maps_;
+
+    static std::unordered_map<uint64_t, CodeInfo> kDecodeCache;
+    // header only frame info, unwinding does not decode the bit tables.
+    static std::unordered_map<uint64_t, QuickMethodFrameInfo> kFrameInfoCache;
 };
 
 } // namespace art
@@ -231,19 +231,20 @@ bool OatQuickMethodHeader::IsNterpMethodHeader() {
 }
 
 uint32_t OatQuickMethodHeader::NativePc2DexPc(uint32_t native_pc) {
-    CodeInfo code_info = CodeInfo::Decode(GetOptimizedCodeInfoPtr());
+    CodeInfo& code_info = CodeInfo::DecodeCached(GetOptimizedCodeInfoPtr());
     return code_info.NativePc2DexPc(native_pc);
 }
 
 void OatQuickMethodHeader::NativePc2VRegs(uint32_t native_pc,
             std::map<uint32_t, DexRegisterInfo>& vregs, art::ArtMethod& method) {
-    CodeInfo code_info = CodeInfo::Decode(GetOptimizedCodeInfoPtr());
+    // ExtendNumRegister is per method, keep the shared cached entry untouched.
+    CodeInfo code_info = CodeInfo::DecodeCached(GetOptimizedCodeInfoPtr());
     code_info.ExtendNumRegister(method);
     code_info.NativePc2VRegs(native_pc, vregs);
 }
 
 void OatQuickMethodHeader::NativeStackMaps(std::vector<GeneralStackMap>& maps) {
-    CodeInfo code_info = CodeInfo::Decode(GetOptimizedCodeInfoPtr());
+    CodeInfo& code_info = CodeInfo::DecodeCached(GetOptimizedCodeInfoPtr());
     code_info.NativeStackMaps(maps);
 }
 
@@ -451,7 +451,8 @@ void Runtime::AnalysisCalleeSaveMethods(uint64_t *callee_methods, uint32_t sizeo
         return;
 
     auto callback = [&](LoadBlock *block) -> bool {
-        if (memcmp(reinterpret_cast<void *>(block->begin()),
+        if (memcmp(reinterpret_cast<void *>(block->begin(LoadBlock::OPT_READ_ALL,
+                                                         block->vaddr(), sizeof(ImageHeader::kMagic))),
                    reinterpret_cast<void *>(ImageHeader::kMagic),
                    sizeof(ImageHeader::kMagic)))
             return false;
@@ -477,7 +478,8 @@ Runtime Runtime::AnalysisRuntime(uint64_t *callee_methods, uint32_t sizeof_calle
         if (!(block->flags() & Block::FLAG_W))
             return false;
 
-        if (!memcmp(reinterpret_cast<void *>(block->begin()),
+        if (!memcmp(reinterpret_cast<void *>(block->begin(LoadBlock::OPT_READ_ALL,
+                                                          block->vaddr(), sizeof(ImageHeader::kMagic))),
                    reinterpret_cast<void *>(ImageHeader::kMagic),
                    sizeof(ImageHeader::kMagic)))
             return false;
@@ -36,6 +36,12 @@ cxx::list& ThreadList::GetListCache() {
     return list_cache;
 }
 
+void ThreadList::SetListCache(uint64_t addr) {
+    list_cache = addr;
+    list_cache.copyRef(this);
+    list_second_cache.clear();
+}
+
 std::list<std::unique_ptr<Thread>>& ThreadList::GetList() {
     if (!list_second_cache.size()) {
         try {
@@ -51,6 +51,7 @@ public:
     inline uint64_t list() { return Ptr() + OFFSET(ThreadList, list_); }
 
     cxx::list& GetListCache();
+    void SetListCache(uint64_t addr);
     std::list<std::unique_ptr<Thread>>& GetList();
     bool Contains(int tid);
     Thread* FindThreadByTid(int tid);
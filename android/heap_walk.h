@@ -0,0 +1,99 @@
+/*
+ * Copyright (C) 2024-present, Guanyou.Chen. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_HEAP_WALK_H_
+#define ANDROID_HEAP_WALK_H_
+
+#include "logger/log.h"
+#include "android.h"
+#include "runtime/gc/heap.h"
+#include "runtime/gc/space/image_space.h"
+#include "runtime/gc/space/zygote_space.h"
+#include "runtime/gc/space/region_space.h"
+#include "common/exception.h"
+#include <functional>
+#include <type_traits>
+
+template <typename Visitor>
+inline void Android::ForEachObject(Visitor&& visitor, int flag, bool check) {
+    art::Runtime& runtime = art::Runtime::Current();
+    art::gc::Heap& heap = runtime.GetHeap();
+
+    // std::function visitors (ForeachObjects) go to Space::Walk as is.
+    using ObjectFn = std::function<bool (art::mirror::Object& object)>;
+    ObjectFn wrapper;
+    const ObjectFn* fnp;
+    if constexpr (std::is_same<std::decay_t<Visitor>, ObjectFn>::value) {
+        fnp = &visitor;
+    } else {
+        wrapper = [&](art::mirror::Object& object) -> bool {
+            return visitor(object);
+        };
+        fnp = &wrapper;
+    }
+    const ObjectFn& fn = *fnp;
+
+    auto walkfn = [&](art::gc::space::Space* space, auto&& walk) {
+        LOGD("Walk [%s] ...\n", space->GetName());
+        try {
+            if (space->IsVaildSpace()) {
+                walk();
+            } else {
+                LOGE("%s invalid space.\n", space->GetName());
+            }
+        } catch (InvalidAddressException& e) {
+            LOGW("Walk [%s] was interrupted!\n", space->GetName());
+        }
+    };
+
+    for (const auto& space : heap.GetContinuousSpaces()) {
+        art::gc::space::ContinuousSpace* sp = space.get();
+        auto walk = [&]() { sp->Walk(fn, check); };
+        if (sp->IsImageSpace()) {
+            art::gc::space::ImageSpace* image_space = static_cast<art::gc::space::ImageSpace*>(sp);
+            if (flag & EACH_IMAGE_OBJECTS) walkfn(sp, [&]() { image_space->WalkInternal(visitor, check); });
+        } else if (sp->IsZygoteSpace()) {
+            art::gc::space::ZygoteSpace* zygote_space = static_cast<art::gc::space::ZygoteSpace*>(sp);
+            if (flag & EACH_ZYGOTE_OBJECTS) walkfn(sp, [&]() { zygote_space->WalkInternal(visitor, check); });
+        } else if (sp->IsRegionSpace()) {
+            art::gc::space::RegionSpace* region_space = static_cast<art::gc::space::RegionSpace*>(sp);
+            if (flag & EACH_APP_OBJECTS) walkfn(sp, [&]() { region_space->WalkInternal(visitor, false, check); });
+        } else if (sp->IsBumpPointerSpace()) {
+            if (flag & EACH_APP_OBJECTS) walkfn(sp, walk);
+        } else if (sp->IsMallocSpace()) {
+            if (sp->IsRosAllocSpace()) {
+                if (flag & EACH_APP_OBJECTS) walkfn(sp, walk);
+            } else if (sp->IsDlMallocSpace()) {
+                if (flag & EACH_APP_OBJECTS) walkfn(sp, walk);
+            }
+        } else if (sp->IsFakeSpace()) {
+            if (flag & EACH_FAKE_OBJECTS) walkfn(sp, walk);
+        } else {
+            if (sp->GetType() != art::gc::space::kSpaceTypeInvalidSpace) {
+                walkfn(sp, walk);
+            } else {
+                LOGE("please run sysroot libart.so and run env art -c, %s invalid space.\n", sp->GetName());
+            }
+        }
+    }
+
+    for (const auto& space : heap.GetDiscontinuousSpaces()) {
+        art::gc::space::DiscontinuousSpace* sp = space.get();
+        if (flag & EACH_APP_OBJECTS) walkfn(sp, [&]() { sp->Walk(fn, check); });
+    }
+}
+
+#endif // ANDROID_HEAP_WALK_H_
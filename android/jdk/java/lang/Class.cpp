@@ -16,41 +16,19 @@
 
 #include "java/lang/Class.h"
 #include "runtime/mirror/string.h"
-#include "android.h"
+#include "runtime/class_index.h"
 
 namespace java {
 namespace lang {
 
-std::vector<uint32_t> Class::kClassesCache;
-
 std::string Class::getSimpleName() {
     art::mirror::Class clazz = thiz();
-    return clazz.PrettyDescriptor();
+    return clazz.CachedDescriptor();
 }
 
 Class Class::forName(const char* className) {
-    for (const auto& cache : kClassesCache) {
-        Class clazz = cache;
-        if (clazz.getSimpleName() == className) {
-            return clazz;
-        }
-    }
-
-    Class thiz_clazz = 0x0;
-    auto callback = [&](art::mirror::Object& object) -> bool {
-        if (!object.IsClass())
-            return false;
-
-        Class clazz = object;
-        if (clazz.getSimpleName() == className) {
-            thiz_clazz = clazz;
-            kClassesCache.push_back(thiz_clazz.Ptr());
-            return true;
-        }
-        return false;
-    };
-    Android::ForeachObjects(callback);
-    return thiz_clazz;
+    art::mirror::Class clazz = art::ClassIndex::Find(className);
+    return clazz.Ptr();
 }
 
 } // namespace lang
@@ -19,7 +19,6 @@
 
 #include "java/lang/Object.h"
 #include <string>
-#include <vector>
 
 namespace java {
 namespace lang {
@@ -32,8 +31,6 @@ public:
 
     std::string getSimpleName();
     static Class forName(const char* className);
-private:
-    static std::vector<uint32_t> kClassesCache;
 };
 
 } // namespace lang
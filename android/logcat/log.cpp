@@ -68,6 +68,7 @@ SerializedLogBuffer Logcat::AnalysisSerializedLogBuffer() {
             return false;
 
         SerializedLogBuffer buffer(block->vaddr(), block);
+        CoreApi::PrefetchScope prefetch(block->vaddr(), block->size());
         do {
             api::MemoryRef vtbl = buffer.valueOf();
             if (vtbl.IsValid()) {
@@ -16,6 +16,7 @@
 
 #include "api/core.h"
 #include "base/utils.h"
+#include "base/time_profile.h"
 #include "common/exception.h"
 #include "properties/prop_area.h"
 #include "properties/property.h"
@@ -33,6 +34,7 @@ const char* android::Property::Get(const char *name) {
 }
 
 const char* android::Property::Get(const char *name, const char* def) {
+    TimeProfile::Scope scope("android: property");
     android::PropInfo result = 0x0;
     auto callback = [name, def, &result](LoadBlock *block) -> bool {
         if (block->realSize() >= android::PropArea::PA_SIZE
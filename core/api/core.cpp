@@ -25,8 +25,10 @@
 #include "common/bit.h"
 #include "common/elf.h"
 #include "common/exception.h"
+#include "common/xz/seekable.h"
 #include "base/utils.h"
 #include "base/macros.h"
+#include "base/time_profile.h"
 #include <linux/elf.h>
 #include <cstring>
 #include <iomanip>
@@ -50,7 +52,8 @@ bool CoreApi::Load(const char* corefile, std::function<void ()> callback) {
 }
 
 bool CoreApi::Load(const char* corefile, bool remote, std::function<void ()> callback) {
-    std::unique_ptr<MemoryMap> map(MemoryMap::MmapFile(corefile));
+    std::unique_ptr<MemoryMap> map(xz::Seekable::IsSeekable(corefile) ?
+                                   xz::Seekable::MmapFile(corefile) : MemoryMap::MmapFile(corefile));
     return Load(map, remote, callback);
 }
 
@@ -93,7 +96,14 @@ bool CoreApi::Load(std::unique_ptr<MemoryMap>& map, bool remote, std::function<v
         if (INSTANCE) {
             CoreApi::Init();
             INSTANCE->mRemote = remote;
-            if (INSTANCE->load()) {
+            // startup profile follows the last loaded core
+            TimeProfile::Clean();
+            bool loaded;
+            {
+                TimeProfile::Scope scope("core: load");
+                loaded = INSTANCE->load();
+            }
+            if (loaded) {
                 auto bind_file = [&](File* file) -> bool {
                     LoadBlock* block = INSTANCE->findLoadBlock(file->begin(), false);
                     if (block && block->vaddr() == file->begin())
@@ -251,6 +261,9 @@ uint64_t CoreApi::newLoadBlock(uint64_t vaddr, uint64_t old_size, int flags) {
 }
 
 void CoreApi::addLoadBlock(std::shared_ptr<LoadBlock>& block) {
+    // oraddr() of a lazily decoded core is filled on first read.
+    if (block->oraddr() && mCore->Epoch())
+        block->setSource(mCore.get());
     mLoad.push_back(block);
     if (!QUICK_LOAD_ENABLED || block->flags())
         mQuickLoad.push_back(block);
@@ -268,7 +281,11 @@ void CoreApi::removeAllBindMap() {
 }
 
 uint64_t CoreApi::GetReal(uint64_t vaddr, int opt) {
-    return INSTANCE->v2r(vaddr, opt);
+    return INSTANCE->v2r(vaddr, LoadBlock::kFillWindow, opt);
+}
+
+uint64_t CoreApi::GetReal(uint64_t vaddr, uint64_t size, int opt) {
+    return INSTANCE->v2r(vaddr, size, opt);
 }
 
 uint64_t CoreApi::GetVirtual(uint64_t raddr) {
@@ -438,7 +455,7 @@ void CoreApi::Write(uint64_t vaddr, void *buf, uint64_t size) {
 bool CoreApi::Read(uint64_t vaddr, uint64_t size, uint8_t* buf, int opt) {
     LoadBlock* block = FindLoadBlock(vaddr);
 
-    uint64_t raddr = GetReal(vaddr, opt);
+    uint64_t raddr = GetReal(vaddr, size, opt);
     if (!raddr)
         return false;
 
@@ -451,6 +468,28 @@ bool CoreApi::Read(uint64_t vaddr, uint64_t size, uint8_t* buf, int opt) {
     return true;
 }
 
+void CoreApi::Prefetch(uint64_t vaddr, uint64_t size) {
+    uint64_t end = vaddr + size;
+    while (vaddr < end) {
+        LoadBlock* block = FindLoadBlock(vaddr, false);
+        if (!block)
+            break;
+        block->Prefetch(vaddr, end - vaddr);
+        vaddr = block->vaddr() + block->memsz();
+    }
+}
+
+void CoreApi::Release(uint64_t vaddr, uint64_t size) {
+    uint64_t end = vaddr + size;
+    while (vaddr < end) {
+        LoadBlock* block = FindLoadBlock(vaddr, false);
+        if (!block)
+            break;
+        block->Release(vaddr, end - vaddr);
+        vaddr = block->vaddr() + block->memsz();
+    }
+}
+
 void CoreApi::ForeachLoadBlock(std::function<bool (LoadBlock *)> callback, bool check, bool quick) {
     INSTANCE->foreachLoadBlock(callback, check, quick);
 }
@@ -478,14 +517,33 @@ uint64_t CoreApi::DlSym(const char* path, const char* symbol) {
     return 0x0;
 }
 
+/*
+ * The first NT_PRSTATUS is the dumping thread, not the process. A core
+ * without NT_PRPSINFO (e.g. opencore) falls back to the lowest tid,
+ * the main thread was created before any of its threads.
+ */
+int CoreApi::GetPid() {
+    if (INSTANCE->mPid)
+        return INSTANCE->mPid;
+
+    int pid = 0;
+    auto callback = [&](ThreadApi *api) -> bool {
+        if (!pid || api->pid() < pid)
+            pid = api->pid();
+        return false;
+    };
+    INSTANCE->foreachThread(callback);
+    return pid;
+}
+
 void CoreApi::ForeachThread(std::function<bool (ThreadApi *)> callback) {
     INSTANCE->foreachThread(callback);
 }
 
-uint64_t CoreApi::v2r(uint64_t vaddr, int opt) {
+uint64_t CoreApi::v2r(uint64_t vaddr, uint64_t size, int opt) {
     LoadBlock* block = findLoadBlock(vaddr, true);
     if (block && block->isValid()) {
-        uint64_t raddr = block->begin(opt);
+        uint64_t raddr = block->begin(opt, vaddr, size);
         if (raddr) {
             return raddr + ((vaddr & block->VabitsMask()) - block->vaddr());
         } else {
@@ -498,7 +556,7 @@ uint64_t CoreApi::v2r(uint64_t vaddr, int opt) {
 uint64_t CoreApi::r2v(uint64_t raddr) {
     for (const auto& block : mQuickLoad) {
         if (block->realContains(raddr))
-            return block->vaddr() + (raddr - block->begin());
+            return block->vaddr() + (raddr - block->begin(LoadBlock::OPT_READ_ALL, block->vaddr(), 0));
     }
     throw InvalidAddressException(raddr);
 }
@@ -95,7 +95,14 @@ public:
     static bool Load(const char* corefile, bool remote, std::function<void ()> callback);
     static bool Load(std::unique_ptr<MemoryMap>& map, bool remote, std::function<void ()> callback);
     static void UnLoad() { INSTANCE.reset(); }
+    // park and restore a loaded core, keep several cores in one process
+    static std::unique_ptr<CoreApi> Detach() { return std::move(INSTANCE); }
+    static void Attach(std::unique_ptr<CoreApi>& core) {
+        INSTANCE = std::move(core);
+        if (INSTANCE) Init();
+    }
     static uint64_t GetBegin() { return INSTANCE->begin(); }
+    static uint64_t GetSize() { return INSTANCE->size(); }
     static uint64_t GetDebugPtr() { return INSTANCE->r_debug_ptr().Ptr(); }
     static const char* GetName();
     static const char* GetMachineName();
@@ -119,10 +126,14 @@ public:
         return GetReal(vaddr, OPT_READ_ALL);
     }
     static uint64_t GetReal(uint64_t vaddr, int opt);
+    // [vaddr, vaddr + size) is readable from the returned address.
+    static uint64_t GetReal(uint64_t vaddr, uint64_t size, int opt);
     static uint64_t GetVirtual(uint64_t raddr);
     static bool IsVirtualValid(uint64_t vaddr);
     static uint64_t FindAuxv(uint64_t type);
     static ThreadApi* FindThread(int tid);
+    // process pid from NT_PRPSINFO, else the lowest thread id.
+    static int GetPid();
     static void Init();
     static void Dump();
     static void CleanCache();
@@ -141,6 +152,29 @@ public:
         return Read(vaddr, size, buf, OPT_READ_ALL);
     }
     static bool Read(uint64_t vaddr, uint64_t size, uint8_t* buf, int opt);
+    static void Advise(uint64_t raddr, uint64_t size, int advice) {
+        INSTANCE->mCore->Advise(raddr, size, advice);
+    }
+    // make [raddr, raddr + size) of the core file readable, see xz::SeekableMap.
+    static bool Fill(uint64_t raddr, uint64_t size) {
+        return INSTANCE->mCore->Fill(raddr, size);
+    }
+
+    // access pattern hints for [vaddr, vaddr + size) across load blocks
+    static void Prefetch(uint64_t vaddr, uint64_t size);
+    static void Release(uint64_t vaddr, uint64_t size);
+
+    // Prefetch the range and Release it at scope exit, also when a read throws.
+    class PrefetchScope {
+    public:
+        PrefetchScope(uint64_t vaddr, uint64_t size) : vaddr_(vaddr), size_(size) {
+            Prefetch(vaddr_, size_);
+        }
+        ~PrefetchScope() { Release(vaddr_, size_); }
+    private:
+        uint64_t vaddr_;
+        uint64_t size_;
+    };
 
     // default non-quick search load
     static void ForeachLoadBlock(std::function<bool (LoadBlock *)> callback) {
@@ -226,7 +260,7 @@ public:
     }
     void removeAllLoadBlock();
     void removeAllBindMap();
-    inline uint64_t v2r(uint64_t vaddr, int opt);
+    inline uint64_t v2r(uint64_t vaddr, uint64_t size, int opt);
     inline uint64_t r2v(uint64_t raddr);
     inline bool virtualValid(uint64_t vaddr);
     void addNoteBlock(std::unique_ptr<NoteBlock>& block);
@@ -249,6 +283,7 @@ public:
         return mNote;
     }
     bool isRemote() { return mRemote; }
+    inline void setPid(int pid) { mPid = pid; }
     static bool QUICK_LOAD_ENABLED;
 protected:
     uint64_t pointer_mask;
@@ -275,6 +310,7 @@ private:
     std::vector<std::unique_ptr<LinkMap>> mLinkMap;
     std::function<void (LinkMap *)> mSysRootCallback;
     bool mRemote = false;
+    int mPid = 0;
 };
 
 #endif // CORE_API_CORE_H_
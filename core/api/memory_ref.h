@@ -69,6 +69,7 @@ class MemoryRef {
 public:
     MemoryRef(uint64_t v) : vaddr(v), block(0) {}
     MemoryRef(const MemoryRef& ref) : vaddr(ref.vaddr), block(ref.block) {}
+    MemoryRef& operator=(const MemoryRef& ref) = default;
     MemoryRef(uint64_t v, LoadBlock* b) : vaddr(v), block(0) { checkCopyBlock(b); }
     MemoryRef(uint64_t v, MemoryRef& ref) : vaddr(v), block(0) { copyRef(ref); }
     MemoryRef(uint64_t v, MemoryRef* ref) : vaddr(v), block(0) { copyRef(ref); }
@@ -88,13 +89,16 @@ public:
 
     inline uint64_t Ptr() { return vaddr; }
     inline uint64_t Ptr() const { return vaddr; }
-    inline uint64_t Real() {
+    inline uint64_t Real() { return Real(0, LoadBlock::kFillWindow); }
+    // real address of vaddr, [vaddr + offset, vaddr + offset + size) is readable.
+    inline uint64_t Real(uint64_t offset, uint64_t size) {
         Prepare(true);
 
         if (!block || !block->isValid())
             throw InvalidAddressException(vaddr);
 
-        return block->begin() + ((vaddr & block->VabitsMask()) - block->vaddr());
+        uint64_t clocaddr = vaddr & block->VabitsMask();
+        return block->begin(LoadBlock::OPT_READ_ALL, clocaddr + offset, size) + (clocaddr - block->vaddr());
     }
     inline LoadBlock* Block() { return block; }
     inline uint64_t PointMask() { return block->PointMask(); }
@@ -123,23 +127,23 @@ public:
     }
     inline uint64_t valueOf() { return valueOf(0); }
     inline uint64_t valueOf(uint64_t offset) {
-        return *reinterpret_cast<uint64_t *>(Real() + offset) & PointMask();
+        return *reinterpret_cast<uint64_t *>(Real(offset, sizeof(uint64_t)) + offset) & PointMask();
     }
     inline uint64_t value64Of() { return value64Of(0); }
     inline uint64_t value64Of(uint64_t offset) {
-        return *reinterpret_cast<uint64_t *>(Real() + offset);
+        return *reinterpret_cast<uint64_t *>(Real(offset, sizeof(uint64_t)) + offset);
     }
     inline uint32_t value32Of() { return value32Of(0); }
     inline uint32_t value32Of(uint64_t offset) {
-        return *reinterpret_cast<uint32_t *>(Real() + offset);
+        return *reinterpret_cast<uint32_t *>(Real(offset, sizeof(uint32_t)) + offset);
     }
     inline uint32_t value16Of() { return value16Of(0); }
     inline uint32_t value16Of(uint64_t offset) {
-        return *reinterpret_cast<uint16_t *>(Real() + offset);
+        return *reinterpret_cast<uint16_t *>(Real(offset, sizeof(uint16_t)) + offset);
     }
     inline uint32_t value8Of() { return value8Of(0); }
     inline uint32_t value8Of(uint64_t offset) {
-        return *reinterpret_cast<uint8_t *>(Real() + offset);
+        return *reinterpret_cast<uint8_t *>(Real(offset, sizeof(uint8_t)) + offset);
     }
 private:
     uint64_t vaddr;
@@ -15,6 +15,7 @@
  */
 
 #include "logger/log.h"
+#include "base/time_profile.h"
 #include "api/core.h"
 #include "lp64/core.h"
 #include "lp32/core.h"
@@ -155,7 +156,8 @@ SymbolEntry LinkMap::DlRegionSymEntry(uint64_t addr) {
 void LinkMap::ReadSymbols() {
     LoadBlock* load = block();
     if (load && load->isMmapBlock()) {
-        ElfHeader* header = reinterpret_cast<ElfHeader*>(load->begin());
+        ElfHeader* header = reinterpret_cast<ElfHeader*>(
+                load->begin(LoadBlock::OPT_READ_ALL, load->vaddr(), sizeof(ElfHeader)));
         if (!header->CheckLibrary(load->name().c_str()))
             return;
 
@@ -171,6 +173,7 @@ void LinkMap::ReadSymbols() {
 }
 
 void LinkMap::ReadDynsyms() {
+    TimeProfile::Scope scope("core: dynsyms");
     dynsyms.clear();
     try {
         api::Elf::ReadSymbols(this);
@@ -18,6 +18,7 @@
 #include "api/core.h"
 #include "common/bit.h"
 #include "common/load_block.h"
+#include "common/exception.h"
 #include "base/utils.h"
 #include <unistd.h>
 
@@ -90,6 +91,19 @@ void LoadBlock::removeOverlay() {
     }
 }
 
+void LoadBlock::setSource(MemoryMap* map) {
+    mSource = map;
+    mFilled.reset(new std::atomic<uint64_t>[RoundUp(realSize(), kFillWindow) / kFillWindow]());
+}
+
+void LoadBlock::fill(uint64_t window, uint64_t epoch) {
+    uint64_t offset = window * kFillWindow;
+    // a broken block is left unstamped, never read as zero.
+    if (!mSource->Fill(oraddr() + offset, std::min(kFillWindow, realSize() - offset)))
+        throw InvalidAddressException(vaddr() + offset);
+    mFilled[window].store(epoch, std::memory_order_release);
+}
+
 bool LoadBlock::CheckCanMmap(uint64_t header) {
     /** fake load */
     if (isFake())
@@ -117,6 +131,22 @@ bool LoadBlock::CheckCanMmap(uint64_t header) {
     return true;
 }
 
+void LoadBlock::Advise(uint64_t addr, uint64_t size, int advice) {
+    uint64_t clocaddr = addr & mVabitsMask;
+    if (!isValid() || !virtualContains(clocaddr))
+        return;
+
+    uint64_t offset = clocaddr - vaddr();
+    size = std::min(size, this->size() - offset);
+    if (mOverlay) {
+        mOverlay->Advise(mOverlay->data() + offset, size, advice);
+    } else if (mMmap) {
+        mMmap->Advise(mMmap->data() + offset, size, advice);
+    } else if (oraddr()) {
+        CoreApi::Advise(oraddr() + offset, size, advice);
+    }
+}
+
 uint32_t LoadBlock::GetCRC32(int opt) {
     if (mOverlay && (opt & OPT_READ_OVERLAY)) {
         return mOverlay->GetCRC32();
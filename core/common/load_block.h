@@ -24,22 +24,44 @@
 #include "base/utils.h"
 #include <string>
 #include <memory>
+#include <atomic>
+#include <algorithm>
 #include <unordered_set>
 
 class LinkMap;
 
 class LoadBlock : public Block {
 public:
+    // a pointer from begin(opt, addr) is readable for at least this many bytes.
+    static constexpr uint64_t kFillWindow = 1024 * 1024;
+
     inline uint64_t begin() { return begin(OPT_READ_ALL); }
     inline uint64_t begin(int opt) {
         if (UNLIKELY(mOverlay && (opt & OPT_READ_OVERLAY)))
             return mOverlay->data();
         if (UNLIKELY(mMmap && (opt & OPT_READ_MMAP)))
             return mMmap->data();
-        if (LIKELY(oraddr() && (opt & OPT_READ_OR)))
+        if (LIKELY(oraddr() && (opt & OPT_READ_OR))) {
+            if (UNLIKELY(mSource != nullptr))
+                prepare(0, realSize());
+            return oraddr();
+        }
+        return 0x0;
+    }
+    // same as begin(opt), a lazily decoded core only fills [addr, addr + size).
+    inline uint64_t begin(int opt, uint64_t addr, uint64_t size) {
+        if (UNLIKELY(mOverlay && (opt & OPT_READ_OVERLAY)))
+            return mOverlay->data();
+        if (UNLIKELY(mMmap && (opt & OPT_READ_MMAP)))
+            return mMmap->data();
+        if (LIKELY(oraddr() && (opt & OPT_READ_OR))) {
+            if (UNLIKELY(mSource != nullptr))
+                prepare((addr & mVabitsMask) - vaddr(), size);
             return oraddr();
+        }
         return 0x0;
     }
+    inline uint64_t begin(int opt, uint64_t addr) { return begin(opt, addr, kFillWindow); }
     inline uint64_t size() { return size(OPT_READ_ALL); }
     inline uint64_t size(int opt) {
         if (UNLIKELY(mOverlay && (opt & OPT_READ_OVERLAY)))
@@ -110,6 +132,7 @@ public:
         mPointMask = 0x0;
         mCRC32 = 0x0;
         mLinkMap = nullptr;
+        mSource = nullptr;
     }
 
     void setMmapFile(const char* file, uint64_t offset);
@@ -131,8 +154,19 @@ public:
     inline uint64_t PointMask() { return mPointMask; }
     inline uint64_t GetMmapOffset() { return mMmap->offset(); }
     inline void setMmapMemoryMap(std::unique_ptr<MemoryMap>& map) { mMmap = std::move(map); }
+    void setSource(MemoryMap* map);
     inline std::unordered_set<SymbolEntry, SymbolEntry::Hash>& GetSymbols() { return mSymbols; }
     bool CheckCanMmap(uint64_t header);
+    void Advise(uint64_t addr, uint64_t size, int advice);
+    inline void Prefetch() { Prefetch(vaddr(), size()); }
+    inline void Prefetch(uint64_t addr, uint64_t size) {
+        Advise(addr, size, MemoryMap::ADVICE_SEQUENTIAL);
+        Advise(addr, size, MemoryMap::ADVICE_WILLNEED);
+    }
+    inline void Release() { Release(vaddr(), size()); }
+    inline void Release(uint64_t addr, uint64_t size) {
+        Advise(addr, size, MemoryMap::ADVICE_DONTNEED);
+    }
     uint32_t GetCRC32(int opt);
     void bind(LinkMap* map) { mLinkMap = map; }
     void setFile(std::string& name, uint64_t off) {
@@ -146,6 +180,18 @@ public:
         mMmap.reset();
     }
 private:
+    inline void prepare(uint64_t offset, uint64_t size) {
+        if (offset >= realSize() || !size)
+            return;
+        uint64_t epoch = mSource->Epoch();
+        uint64_t last = (std::min(offset + size, realSize()) - 1) / kFillWindow;
+        for (uint64_t window = offset / kFillWindow; window <= last; ++window) {
+            if (mFilled[window].load(std::memory_order_acquire) != epoch)
+                fill(window, epoch);
+        }
+    }
+    void fill(uint64_t window, uint64_t epoch);
+
     uint64_t mVabitsMask;
     uint64_t mPointMask;
     uint32_t mCRC32;
@@ -153,6 +199,10 @@ private:
     uint64_t mPageOffset;
     LinkMap* mLinkMap;
     std::unique_ptr<MemoryMap> mMmap;
+    // lazily decoded core backing oraddr(), see xz::SeekableMap.
+    MemoryMap* mSource;
+    // source epoch each kFillWindow of the block was last filled in.
+    std::unique_ptr<std::atomic<uint64_t>[]> mFilled;
     std::unordered_set<SymbolEntry, SymbolEntry::Hash> mSymbols;
 };
 
@@ -0,0 +1,602 @@
+/*
+ * Copyright (C) 2024-present, Guanyou.Chen. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "logger/log.h"
+#include "common/xz/seekable.h"
+#include "common/xz/codec.h"
+#include "common/xz/lzma.h"
+#include "common/bit.h"
+#include <sys/mman.h>
+#include <unistd.h>
+#include <string.h>
+#include <stdio.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <linux/elf.h>
+#include <stdlib.h>
+#include <string>
+#include <algorithm>
+#if defined(__LZMA__)
+#include "api/lzma.h"
+#endif // __LZMA__
+
+namespace xz {
+
+uint64_t Seekable::kCacheLimit = Seekable::kDefaultCacheSize;
+std::vector<SeekableMap*> Seekable::kMaps;
+
+bool Seekable::IsSeekable(const char* file) {
+    bool ret = false;
+    FILE* fp = fopen(file, "rb");
+    if (fp) {
+        uint8_t magic[sizeof(LZMA::kMagic)];
+        if (fread(magic, sizeof(magic), 1, fp) == 1)
+            ret = Codec::IsLZMA(magic);
+        fclose(fp);
+    }
+    return ret;
+}
+
+#if defined(__LZMA__)
+/*
+ * Walk the streams backwards from the end of file, every stream footer
+ * gives the size of its index, and the index gives the size of the
+ * stream, then concatenate them like xz --list does.
+ */
+static lzma_index* DecodeIndex(const uint8_t* data, uint64_t size) {
+    lzma_index* combined = nullptr;
+    uint64_t pos = size;
+    bool broken = false;
+    while (pos > 0) {
+        uint64_t padding = 0;
+        while (pos >= 4 && !*reinterpret_cast<const uint32_t *>(data + pos - 4)) {
+            pos -= 4;
+            padding += 4;
+        }
+
+        lzma_stream_flags footer;
+        if (pos < 2 * LZMA_STREAM_HEADER_SIZE
+                || lzma_stream_footer_decode(&footer, data + pos - LZMA_STREAM_HEADER_SIZE) != LZMA_OK
+                || pos < 2 * LZMA_STREAM_HEADER_SIZE + footer.backward_size) {
+            broken = true;
+            break;
+        }
+
+        lzma_index* index = nullptr;
+        uint64_t memlimit = UINT64_MAX;
+        size_t in_pos = 0;
+        uint64_t index_pos = pos - LZMA_STREAM_HEADER_SIZE - footer.backward_size;
+        if (lzma_index_buffer_decode(&index, &memlimit, NULL, data + index_pos,
+                                     &in_pos, footer.backward_size) != LZMA_OK) {
+            broken = true;
+            break;
+        }
+
+        lzma_stream_flags header;
+        uint64_t stream_size = lzma_index_stream_size(index);
+        if (stream_size > pos
+                || lzma_stream_header_decode(&header, data + pos - stream_size) != LZMA_OK
+                || lzma_stream_flags_compare(&header, &footer) != LZMA_OK
+                || lzma_index_stream_flags(index, &footer) != LZMA_OK
+                || lzma_index_stream_padding(index, padding) != LZMA_OK
+                || (combined && lzma_index_cat(index, combined, NULL) != LZMA_OK)) {
+            lzma_index_end(index, NULL);
+            broken = true;
+            break;
+        }
+        combined = index;
+        pos -= stream_size;
+    }
+
+    if (broken && combined) {
+        lzma_index_end(combined, NULL);
+        combined = nullptr;
+    }
+    return combined;
+}
+#endif // __LZMA__
+
+/*
+ * LoadBlock contents are filled through LoadBlock::begin(), but the
+ * ELF header, program headers and notes are read in place while the
+ * core loads, so they are decoded up front and never trimmed.
+ */
+template<typename Ehdr, typename Phdr>
+static bool PinHeaders(SeekableMap* map) {
+    if (!map->Pin(map->data(), sizeof(Ehdr)))
+        return false;
+
+    Ehdr* ehdr = reinterpret_cast<Ehdr *>(map->data());
+    if (ehdr->e_phoff + ehdr->e_phnum * sizeof(Phdr) > map->size())
+        return false;
+
+    if (!map->Pin(map->data() + ehdr->e_phoff, ehdr->e_phnum * sizeof(Phdr)))
+        return false;
+
+    Phdr* phdr = reinterpret_cast<Phdr *>(map->data() + ehdr->e_phoff);
+    for (int num = 0; num < ehdr->e_phnum; ++num) {
+        if (phdr[num].p_type == PT_NOTE
+                && !map->Pin(map->data() + phdr[num].p_offset, phdr[num].p_filesz))
+            return false;
+    }
+    return true;
+}
+
+/*
+ * The decoded core is as large as the raw core, so it is backed by an
+ * already unlinked file in TMPDIR (or beside the core) and the kernel
+ * writes paged out blocks there instead of to swap. The space is
+ * reserved up front, a full disk must fail here and not as a SIGBUS on
+ * a later write through the mapping.
+ */
+static bool ReserveBacking(int fd, uint64_t size) {
+#if defined(__MACOS__)
+    fstore_t store = {F_ALLOCATEALL, F_PEOFPOSMODE, 0, static_cast<off_t>(size), 0};
+    if (fcntl(fd, F_PREALLOCATE, &store) == -1)
+        return false;
+    return !ftruncate(fd, size);
+#else
+    return !posix_fallocate(fd, 0, size);
+#endif
+}
+
+static int CreateBacking(const char* file, uint64_t size) {
+    std::vector<std::string> dirs;
+    const char* tmpdir = getenv("TMPDIR");
+    if (tmpdir && *tmpdir)
+        dirs.push_back(tmpdir);
+    std::string path = file;
+    std::string::size_type pos = path.rfind('/');
+    dirs.push_back(pos == std::string::npos ? "." : path.substr(0, pos));
+
+    for (const auto& dir : dirs) {
+        std::string name = dir + "/.core-parser-xz-XXXXXX";
+        int fd = mkstemp(&name[0]);
+        if (fd < 0)
+            continue;
+        unlink(name.c_str());
+        if (ReserveBacking(fd, size))
+            return fd;
+        LOGW("Can't reserve 0x%" PRIx64 " bytes in %s\n", size, dir.c_str());
+        close(fd);
+    }
+    return -1;
+}
+
+MemoryMap* Seekable::MmapFile(const char* file) {
+    if (!Codec::HasLZMASupport()) {
+        LOGE("Not support LZMA, can't load %s\n", file);
+        return nullptr;
+    }
+
+#if defined(__LZMA__)
+    std::unique_ptr<MemoryMap> map(MemoryMap::MmapFile(file));
+    if (!map)
+        return nullptr;
+
+    lzma_index* index = DecodeIndex(reinterpret_cast<uint8_t *>(map->data()), map->size());
+    if (!index) {
+        LOGE("Broken xz index %s\n", file);
+        return nullptr;
+    }
+
+    uint64_t raw_size = lzma_index_uncompressed_size(index);
+    uint64_t blocks = lzma_index_block_count(index);
+    if (!raw_size || !blocks) {
+        lzma_index_end(index, NULL);
+        return nullptr;
+    }
+
+    uint64_t page_size = sysconf(_SC_PAGE_SIZE);
+    void* mem = MAP_FAILED;
+    int fd = CreateBacking(file, RoundUp(raw_size, page_size));
+    if (fd >= 0) {
+        mem = mmap(NULL, RoundUp(raw_size, page_size), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        close(fd);
+    }
+    bool spill = mem != MAP_FAILED;
+    if (!spill) {
+        LOGW("No backing file for %s, decoded blocks stay in memory until the command ends.\n", file);
+        mem = mmap(NULL, RoundUp(raw_size, page_size), PROT_READ | PROT_WRITE,
+                   MAP_SHARED | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    }
+    uint64_t shared_size = RoundUp(sizeof(SeekableMap::Shared) + blocks * sizeof(uint64_t), page_size);
+    void* shared = mmap(NULL, shared_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (mem == MAP_FAILED || shared == MAP_FAILED) {
+        if (mem != MAP_FAILED) munmap(mem, RoundUp(raw_size, page_size));
+        if (shared != MAP_FAILED) munmap(shared, shared_size);
+        lzma_index_end(index, NULL);
+        return nullptr;
+    }
+
+    std::unique_ptr<SeekableMap> seekable = std::make_unique<SeekableMap>(
+            mem, raw_size, map, index, blocks, reinterpret_cast<SeekableMap::Shared *>(shared), spill);
+    seekable->setFile(file, 0);
+
+    if (!seekable->Pin(seekable->data(), EI_NIDENT)
+            || memcmp(reinterpret_cast<uint8_t *>(seekable->data()), ELFMAG, 4)) {
+        LOGE("Invalid ELF file.\n");
+        return nullptr;
+    }
+
+    uint8_t* ident = reinterpret_cast<uint8_t *>(seekable->data());
+    bool pinned = ident[EI_CLASS] == ELFCLASS64 ?
+                  PinHeaders<Elf64_Ehdr, Elf64_Phdr>(seekable.get()) :
+                  PinHeaders<Elf32_Ehdr, Elf32_Phdr>(seekable.get());
+    if (!pinned) {
+        LOGE("Can't decode core headers %s\n", file);
+        return nullptr;
+    }
+
+    if (blocks == 1)
+        LOGW("%s has only one xz block, repack it to decode on demand.\n", file);
+    LOGI("Seekable core %s (xz blocks %" PRIu64 ", cache 0x%" PRIx64 ")\n",
+            file, blocks, GetCacheLimit());
+    kMaps.push_back(seekable.get());
+    return seekable.release();
+#else
+    return nullptr;
+#endif // __LZMA__
+}
+
+/*
+ * Output is a standard multi-block .xz, same as
+ * xz -T0 --block-size=<SIZE>, so it still opens with any xz tool.
+ */
+bool Seekable::Repack(const char* input, const char* output, uint64_t block_size, uint32_t preset) {
+#if defined(__LZMA__)
+    std::unique_ptr<MemoryMap> map(MemoryMap::MmapFile(input));
+    if (!map) {
+        LOGE("Can't open %s\n", input);
+        return false;
+    }
+
+    if (memcmp(reinterpret_cast<uint8_t *>(map->data()), ELFMAG, 4)) {
+        LOGE("Invalid ELF file.\n");
+        return false;
+    }
+
+    lzma_mt mt;
+    memset(&mt, 0, sizeof(mt));
+    mt.block_size = block_size;
+    mt.preset = preset;
+    mt.check = LZMA_CHECK_CRC64;
+    mt.threads = std::max(lzma_cputhreads(), 1u);
+
+    lzma_stream strm = LZMA_STREAM_INIT;
+    lzma_ret ret = lzma_stream_encoder_mt(&strm, &mt);
+    if (ret != LZMA_OK) {
+        LOGE("LZMA: Error initializing encoder: %d\n", ret);
+        return false;
+    }
+
+    FILE* fp = fopen(output, "wb");
+    if (!fp) {
+        lzma_end(&strm);
+        LOGE("Can't create %s\n", output);
+        return false;
+    }
+
+    constexpr uint64_t kBufferSize = 1024 * 1024;
+    std::unique_ptr<uint8_t[]> buffer(new uint8_t[kBufferSize]);
+    strm.next_in = reinterpret_cast<uint8_t *>(map->data());
+    strm.avail_in = map->size();
+
+    bool errors = false;
+    uint64_t current = 0;
+    do {
+        strm.next_out = buffer.get();
+        strm.avail_out = kBufferSize;
+        ret = lzma_code(&strm, LZMA_FINISH);
+        if (ret != LZMA_OK && ret != LZMA_STREAM_END) {
+            LOGE("LZMA: Error encode: %d\n", ret);
+            errors = true;
+            break;
+        }
+
+        uint64_t out_size = kBufferSize - strm.avail_out;
+        if (out_size && !fwrite(buffer.get(), out_size, 1, fp)) {
+            errors = true;
+            break;
+        }
+        current += out_size;
+    } while (ret != LZMA_STREAM_END);
+
+    lzma_end(&strm);
+    fclose(fp);
+
+    if (errors) {
+        unlink(output);
+        LOGE("Repack %s fail.\n", input);
+        return false;
+    }
+    LOGI("Repack %s -> %s (0x%" PRIx64 " -> 0x%" PRIx64 ")\n",
+            input, output, map->size(), current);
+    return true;
+#else
+    LOGE("Not support LZMA.\n");
+    return false;
+#endif // __LZMA__
+}
+
+void Seekable::Trim() {
+    for (const auto& map : kMaps)
+        map->Trim(kCacheLimit);
+}
+
+SeekableMap::SeekableMap(void* m, uint64_t s, std::unique_ptr<MemoryMap>& file,
+                         lzma_index_s* index, uint64_t blocks, Shared* shared, bool spill)
+        : MemoryMap(m, s, 0, s) {
+    mFile = std::move(file);
+    mIndex = index;
+    mNumBlocks = blocks;
+    mShared = shared;
+    mSpill = spill;
+    mStamps = reinterpret_cast<uint64_t *>(mShared + 1);
+
+    pthread_mutexattr_t attr;
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_setpshared(&attr, PTHREAD_PROCESS_SHARED);
+#if defined(__linux__)
+    // a command child killed while decoding must not leave it locked.
+    pthread_mutexattr_setrobust(&attr, PTHREAD_MUTEX_ROBUST);
+#endif
+    pthread_mutex_init(&mShared->lock, &attr);
+    pthread_mutexattr_destroy(&attr);
+    mShared->epoch.store(1, std::memory_order_release);
+}
+
+SeekableMap::~SeekableMap() {
+    auto iter = std::find(Seekable::kMaps.begin(), Seekable::kMaps.end(), this);
+    if (iter != Seekable::kMaps.end())
+        Seekable::kMaps.erase(iter);
+
+    uint64_t page_size = sysconf(_SC_PAGE_SIZE);
+    munmap(mBegin, RoundUp(size(), page_size));
+    munmap(mShared, RoundUp(sizeof(Shared) + mNumBlocks * sizeof(uint64_t), page_size));
+    mBegin = MAP_FAILED;
+#if defined(__LZMA__)
+    lzma_index_end(mIndex, NULL);
+#endif // __LZMA__
+    mFile.reset();
+}
+
+void SeekableMap::lock() {
+    int ret = pthread_mutex_lock(&mShared->lock);
+#if defined(__linux__)
+    // blocks are stamped only after a full decode, nothing to repair.
+    if (ret == EOWNERDEAD)
+        pthread_mutex_consistent(&mShared->lock);
+#endif
+}
+
+void SeekableMap::unlock() {
+    pthread_mutex_unlock(&mShared->lock);
+}
+
+bool SeekableMap::Fill(uint64_t addr, uint64_t size) {
+    if (addr < data())
+        return false;
+    return fill(addr - data(), size, false);
+}
+
+bool SeekableMap::Pin(uint64_t addr, uint64_t size) {
+    if (addr < data())
+        return false;
+    return fill(addr - data(), size, true);
+}
+
+bool SeekableMap::fill(uint64_t offset, uint64_t size, bool pin) {
+#if defined(__LZMA__)
+    uint64_t end = std::min(offset + size, this->size());
+    if (offset >= end)
+        return offset < this->size() || !size;
+
+    lzma_index_iter iter;
+    lzma_index_iter_init(&iter, mIndex);
+    if (lzma_index_iter_locate(&iter, offset))
+        return false;
+
+    bool ret = true;
+    lock();
+    uint64_t keep = mShared->clock + 1;
+    do {
+        uint64_t number = iter.block.number_in_file - 1;
+        uint64_t stamp = mStamps[number];
+        bool resident = stamp && stamp != kPinned && stamp != kSpilled;
+        if (!stamp && !decode(number,
+                              iter.block.uncompressed_file_offset, iter.block.uncompressed_size,
+                              iter.block.compressed_file_offset, iter.block.total_size,
+                              iter.block.unpadded_size, iter.stream.flags->check)) {
+            ret = false;
+            break;
+        }
+
+        if (pin) {
+            if (resident)
+                mShared->resident -= iter.block.uncompressed_size;
+            mStamps[number] = kPinned;
+        } else if (stamp != kPinned) {
+            if (!resident)
+                mShared->resident += iter.block.uncompressed_size;
+            mStamps[number] = ++mShared->clock;
+        }
+    } while (iter.block.uncompressed_file_offset + iter.block.uncompressed_size < end
+            && !lzma_index_iter_next(&iter, LZMA_INDEX_ITER_NONEMPTY_BLOCK));
+
+    // evict a quarter below the limit, so it is not rescanned on every fill.
+    // anon blocks are only dropped by Trim(), a worker may still read them.
+    uint64_t limit = Seekable::kCacheLimit;
+    if (mSpill && mShared->resident > limit)
+        evict(limit - limit / 4, keep);
+    unlock();
+    return ret;
+#else
+    return false;
+#endif // __LZMA__
+}
+
+bool SeekableMap::decode(uint64_t number, uint64_t offset, uint64_t size,
+                         uint64_t compressed_offset, uint64_t total_size,
+                         uint64_t unpadded_size, uint32_t check) {
+#if defined(__LZMA__)
+    if (compressed_offset + total_size > mFile->size() || offset + size > this->size())
+        return false;
+
+    const uint8_t* in = reinterpret_cast<uint8_t *>(mFile->data() + compressed_offset);
+    lzma_filter filters[LZMA_FILTERS_MAX + 1];
+    lzma_block block;
+    memset(&block, 0, sizeof(block));
+    block.version = 1;
+    block.check = static_cast<lzma_check>(check);
+    block.filters = filters;
+    block.header_size = lzma_block_header_size_decode(in[0]);
+    if (block.header_size > total_size)
+        return false;
+
+    lzma_ret ret = lzma_block_header_decode(&block, NULL, in);
+    if (ret != LZMA_OK) {
+        LOGE("LZMA: Error decode block %" PRIu64 " header: %d\n", number, ret);
+        return false;
+    }
+
+    size_t in_pos = block.header_size;
+    size_t out_pos = 0;
+    ret = lzma_block_compressed_size(&block, unpadded_size);
+    if (ret == LZMA_OK) {
+        ret = lzma_block_buffer_decode(&block, NULL, in, &in_pos, total_size,
+                                       reinterpret_cast<uint8_t *>(data() + offset), &out_pos, size);
+    }
+
+    for (int i = 0; filters[i].id != LZMA_VLI_UNKNOWN; ++i)
+        free(filters[i].options);
+
+    if (ret != LZMA_OK || out_pos != size) {
+        LOGE("LZMA: Error decode block %" PRIu64 ": %d\n", number, ret);
+        return false;
+    }
+    return true;
+#else
+    return false;
+#endif // __LZMA__
+}
+
+/*
+ * Called between commands, when no reader holds a pointer into the
+ * decoded core. The only eviction of an anon backed core, and the one
+ * that applies a cache limit lowered by "env".
+ */
+void SeekableMap::Trim(uint64_t limit) {
+    if (mShared->resident <= limit)
+        return;
+
+    lock();
+    evict(limit, UINT64_MAX);
+    unlock();
+}
+
+/*
+ * Called with the lock held. The least recently used blocks older than
+ * keep are evicted until the cache fits. A file backed block is paged
+ * out and stays decoded, an anon one is dropped and the epoch bump
+ * makes every LoadBlock fill again.
+ */
+void SeekableMap::evict(uint64_t limit, uint64_t keep) {
+#if defined(__LZMA__)
+    struct Candidate {
+        uint64_t stamp;
+        uint64_t number;
+        uint64_t offset;
+        uint64_t size;
+    };
+    std::vector<Candidate> candidates;
+
+    lzma_index_iter iter;
+    lzma_index_iter_init(&iter, mIndex);
+    while (!lzma_index_iter_next(&iter, LZMA_INDEX_ITER_NONEMPTY_BLOCK)) {
+        uint64_t number = iter.block.number_in_file - 1;
+        uint64_t stamp = mStamps[number];
+        if (stamp && stamp != kPinned && stamp != kSpilled && stamp < keep) {
+            candidates.push_back({stamp, number,
+                                  iter.block.uncompressed_file_offset, iter.block.uncompressed_size});
+        }
+    }
+
+    std::sort(candidates.begin(), candidates.end(),
+              [](const Candidate& a, const Candidate& b) { return a.stamp < b.stamp; });
+
+    uint64_t page_size = sysconf(_SC_PAGE_SIZE);
+    bool dropped = false;
+    for (const auto& candidate : candidates) {
+        if (mShared->resident <= limit)
+            break;
+
+        if (mSpill) {
+            // the data stays in the file, a neighbour page faults back in.
+            uint64_t begin = RoundDown(data() + candidate.offset, page_size);
+            uint64_t end = RoundUp(data() + candidate.offset + candidate.size, page_size);
+#if defined(MADV_PAGEOUT)
+            if (madvise(reinterpret_cast<void *>(begin), end - begin, MADV_PAGEOUT))
+#endif
+                madvise(reinterpret_cast<void *>(begin), end - begin, MADV_DONTNEED);
+            mStamps[candidate.number] = kSpilled;
+        } else {
+            // pages shared with a neighbour block stay, they are rewritten on refill.
+            uint64_t begin = RoundUp(data() + candidate.offset, page_size);
+            uint64_t end = RoundDown(data() + candidate.offset + candidate.size, page_size);
+            if (begin < end) {
+#if defined(__linux__)
+                madvise(reinterpret_cast<void *>(begin), end - begin, MADV_REMOVE);
+#else
+                madvise(reinterpret_cast<void *>(begin), end - begin, MADV_DONTNEED);
+#endif
+            }
+            mStamps[candidate.number] = 0;
+            dropped = true;
+        }
+        mShared->resident -= candidate.size;
+    }
+    if (dropped)
+        mShared->epoch.fetch_add(1, std::memory_order_release);
+#endif // __LZMA__
+}
+
+/*
+ * Decoded blocks are the only copy of their data, so the advice goes
+ * to the compressed blocks backing [addr, addr + size) instead.
+ */
+void SeekableMap::Advise(uint64_t addr, uint64_t size, int advice) {
+#if defined(__LZMA__)
+    uint64_t begin = std::max(addr, data());
+    uint64_t end = std::min(addr + size, data() + this->size());
+    if (begin >= end)
+        return;
+
+    lzma_index_iter first;
+    lzma_index_iter last;
+    lzma_index_iter_init(&first, mIndex);
+    lzma_index_iter_init(&last, mIndex);
+    if (lzma_index_iter_locate(&first, begin - data())
+            || lzma_index_iter_locate(&last, end - 1 - data()))
+        return;
+
+    mFile->Advise(mFile->data() + first.block.compressed_file_offset,
+                  last.block.compressed_file_offset + last.block.total_size
+                          - first.block.compressed_file_offset, advice);
+#endif // __LZMA__
+}
+
+} // xz
@@ -0,0 +1,115 @@
+/*
+ * Copyright (C) 2024-present, Guanyou.Chen. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CORE_COMMON_XZ_SEEKABLE_H_
+#define CORE_COMMON_XZ_SEEKABLE_H_
+
+#include "base/memory_map.h"
+#include <stdint.h>
+#include <sys/types.h>
+#include <pthread.h>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+struct lzma_index_s;
+
+/*
+ * A plain .xz core (xz -T0 --block-size=1MiB, or "core repack") is
+ * opened through the xz Index at the end of every stream, so any core
+ * offset maps to exactly one xz block that can be decoded on its own.
+ *
+ * The decoded core is reserved as a shared mapping of an unlinked temp
+ * file in TMPDIR or next to the core, and a block is only decoded when a LoadBlock
+ * that covers it is first read, which is done explicitly from
+ * LoadBlock::begin() rather than from a fault handler. Being shared,
+ * blocks decoded by a forked command child stay decoded for the parent
+ * and for every later command. Once the decoded blocks in memory pass
+ * the cache limit, Fill() pages the least recently used ones out to the
+ * temp file, they stay decoded and a pointer into them stays valid.
+ * Without a directory that can hold it the core falls back to anon
+ * memory. Anon blocks are only dropped by Trim() between commands, a
+ * command's workers may still read them, and decoded again later.
+ */
+
+namespace xz {
+
+class SeekableMap;
+
+class Seekable {
+public:
+    static constexpr uint64_t kDefaultBlockSize = 1024 * 1024;
+    static constexpr uint64_t kDefaultCacheSize = 512 * 1024 * 1024;
+    static constexpr uint32_t kDefaultPreset = 6;
+
+    static bool IsSeekable(const char* file);
+    static MemoryMap* MmapFile(const char* file);
+    static bool Repack(const char* input, const char* output, uint64_t block_size, uint32_t preset);
+    static void SetCacheLimit(uint64_t size) { kCacheLimit = size; }
+    static uint64_t GetCacheLimit() { return kCacheLimit; }
+    static void Trim();
+private:
+    static uint64_t kCacheLimit;
+    static std::vector<SeekableMap*> kMaps;
+    friend class SeekableMap;
+};
+
+class SeekableMap : public MemoryMap {
+public:
+    struct Shared {
+        pthread_mutex_t lock;
+        // bumped by Trim(), readers check it without the lock.
+        std::atomic<uint64_t> epoch;
+        uint64_t clock;
+        uint64_t resident;
+    };
+
+    static constexpr uint64_t kPinned = UINT64_MAX;
+    static constexpr uint64_t kSpilled = UINT64_MAX - 1;
+
+    SeekableMap(void* m, uint64_t s, std::unique_ptr<MemoryMap>& file,
+                lzma_index_s* index, uint64_t blocks, Shared* shared, bool spill);
+    ~SeekableMap();
+
+    inline uint64_t numBlocks() { return mNumBlocks; }
+    inline uint64_t residentSize() { return mShared->resident; }
+    uint64_t Epoch() { return mShared->epoch.load(std::memory_order_acquire); }
+    bool Fill(uint64_t addr, uint64_t size);
+    bool Pin(uint64_t addr, uint64_t size);
+    void Trim(uint64_t limit);
+    void Advise(uint64_t addr, uint64_t size, int advice);
+private:
+    bool fill(uint64_t offset, uint64_t size, bool pin);
+    bool decode(uint64_t number, uint64_t offset, uint64_t size,
+                uint64_t compressed_offset, uint64_t total_size, uint64_t unpadded_size, uint32_t check);
+    void evict(uint64_t limit, uint64_t keep);
+    void lock();
+    void unlock();
+
+    std::unique_ptr<MemoryMap> mFile;
+    lzma_index_s* mIndex;
+    uint64_t mNumBlocks;
+    Shared* mShared;
+    // decoded core is file backed, evicted blocks go to disk.
+    bool mSpill;
+    // per xz block, 0 not decoded, kPinned never trimmed,
+    // kSpilled decoded but paged out, else last used clock.
+    uint64_t* mStamps;
+};
+
+} // xz
+
+#endif // CORE_COMMON_XZ_SEEKABLE_H_
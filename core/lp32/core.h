@@ -43,6 +43,23 @@ public:
     uint32_t offset;
 };
 
+class Prpsinfo {
+public:
+    char pr_state;
+    char pr_sname;
+    char pr_zomb;
+    char pr_nice;
+    uint32_t pr_flag;
+    uint16_t pr_uid;
+    uint16_t pr_gid;
+    int32_t pr_pid;
+    int32_t pr_ppid;
+    int32_t pr_pgrp;
+    int32_t pr_sid;
+    char pr_fname[16];
+    char pr_psargs[80];
+};
+
 class Debug {
 public:
     Debug() : version(0), map(0) {}
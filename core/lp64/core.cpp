@@ -66,6 +66,10 @@ bool lp64::Core::load64(CoreApi* api, std::function<void* (uint64_t, uint64_t)>
                     case NT_PRSTATUS:
                         block->addThreadItem(callback(NT_PRSTATUS, item_pos));
                         break;
+                    case NT_PRPSINFO: {
+                        if (nhdr->n_descsz >= sizeof(lp64::Prpsinfo))
+                            api->setPid(reinterpret_cast<lp64::Prpsinfo *>(item_pos)->pr_pid);
+                    } break;
                     case NT_AUXV: {
                         int numauxv = nhdr->n_descsz / sizeof(lp64::Auxv);
                         block->setAuxvMaxCount(numauxv);
@@ -20,6 +20,8 @@
 #include "dex/modifiers.h"
 #include "android.h"
 #include "runtime/mirror/iftable.h"
+#include "runtime/class_index.h"
+#include "runtime/class_hierarchy.h"
 #include "api/core.h"
 #include <stdio.h>
 #include <unistd.h>
@@ -32,7 +34,10 @@ int ClassCommand::prepare(int argc, char* const argv[]) {
 
     options.dump_all = true;
     options.show_flag = 0;
+    options.list_flag = 0;
     options.format_hex = false;
+    options.regex = false;
+    options.use_index = false;
     options.obj_each_flags = 0;
     options.total_classes = 0;
 
@@ -45,14 +50,17 @@ int ClassCommand::prepare(int argc, char* const argv[]) {
         {"impl",    no_argument,       0,  'i'},
         {"field",   no_argument,       0,  'f'},
         {"hex",     no_argument,       0,  'x'},
+        {"regex",   no_argument,       0,  'r'},
         {"app",     no_argument,       0,   1 },
         {"zygote",  no_argument,       0,   2 },
         {"image",   no_argument,       0,   3 },
         {"fake",    no_argument,       0,   4 },
+        {"subclasses",  no_argument,   0,   5 },
+        {"implementors", no_argument,  0,   6 },
         {0,         0,                 0,   0 },
     };
 
-    while ((opt = getopt_long(argc, argv, "msifx",
+    while ((opt = getopt_long(argc, argv, "msifxr",
                 long_options, &option_index)) != -1) {
         switch (opt) {
             case 'm':
@@ -70,6 +78,9 @@ int ClassCommand::prepare(int argc, char* const argv[]) {
             case 'x':
                 options.format_hex = true;
                 break;
+            case 'r':
+                options.regex = true;
+                break;
             case 1:
                 options.obj_each_flags |= Android::EACH_APP_OBJECTS;
                 break;
@@ -82,23 +93,49 @@ int ClassCommand::prepare(int argc, char* const argv[]) {
             case 4:
                 options.obj_each_flags |= Android::EACH_FAKE_OBJECTS;
                 break;
+            case 5:
+                options.list_flag |= LIST_SUBCLASSES;
+                break;
+            case 6:
+                options.list_flag |= LIST_IMPLEMENTORS;
+                break;
         }
     }
     options.optind = optind;
 
     if (!options.obj_each_flags) {
+        options.use_index = true;
         options.obj_each_flags |= Android::EACH_APP_OBJECTS;
         options.obj_each_flags |= Android::EACH_ZYGOTE_OBJECTS;
         options.obj_each_flags |= Android::EACH_IMAGE_OBJECTS;
         options.obj_each_flags |= Android::EACH_FAKE_OBJECTS;
     }
 
+    if (options.list_flag && !(options.optind < argc)) {
+        LOGE("--subclasses and --implementors need CLASSNAME.\n");
+        return Command::FINISH;
+    }
+
     if (options.optind < argc) {
         options.dump_all = false;
         options.show_flag = !options.show_flag ? SHOW_ALL : options.show_flag;
+        if (options.regex) {
+            try {
+                pattern = std::regex(argv[options.optind]);
+            } catch (std::regex_error& e) {
+                LOGE("Invalid regex %s\n", argv[options.optind]);
+                return Command::FINISH;
+            }
+        }
     }
 
     Android::Prepare();
+    // name lookups go through the class index, build it before fork so it outlives the child.
+    if (!options.dump_all && (options.list_flag || options.use_index)
+            && !Utils::atol(argv[options.optind]))
+        art::ClassIndex::Prepare();
+    if (options.list_flag)
+        art::ClassHierarchy::Prepare();
     return Command::ONCHLD;
 }
 
@@ -113,7 +150,28 @@ int ClassCommand::main(int argc, char* const argv[]) {
             art::mirror::Object obj = Utils::atol(argv[options.optind]);
             if (obj.Ptr() && obj.IsValid() && obj.IsClass()) {
                 art::mirror::Class thiz = obj;
-                PrintPrettyClassContent(thiz);
+                options.list_flag ? ListRelatedClasses(thiz) : PrintPrettyClassContent(thiz);
+            } else if (options.list_flag) {
+                auto list = [&](art::mirror::Class& clazz) -> bool {
+                    ListRelatedClasses(clazz);
+                    return false;
+                };
+                options.regex ? art::ClassIndex::FindByRegex(classname, list)
+                              : art::ClassIndex::Find(classname, list);
+            } else if (options.use_index) {
+                // all spaces, the class index answers without a heap walk
+                bool found = false;
+                auto print = [&](art::mirror::Class& clazz) -> bool {
+                    found = true;
+                    PrintPrettyClassContent(clazz);
+                    return false;
+                };
+                if (options.regex) {
+                    art::ClassIndex::FindByRegex(classname, print);
+                } else {
+                    art::ClassIndex::Find(classname, print);
+                    if (!found) art::ClassIndex::FindBySimpleName(classname, print);
+                }
             } else {
                 Android::ForeachObjects(callback, options.obj_each_flags, false);
             }
@@ -136,13 +194,33 @@ bool ClassCommand::PrintClass(art::mirror::Object& object, const char* classname
         LOGI("[%" PRId64 "] " ANSI_COLOR_LIGHTYELLOW "0x%" PRIx64 "" ANSI_COLOR_LIGHTCYAN " %s\n" ANSI_COLOR_RESET,
                 options.total_classes, thiz.Ptr(), thiz.PrettyDescriptor().c_str());
         if (options.show_flag) PrintPrettyClassContent(thiz);
-    } else if (thiz.PrettyDescriptor() == classname) {
+    } else if (options.regex ? std::regex_search(thiz.CachedDescriptor(), pattern)
+                             : thiz.CachedDescriptor() == classname) {
         PrintPrettyClassContent(thiz);
     }
 
     return false;
 }
 
+void ClassCommand::ListRelatedClasses(art::mirror::Class& clazz) {
+    auto print = [&](art::mirror::Class& related) -> bool {
+        options.total_classes++;
+        LOGI("[%" PRId64 "] " ANSI_COLOR_LIGHTYELLOW "0x%" PRIx64 "" ANSI_COLOR_LIGHTCYAN " %s\n" ANSI_COLOR_RESET,
+                options.total_classes, related.Ptr(), related.CachedDescriptor().c_str());
+        return false;
+    };
+
+    LOGI(ANSI_COLOR_LIGHTYELLOW "[0x%" PRIx64 "]" ANSI_COLOR_RESET " %s\n", clazz.Ptr(), clazz.CachedDescriptor().c_str());
+    if (options.list_flag & LIST_SUBCLASSES) {
+        LOGI(ANSI_COLOR_LIGHTCYAN "  // Subclasses:\n" ANSI_COLOR_RESET);
+        art::ClassHierarchy::ForeachSubClass(clazz, print);
+    }
+    if (options.list_flag & LIST_IMPLEMENTORS) {
+        LOGI(ANSI_COLOR_LIGHTCYAN "  // Implementors:\n" ANSI_COLOR_RESET);
+        art::ClassHierarchy::ForeachImplementor(clazz, print);
+    }
+}
+
 void ClassCommand::PrintPrettyClassContent(art::mirror::Class& clazz) {
     LOGI(ANSI_COLOR_LIGHTYELLOW "[0x%" PRIx64 "]\n" ANSI_COLOR_RESET, clazz.Ptr());
     art::mirror::Class super = clazz.GetSuperClass();
@@ -248,6 +326,9 @@ void ClassCommand::usage() {
     LOGI("    -s, --static       show static field\n");
     LOGI("    -f, --field        show instance field\n");
     LOGI("    -x, --hex          basic type hex print\n");
+    LOGI("    -r, --regex        match CLASSNAME as regex\n");
+    LOGI("        --subclasses   list all subclasses of CLASSNAME\n");
+    LOGI("        --implementors list all implementors of interface CLASSNAME\n");
     LOGI("Type: {--app, --zygote, --image, --fake}\n");
     ENTER();
     LOGI("core-parser> class android.net.wifi.WifiNetworkSpecifier\n");
@@ -302,5 +383,12 @@ void ClassCommand::usage() {
     ENTER();
     LOGI("core-parser> class android.net.wifi.WifiNetworkSpecifier -m | grep desc\n");
     LOGI("    [0x791af097e968] public int android.net.wifi.WifiNetworkSpecifier.describeContents()\n");
+    ENTER();
+    LOGI("core-parser> class android.net.NetworkSpecifier --subclasses\n");
+    LOGI("[0x71c4f2d8] android.net.NetworkSpecifier\n");
+    LOGI("  // Subclasses:\n");
+    LOGI("[1] 0x71c4f3a0 android.net.MatchAllNetworkSpecifier\n");
+    LOGI("[2] 0x71c4f468 android.net.TelephonyNetworkSpecifier\n");
+    LOGI("[3] 0x71c530a0 android.net.wifi.WifiNetworkSpecifier\n");
 }
 
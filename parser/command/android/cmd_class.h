@@ -21,6 +21,7 @@
 #include "runtime/mirror/object.h"
 #include "runtime/mirror/class.h"
 #include <string>
+#include <regex>
 
 class ClassCommand : public Command {
 public:
@@ -31,6 +32,9 @@ public:
     static constexpr int SHOW_ALL = SHOW_METHOD | SHOW_IMPL |
                                     SHOW_STATIC | SHOW_FIELD;
 
+    static constexpr int LIST_SUBCLASSES = 1 << 0;
+    static constexpr int LIST_IMPLEMENTORS = 1 << 1;
+
     ClassCommand() : Command("class") {}
     ~ClassCommand() {}
 
@@ -38,7 +42,10 @@ public:
         uint64_t total_classes;
         bool dump_all;
         bool format_hex;
+        bool regex;
+        bool use_index;
         int show_flag;
+        int list_flag;
         int obj_each_flags;
     };
 
@@ -48,8 +55,10 @@ public:
 
     bool PrintClass(art::mirror::Object& object, const char* classname);
     void PrintPrettyClassContent(art::mirror::Class& clazz);
+    void ListRelatedClasses(art::mirror::Class& clazz);
 private:
     Options options;
+    std::regex pattern;
 };
 
 #endif // PARSER_COMMAND_ANDROID_CMD_CLASS_H_
@@ -23,10 +23,19 @@
 #include "android.h"
 #include "runtime/runtime.h"
 #include "runtime/class_linker.h"
+#include "runtime/class_index.h"
+#include "runtime/art_method.h"
+#include "dex/modifiers.h"
+#include "dexdump/dexdump.h"
+#include "common/exception.h"
 #include <string>
 #include <unistd.h>
 #include <getopt.h>
 #include <filesystem>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <unordered_map>
 
 int DexCommand::prepare(int argc, char* const argv[]) {
     if (!CoreApi::IsReady() || !Android::IsSdkReady())
@@ -37,6 +46,8 @@ int DexCommand::prepare(int argc, char* const argv[]) {
     options.app = false;
     options.num = 0;
     options.dir = const_cast<char *>(Env::CurrentDir());
+    options.disasm_dir = nullptr;
+    options.threads = 0;
 
     int opt;
     int option_index = 0;
@@ -46,10 +57,12 @@ int DexCommand::prepare(int argc, char* const argv[]) {
         {"app",     no_argument,       0,   1 },
         {"dir",     required_argument, 0,  'd'},
         {"num",     required_argument, 0,  'n'},
+        {"disasm-all", required_argument, 0, 2 },
+        {"threads", required_argument, 0,  't'},
         {0,         0,                 0,   0 },
     };
 
-    while ((opt = getopt_long(argc, argv, "od:n:",
+    while ((opt = getopt_long(argc, argv, "od:n:t:",
                 long_options, &option_index)) != -1) {
         switch (opt) {
             case 'o':
@@ -66,17 +79,31 @@ int DexCommand::prepare(int argc, char* const argv[]) {
                 options.num = std::atoi(optarg);
                 options.dump_dex = true;
                 break;
+            case 2:
+                options.disasm_dir = optarg;
+                break;
+            case 't':
+                options.threads = std::atoi(optarg);
+                break;
         }
     }
     options.optind = optind;
 
     Android::Prepare();
+    // disassembly resolves classes through the index, build it before fork so it outlives the child.
+    if (options.disasm_dir)
+        art::ClassIndex::Prepare();
     return Command::ONCHLD;
 }
 
 int DexCommand::main(int argc, char* const argv[]) {
     art::Runtime& runtime = art::Runtime::Current();
     art::ClassLinker& linker = runtime.GetClassLinker();
+    if (options.disasm_dir) {
+        DisasmAll();
+        return 0;
+    }
+
     if (!options.dump_dex)
         LOGI(ANSI_COLOR_LIGHTRED "NUM DEXCACHE    REGION                   FLAGS NAME\n" ANSI_COLOR_RESET);
     int pos = 0;
@@ -191,6 +218,187 @@ void DexCommand::DumpDexFile(int pos, art::mirror::DexCache& dex_cache, art::Dex
     }
 }
 
+void DexCommand::DisasmAll() {
+    std::error_code ec;
+    std::filesystem::create_directories(options.disasm_dir, ec);
+    if (ec) {
+        LOGE("Can't create %s: %s\n", options.disasm_dir, ec.message().c_str());
+        return;
+    }
+
+    art::Runtime& runtime = art::Runtime::Current();
+    art::ClassLinker& linker = runtime.GetClassLinker();
+
+    std::vector<DisasmTask> tasks;
+    std::unordered_map<uint64_t, uint32_t> groups;
+    int pos = 0;
+    for (const auto& value : linker.GetDexCacheDatas()) {
+        pos++;
+        if (options.num > 0 && options.num != pos)
+            continue;
+
+        art::mirror::DexCache& dex_cache = value->GetDexCache();
+        art::DexFile& dex_file = value->GetDexFile();
+        if (!dex_cache.Ptr() || !dex_file.Ptr())
+            continue;
+
+        DisasmTask task;
+        task.pos = pos;
+        task.dex_cache = dex_cache.Ptr();
+        task.methods = 0;
+        task.insns = 0;
+        try {
+            task.name = DexFileLocation(dex_file, options.dump_ori);
+        } catch (InvalidAddressException& e) {
+            task.name = "<unknown>";
+        }
+        std::filesystem::path file(task.name);
+        task.file = std::to_string(pos);
+        task.file.append("_").append(file.filename().string()).append(".smali");
+        groups[task.dex_cache] = tasks.size();
+        tasks.push_back(std::move(task));
+    }
+
+    auto group_class = [&](art::mirror::Class& clazz) -> bool {
+        try {
+            auto it = groups.find(clazz.dex_cache());
+            if (it != groups.end())
+                tasks[it->second].classes.push_back(clazz.Ptr());
+        } catch (InvalidAddressException& e) {}
+        return false;
+    };
+    art::ClassIndex::Foreach(group_class);
+
+    std::vector<uint32_t> order(tasks.size());
+    for (uint32_t i = 0; i < order.size(); ++i) order[i] = i;
+    std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+        return tasks[a].classes.size() > tasks[b].classes.size();
+    });
+
+    int nthreads = options.threads > 0 ? options.threads : std::thread::hardware_concurrency();
+    nthreads = std::max(1, std::min<int>(nthreads, tasks.size()));
+
+    // each dex file has its own output, no lock around the writes.
+    std::vector<uint8_t> saved(tasks.size(), 0);
+    std::atomic<uint32_t> next(0);
+    auto worker = [&]() {
+        uint32_t i;
+        while ((i = next.fetch_add(1)) < order.size()) {
+            DisasmTask& task = tasks[order[i]];
+            std::string output = options.disasm_dir;
+            output.append("/").append(task.file);
+            FILE* fp = fopen(output.c_str(), "w");
+            if (!fp)
+                continue;
+            DisasmDexFile(task, fp);
+            fclose(fp);
+            saved[order[i]] = 1;
+        }
+    };
+
+    bool light = Logger::IsLight();
+    Logger::SetHighLight(false);
+    std::vector<std::thread> workers;
+    for (int i = 1; i < nthreads; ++i)
+        workers.emplace_back(worker);
+    worker();
+    for (auto& thread : workers)
+        thread.join();
+    Logger::SetHighLight(light);
+
+    std::string index = options.disasm_dir;
+    index.append("/index.txt");
+    FILE* fp = fopen(index.c_str(), "w");
+    if (fp)
+        fprintf(fp, "NUM  CLASSES  METHODS      INSNS  FILE  LOCATION\n");
+
+    uint32_t total = 0;
+    for (uint32_t i = 0; i < tasks.size(); ++i) {
+        DisasmTask& task = tasks[i];
+        if (!saved[i]) {
+            LOGE("Can't open %s/%s\n", options.disasm_dir, task.file.c_str());
+            continue;
+        }
+        if (fp) {
+            fprintf(fp, "%3d  %7zu  %7u  %9" PRIu64 "  %s  %s\n",
+                    task.pos, task.classes.size(), task.methods, task.insns,
+                    task.file.c_str(), task.name.c_str());
+        }
+        total += task.methods;
+        LOGI("Saved [%s/%s].\n", options.disasm_dir, task.file.c_str());
+    }
+
+    if (fp) {
+        fclose(fp);
+        LOGI("Saved [%s].\n", index.c_str());
+    } else {
+        LOGE("Can't open %s\n", index.c_str());
+    }
+    LOGD("dex disasm %u methods of %ld dex files with %d threads.\n", total, tasks.size(), nthreads);
+}
+
+void DexCommand::DisasmDexFile(DisasmTask& task, FILE* fp) {
+    std::vector<std::pair<std::string, uint64_t>> classes;
+    for (const auto& ptr : task.classes) {
+        art::mirror::Class clazz = ptr;
+        try {
+            std::string storage;
+            classes.push_back(std::pair<std::string, uint64_t>(clazz.GetDescriptor(&storage), ptr));
+        } catch (InvalidAddressException& e) {}
+    }
+    std::sort(classes.begin(), classes.end());
+
+    auto visit_method = [&](art::ArtMethod& method) -> bool {
+        // a method that fails before its header is skipped, not left open.
+        bool opened = false;
+        try {
+            if (method.IsRuntimeMethod() || method.IsCopied())
+                return false;
+
+            art::DexFile& dex_file = method.GetDexFile();
+            art::dex::MethodId method_id = dex_file.GetMethodId(method.GetDexMethodIndex());
+            art::dex::ProtoId proto_id = dex_file.GetMethodPrototype(method_id);
+            fprintf(fp, "\n.method %s%s%s%s  # 0x%" PRIx64 "\n",
+                    art::PrettyJavaAccessFlags(method.GetAccessFlags() & art::kAccJavaFlagsMask).c_str(),
+                    method.GetName(), dex_file.GetMethodParametersDescriptor(proto_id).c_str(),
+                    method.GetReturnTypeDescriptor(), method.Ptr());
+            opened = true;
+            task.methods++;
+
+            art::dex::CodeItem item = method.GetCodeItem();
+            if (item.Ptr()) {
+                fprintf(fp, "    .registers %d\n", item.num_regs_);
+                api::MemoryRef coderef = item.Ptr() + item.code_offset_;
+                api::MemoryRef endref = coderef.Ptr() + (item.insns_count_ << 1);
+                coderef.copyRef(item);
+                while (coderef < endref) {
+                    fprintf(fp, "    %s\n", art::Dexdump::PrettyDexInst(coderef, dex_file).c_str());
+                    coderef.MovePtr(art::Dexdump::GetDexInstSize(coderef));
+                }
+                task.insns += item.insns_count_ << 1;
+            }
+        } catch (InvalidAddressException& e) {
+            if (opened) fprintf(fp, "    # <invalid>\n");
+        }
+        if (opened) fprintf(fp, ".end method\n");
+        return false;
+    };
+
+    fprintf(fp, "# %s\n", task.name.c_str());
+    for (auto& value : classes) {
+        art::mirror::Class clazz = value.second;
+        bool opened = false;
+        try {
+            fprintf(fp, "\n.class %s%s\n",
+                    art::PrettyJavaAccessFlags(clazz.GetAccessFlags() & art::kAccJavaFlagsMask).c_str(),
+                    value.first.c_str());
+            opened = true;
+            Android::ForeachArtMethods(clazz, visit_method);
+        } catch (InvalidAddressException& e) {}
+        if (opened) fprintf(fp, "\n.end class\n");
+    }
+}
+
 void DexCommand::usage() {
     LOGI("Usage: dex [OPTIONE...]\n");
     LOGI("Option:\n");
@@ -198,6 +406,9 @@ void DexCommand::usage() {
     LOGI("        --app              dex unpack from app\n");
     LOGI("    -n, --num <NUM>        dex unpack with num\n");
     LOGI("    -d, --dir <DIR_PATH>   unpack output path\n");
+    LOGI("        --disasm-all <DIR_PATH>\n");
+    LOGI("                           disassemble methods of loaded classes into smali-like files\n");
+    LOGI("    -t, --threads <NUM>    disasm worker threads (default cpu count)\n");
     ENTER();
     LOGI("core-parser> dex\n");
     LOGI("NUM DEXCACHE    REGION                   FLAGS NAME\n");
@@ -224,4 +435,11 @@ void DexCommand::usage() {
     ENTER();
     LOGI("core-parser> dex -n 7\n");
     LOGI("Saved [./framework.jar_0x347a29fd].\n");
+    ENTER();
+    LOGI("core-parser> dex --disasm-all /tmp/smali -t 8\n");
+    LOGI("Saved [/tmp/smali/1_core-oj.jar.smali].\n");
+    LOGI("Saved [/tmp/smali/2_core-libart.jar.smali].\n");
+    LOGI(" ...\n");
+    LOGI("Saved [/tmp/smali/26_base.apk!classes3.dex.smali].\n");
+    LOGI("Saved [/tmp/smali/index.txt].\n");
 }
@@ -19,6 +19,9 @@
 
 #include "command/command.h"
 #include "runtime/mirror/dex_cache.h"
+#include <stdio.h>
+#include <string>
+#include <vector>
 
 class DexCommand : public Command {
 public:
@@ -31,6 +34,19 @@ public:
         bool app;
         char* dir;
         bool dump_dex;
+        char* disasm_dir;
+        int threads;
+    };
+
+    // one dex file of the disasm, only its worker writes the output.
+    struct DisasmTask {
+        int pos;
+        uint64_t dex_cache;
+        std::string name;
+        std::string file;
+        std::vector<uint64_t> classes;
+        uint32_t methods;
+        uint64_t insns;
     };
 
     int main(int argc, char* const argv[]);
@@ -40,6 +56,8 @@ public:
     void DexCachesDump_v33();
     void ShowDexCacheRegion(int pos, art::mirror::DexCache& dex_cache, art::DexFile& dex_file);
     void DumpDexFile(int pos, art::mirror::DexCache& dex_cache, art::DexFile& dex_file);
+    void DisasmAll();
+    static void DisasmDexFile(DisasmTask& task, FILE* fp);
     static std::string DexFileLocation(art::DexFile& dex_file, bool dump_ori);
 private:
     Options options;
@@ -18,6 +18,7 @@
 #include "android.h"
 #include "command/android/cmd_dumpsys.h"
 #include "com/android/server/am/ActivityManagerService.h"
+#include "runtime/class_index.h"
 #include <string>
 
 typedef int (*DumpsysCall)(int argc, char* const argv[]);
@@ -37,6 +38,9 @@ int DumpsysCommand::prepare(int argc, char* const argv[]) {
     }
 
     Android::Prepare();
+    // services are found through java.lang.Class.forName.
+    if (Android::IsSdkReady())
+        art::ClassIndex::Prepare();
     return Command::ONCHLD;
 }
 
@@ -0,0 +1,329 @@
+/*
+ * Copyright (C) 2024-present, Guanyou.Chen. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "logger/log.h"
+#include "base/utils.h"
+#include "common/exception.h"
+#include "command/android/cmd_exceptions.h"
+#include "java/lang/Throwable.h"
+#include "runtime/mirror/array.h"
+#include "runtime/art_method.h"
+#include "runtime/class_index.h"
+#include "runtime/class_hierarchy.h"
+#include "api/core.h"
+#include "android.h"
+#include "heap_walk.h"
+#include <stdlib.h>
+#include <unistd.h>
+#include <getopt.h>
+#include <algorithm>
+
+int ExceptionsCommand::prepare(int argc, char* const argv[]) {
+    if (!CoreApi::IsReady() || !Android::IsSdkReady())
+        return Command::FINISH;
+
+    options.top = false;
+    options.num = 16;
+    options.stacks = 3;
+    options.depth = 8;
+
+    int opt;
+    int option_index = 0;
+    optind = 0; // reset
+    static struct option long_options[] = {
+        {"top",      no_argument,       0,   1 },
+        {"num",      required_argument, 0,  'n'},
+        {"stacks",   required_argument, 0,  's'},
+        {"depth",    required_argument, 0,  'd'},
+        {0,          0,                 0,   0 },
+    };
+
+    while ((opt = getopt_long(argc, argv, "n:s:d:",
+                long_options, &option_index)) != -1) {
+        switch (opt) {
+            case 1:
+                options.top = true;
+                break;
+            case 'n':
+                options.num = std::atoi(optarg);
+                break;
+            case 's':
+                options.stacks = std::atoi(optarg);
+                break;
+            case 'd':
+                options.depth = std::atoi(optarg);
+                break;
+        }
+    }
+    options.optind = optind;
+
+    Android::Prepare();
+    // throwable classes come from the hierarchy built before fork.
+    art::ClassHierarchy::Prepare();
+    return Command::ONCHLD;
+}
+
+int ExceptionsCommand::main(int argc, char* const argv[]) {
+    if (!art::ClassHierarchy::IsReady()) {
+        LOGE("ClassHierarchy unavailable.\n");
+        return 0;
+    }
+
+    std::vector<art::mirror::Class> throwables;
+    auto add_throwable = [&](art::mirror::Class& clazz) -> bool {
+        throwables.push_back(clazz);
+        return false;
+    };
+    art::ClassIndex::Find("java.lang.Throwable", add_throwable);
+
+    auto is_throwable = [&](art::mirror::Class& thiz) -> bool {
+        for (auto& throwable : throwables) {
+            if (art::ClassHierarchy::IsSubClassOf(thiz, throwable))
+                return true;
+        }
+        return false;
+    };
+
+    // classes are matched by descriptor, class loaders may define the same one.
+    std::unordered_map<std::string, uint32_t> names;
+    std::vector<ExceptionsCommand::Census> census;
+    std::vector<std::string> frames;
+    std::vector<std::string> methods;
+    std::string joined;
+
+    auto visit = [&](art::mirror::Object& object) {
+        if (object.IsClass())
+            return;
+
+        art::mirror::Class thiz = object.GetClass();
+        if (!is_throwable(thiz))
+            return;
+
+        frames.clear();
+        methods.clear();
+        try {
+            DecodeFrames(object, frames, methods);
+        } catch (InvalidAddressException& e) {}
+
+        const std::string& descriptor = thiz.CachedDescriptor();
+        if (!options.top) {
+            std::string message;
+            try {
+                java::lang::Throwable throwable = object;
+                java::lang::String& detail = throwable.getMessage();
+                if (!detail.isNull())
+                    message.append(": ").append(detail.toString());
+            } catch (InvalidAddressException& e) {}
+            LOGI(ANSI_COLOR_LIGHTYELLOW "[0x%" PRIx64 "]" ANSI_COLOR_RESET " " ANSI_COLOR_LIGHTCYAN "%s" ANSI_COLOR_RESET "%s\n",
+                 object.Ptr(), descriptor.c_str(), message.c_str());
+            if (frames.size())
+                LOGI("    at %s\n", frames[0].c_str());
+            return;
+        }
+
+        uint32_t idx;
+        auto it = names.find(descriptor);
+        if (it == names.end()) {
+            idx = census.size();
+            names[descriptor] = idx;
+            census.emplace_back();
+            census[idx].descriptor = descriptor;
+            census[idx].count = 0;
+            census[idx].shallow_size = 0;
+        } else {
+            idx = it->second;
+        }
+
+        ExceptionsCommand::Census& value = census[idx];
+        value.count += 1;
+        value.shallow_size += object.SizeOf();
+
+        joined.clear();
+        for (const auto& method : methods)
+            joined.append(method).append("\n");
+        uint32_t hash = Utils::CRC32(reinterpret_cast<uint8_t *>(joined.data()), joined.length());
+        auto st = value.signatures.find(hash);
+        if (st == value.signatures.end()) {
+            ExceptionsCommand::Signature& signature = value.signatures[hash];
+            signature.hash = hash;
+            signature.count = 1;
+            signature.example = object.Ptr();
+            signature.frames = frames;
+        } else {
+            st->second.count += 1;
+        }
+    };
+
+    // one unreadable object must not end the walk.
+    auto callback = [&](art::mirror::Object& object) -> bool {
+        try {
+            visit(object);
+        } catch (InvalidAddressException& e) {
+            LOGD("Skip object 0x%" PRIx64 ".\n", object.Ptr());
+        }
+        return false;
+    };
+
+    try {
+        Android::ForEachObject(callback);
+    } catch (InvalidAddressException& e) {
+        LOGW("The statistical process was interrupted!\n");
+    }
+
+    if (options.top)
+        ShowCensus(census);
+    return 0;
+}
+
+void ExceptionsCommand::ShowCensus(std::vector<Census>& census) {
+    std::vector<uint32_t> order(census.size());
+    uint64_t total_count = 0;
+    uint64_t total_shallow = 0;
+    for (uint32_t i = 0; i < order.size(); ++i) {
+        order[i] = i;
+        total_count += census[i].count;
+        total_shallow += census[i].shallow_size;
+    }
+
+    uint32_t num = std::min<uint32_t>(options.num, order.size());
+    std::partial_sort(order.begin(), order.begin() + num, order.end(), [&](uint32_t a, uint32_t b) {
+        return census[a].count > census[b].count;
+    });
+
+    LOGI(ANSI_COLOR_LIGHTRED "     Count       Shallow  Stacks  Exception\n" ANSI_COLOR_RESET);
+    LOGI("%10" PRIu64 "  %12" PRIu64 "  %6s  TOTAL\n", total_count, total_shallow, "");
+    LOGI("------------------------------------------------------------------\n");
+    for (uint32_t i = 0; i < num; ++i) {
+        Census& value = census[order[i]];
+        LOGI("%10" PRIu64 "  %12" PRIu64 "  %6zu  " ANSI_COLOR_LIGHTCYAN "%s\n" ANSI_COLOR_RESET,
+             value.count, value.shallow_size, value.signatures.size(), value.descriptor.c_str());
+
+        std::vector<Signature*> signatures;
+        for (auto& entry : value.signatures)
+            signatures.push_back(&entry.second);
+        uint32_t stacks = std::min<uint32_t>(options.stacks, signatures.size());
+        std::partial_sort(signatures.begin(), signatures.begin() + stacks, signatures.end(),
+                [](Signature* a, Signature* b) { return a->count > b->count; });
+
+        for (uint32_t j = 0; j < stacks; ++j) {
+            Signature* signature = signatures[j];
+            LOGI("  " ANSI_COLOR_LIGHTMAGENTA "%8" PRIu64 "" ANSI_COLOR_RESET "  hash 0x%08x  e.g. " ANSI_COLOR_LIGHTYELLOW "0x%x\n" ANSI_COLOR_RESET,
+                 signature->count, signature->hash, signature->example);
+            for (const auto& frame : signature->frames)
+                LOGI("              at %s\n", frame.c_str());
+            if (!signature->frames.size())
+                LOGI("              <no stack>\n");
+        }
+    }
+}
+
+void ExceptionsCommand::DecodeFrames(art::mirror::Object& object, std::vector<std::string>& frames,
+                                     std::vector<std::string>& methods) {
+    java::lang::Throwable throwable = object;
+    java::lang::ObjectArray<java::lang::StackTraceElement>& stackTrace = throwable.getStackTrace();
+    if (!stackTrace.isNull() && stackTrace.length() > 0) {
+        int length = std::min(stackTrace.length(), options.depth);
+        for (int i = 0; i < length; i++) {
+            java::lang::StackTraceElement element = stackTrace[i];
+            frames.push_back(element.toString());
+            std::string method = element.getClassName().toString();
+            method.append(".").append(element.getMethodName().toString());
+            methods.push_back(method);
+        }
+        return;
+    }
+
+    // getStackTrace() never called, decode the native backtrace.
+    art::mirror::Object backtrace(throwable.GetObjectField("backtrace"), object);
+    if (backtrace.Ptr())
+        DecodeBacktrace(backtrace, options.depth, frames, methods);
+}
+
+void ExceptionsCommand::DecodeBacktrace(art::mirror::Object& backtrace, int depth, std::vector<std::string>& frames,
+                                        std::vector<std::string>& methods) {
+    // Object[] { PointerArray(methods..., dex_pcs...), classes... }
+    if (!backtrace.IsObjectArray())
+        return;
+
+    java::lang::ObjectArray<java::lang::Object> array = backtrace;
+    if (array.length() < 1)
+        return;
+
+    java::lang::Object first = array[0];
+    art::mirror::Object& pointers = first.thiz();
+    if (!pointers.Ptr())
+        return;
+
+    size_t size;
+    if (pointers.IsLongArray()) {
+        size = 8;
+    } else if (pointers.IsIntArray()) {
+        size = 4;
+    } else {
+        return;
+    }
+
+    art::mirror::Array trace = pointers;
+    int32_t count = trace.GetLength() / 2;
+    for (int32_t i = 0; i < count && i < depth; ++i) {
+        api::MemoryRef method_ref(trace.GetRawData(size, i), trace);
+        api::MemoryRef dex_pc_ref(trace.GetRawData(size, i + count), trace);
+        art::ArtMethod method = size == 8 ? method_ref.value64Of() : method_ref.value32Of();
+        uint64_t dex_pc = size == 8 ? dex_pc_ref.value64Of() : dex_pc_ref.value32Of();
+
+        std::string name;
+        try {
+            name.append(method.GetDeclaringClass().CachedDescriptor());
+            name.append(".").append(method.GetName());
+        } catch (InvalidAddressException& e) {
+            name = "<unknown>";
+        }
+        methods.push_back(name);
+        frames.push_back(name + "(dex_pc " + Utils::ToHex(dex_pc) + ")");
+    }
+}
+
+void ExceptionsCommand::usage() {
+    LOGI("Usage: exceptions [OPTION]\n");
+    LOGI("Option:\n");
+    LOGI("        --top             histogram of exception classes and stacks\n");
+    LOGI("    -n, --num <NUM>       show top exception classes (default 16)\n");
+    LOGI("    -s, --stacks <NUM>    show top stacks of each class (default 3)\n");
+    LOGI("    -d, --depth <NUM>     frames of a stack signature (default 8)\n");
+    ENTER();
+    LOGI("core-parser> exceptions\n");
+    LOGI("[0x12c3a0e8] java.io.FileNotFoundException: /data/user/0/penguin.opencore.tester/cache/a.tmp: open failed: ENOENT\n");
+    LOGI("    at libcore.io.IoBridge.open(IoBridge.java:574)\n");
+    LOGI("[0x12c3a1b0] java.lang.NumberFormatException: For input string: \"\"\n");
+    LOGI("    at java.lang.Integer.parseInt(dex_pc 0x1c)\n");
+    LOGI("...\n");
+    ENTER();
+    LOGI("core-parser> exceptions --top -n 2 -s 1 -d 3\n");
+    LOGI("     Count       Shallow  Stacks  Exception\n");
+    LOGI("      3125        156448          TOTAL\n");
+    LOGI("------------------------------------------------------------------\n");
+    LOGI("      3021        145008       2  java.lang.NumberFormatException\n");
+    LOGI("      3018  hash 0x5a3c1f2e  e.g. 0x12c3a1b0\n");
+    LOGI("              at java.lang.Integer.parseInt(dex_pc 0x1c)\n");
+    LOGI("              at java.lang.Integer.parseInt(dex_pc 0x2)\n");
+    LOGI("              at penguin.opencore.tester.MainActivity.parse(dex_pc 0x8)\n");
+    LOGI("        98          9408       1  java.io.FileNotFoundException\n");
+    LOGI("        98  hash 0x1b9e07d4  e.g. 0x12c3a0e8\n");
+    LOGI("              at libcore.io.IoBridge.open(IoBridge.java:574)\n");
+    LOGI("              at java.io.FileInputStream.<init>(FileInputStream.java:160)\n");
+    LOGI("              at penguin.opencore.tester.MainActivity.load(MainActivity.java:88)\n");
+}
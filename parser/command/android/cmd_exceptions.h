@@ -0,0 +1,75 @@
+/*
+ * Copyright (C) 2024-present, Guanyou.Chen. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef PARSER_COMMAND_ANDROID_CMD_EXCEPTIONS_H_
+#define PARSER_COMMAND_ANDROID_CMD_EXCEPTIONS_H_
+
+#include "command/command.h"
+#include "runtime/mirror/object.h"
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+class ExceptionsCommand : public Command {
+public:
+    ExceptionsCommand() : Command("exceptions") {}
+    ~ExceptionsCommand() {}
+
+    struct Options : Command::Options {
+        bool top;
+        int num;
+        int stacks;
+        int depth;
+    };
+
+    int main(int argc, char* const argv[]);
+    int prepare(int argc, char* const argv[]);
+    void usage();
+
+    class Signature {
+    public:
+        uint32_t hash;
+        uint64_t count;
+        uint32_t example;
+        std::vector<std::string> frames;
+    };
+
+    class Census {
+    public:
+        std::string descriptor;
+        uint64_t count;
+        uint64_t shallow_size;
+        // frame methods hash -> signature
+        std::unordered_map<uint32_t, Signature> signatures;
+    };
+
+    void ShowCensus(std::vector<Census>& census);
+    /*
+     * frames are shown as decoded, methods hold "Class.method" of every frame
+     * from either source, a signature must not change once getStackTrace()
+     * replaced the backtrace by StackTraceElements.
+     */
+    void DecodeFrames(art::mirror::Object& object, std::vector<std::string>& frames,
+                      std::vector<std::string>& methods);
+    static void DecodeBacktrace(art::mirror::Object& backtrace, int depth, std::vector<std::string>& frames,
+                                std::vector<std::string>& methods);
+private:
+    Options options;
+};
+
+#endif // PARSER_COMMAND_ANDROID_CMD_EXCEPTIONS_H_
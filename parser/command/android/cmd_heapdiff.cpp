@@ -0,0 +1,310 @@
+/*
+ * Copyright (C) 2024-present, Guanyou.Chen. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "logger/log.h"
+#include "runtime/mirror/class.h"
+#include "runtime/runtime.h"
+#include "runtime/gc/heap.h"
+#include "runtime/gc/space/space.h"
+#include "runtime/gc/space/large_object_space.h"
+#include "command/env.h"
+#include "command/android/cmd_heapdiff.h"
+#include "common/exception.h"
+#include "api/core.h"
+#include "android.h"
+#include "heap_walk.h"
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <getopt.h>
+#include <algorithm>
+#include <unordered_map>
+#include <string>
+#include <vector>
+
+int HeapDiffCommand::prepare(int argc, char* const argv[]) {
+    if (!CoreApi::IsReady()
+            || !Android::IsSdkReady()
+            || !(argc > 2))
+        return Command::FINISH;
+
+    options.num = 32;
+    options.news = 32;
+    options.order = ORDERBY_SHALLOW;
+
+    int opt;
+    int option_index = 0;
+    optind = 0; // reset
+    static struct option long_options[] = {
+        {"num",        required_argument, 0,  'n'},
+        {"new",        required_argument, 0,   1 },
+        {"alloc",      no_argument,       0,  'a'},
+        {"shallow",    no_argument,       0,  's'},
+        {0,            0,                 0,   0 },
+    };
+
+    while ((opt = getopt_long(argc, argv, "n:as",
+                long_options, &option_index)) != -1) {
+        switch (opt) {
+            case 'n':
+                options.num = std::atoi(optarg);
+                break;
+            case 1:
+                options.news = std::atoi(optarg);
+                break;
+            case 'a':
+                options.order = ORDERBY_ALLOC;
+                break;
+            case 's':
+                options.order = ORDERBY_SHALLOW;
+                break;
+        }
+    }
+    options.optind = optind;
+
+    if (argc - options.optind < 2) {
+        usage();
+        return Command::FINISH;
+    }
+
+    int slots[2];
+    for (int i = 0; i < 2; ++i) {
+        const char* arg = argv[options.optind + i];
+        char* end = nullptr;
+        long idx = strtol(arg, &end, 10);
+        if (end == arg || *end != '\0' || idx < 0 || idx >= Env::NumSlots()) {
+            LOGE("Invalid core index %s, see \"core list\".\n", arg);
+            return Command::FINISH;
+        }
+        slots[i] = idx;
+    }
+    options.from = slots[0];
+    options.to = slots[1];
+
+    if (options.from == options.to) {
+        LOGE("Invalid core index %d %d, see \"core list\".\n", options.from, options.to);
+        return Command::FINISH;
+    }
+
+    Android::Prepare();
+    return Command::ONCHLD;
+}
+
+int HeapDiffCommand::main(int argc, char* const argv[]) {
+    int origin = Env::CurrentSlot();
+
+    // classes are matched by descriptor, class objects may move between cores
+    std::unordered_map<std::string, uint32_t> names;
+    std::vector<std::string> descriptors;
+    std::vector<HeapDiffCommand::Pair> before;
+    std::vector<HeapDiffCommand::Pair> after;
+    std::vector<uint64_t> news_count;
+    std::unordered_map<uint64_t, uint32_t> klasses;
+    std::unordered_map<uint64_t, uint32_t> objects;
+    std::vector<std::pair<uint64_t, uint32_t>> news;
+    // region and bump pointer objects move between cores, only the spaces
+    // that never move them are matched by address.
+    std::vector<std::pair<uint64_t, uint64_t>> stables;
+
+    auto index_of = [&](art::mirror::Class& thiz) -> uint32_t {
+        auto it = klasses.find(thiz.Ptr());
+        if (it != klasses.end())
+            return it->second;
+
+        const std::string& descriptor = thiz.CachedDescriptor();
+        uint32_t idx;
+        auto nt = names.find(descriptor);
+        if (nt == names.end()) {
+            idx = descriptors.size();
+            names[descriptor] = idx;
+            descriptors.push_back(descriptor);
+            before.push_back({0, 0});
+            after.push_back({0, 0});
+            news_count.push_back(0);
+        } else {
+            idx = nt->second;
+        }
+        klasses[thiz.Ptr()] = idx;
+        return idx;
+    };
+
+    auto collect_stables = [&]() {
+        stables.clear();
+        art::gc::Heap& heap = art::Runtime::Current().GetHeap();
+        for (const auto& space : heap.GetContinuousSpaces()) {
+            art::gc::space::ContinuousSpace* sp = space.get();
+            if (sp->IsImageSpace() || sp->IsZygoteSpace()
+                    || (sp->IsMallocSpace() && strstr(sp->GetName(), "non moving")))
+                stables.push_back(std::pair<uint64_t, uint64_t>(sp->Begin(), sp->End()));
+        }
+        for (const auto& space : heap.GetDiscontinuousSpaces()) {
+            if (!space->IsLargeObjectSpace())
+                continue;
+            art::gc::space::LargeObjectSpace* sp = reinterpret_cast<art::gc::space::LargeObjectSpace *>(space.get());
+            stables.push_back(std::pair<uint64_t, uint64_t>(sp->Begin(), sp->End()));
+        }
+    };
+
+    auto is_stable = [&](uint64_t addr) -> bool {
+        for (const auto& range : stables) {
+            if (addr >= range.first && addr < range.second)
+                return true;
+        }
+        return false;
+    };
+
+    auto before_callback = [&](art::mirror::Object& object) -> bool {
+        if (object.IsClass())
+            return false;
+
+        art::mirror::Class thiz = object.GetClass();
+        uint32_t idx = index_of(thiz);
+        before[idx].alloc_count += 1;
+        before[idx].shallow_size += object.SizeOf();
+        if (is_stable(object.Ptr()))
+            objects[object.Ptr()] = idx;
+        return false;
+    };
+
+    auto after_callback = [&](art::mirror::Object& object) -> bool {
+        if (object.IsClass())
+            return false;
+
+        art::mirror::Class thiz = object.GetClass();
+        uint32_t idx = index_of(thiz);
+        after[idx].alloc_count += 1;
+        after[idx].shallow_size += object.SizeOf();
+        if (!is_stable(object.Ptr()))
+            return false;
+
+        auto it = objects.find(object.Ptr());
+        if (it == objects.end() || it->second != idx) {
+            news_count[idx] += 1;
+            if (news.size() < options.news)
+                news.push_back(std::pair<uint64_t, uint32_t>(object.Ptr(), idx));
+        }
+        return false;
+    };
+
+    auto walk = [&](int slot, auto& callback) {
+        if (!Env::SwitchSlot(slot))
+            return;
+
+        klasses.clear();
+        if (!Android::IsSdkReady()) {
+            LOGE("core(%d) android env not ready.\n", slot);
+            return;
+        }
+        try {
+            Android::Prepare();
+            collect_stables();
+            Android::ForEachObject(callback);
+        } catch(InvalidAddressException& e) {
+            LOGW("The statistical process of core(%d) was interrupted!\n", slot);
+        }
+    };
+
+    walk(options.from, before_callback);
+    walk(options.to, after_callback);
+    objects.clear();
+    Env::SwitchSlot(origin);
+
+    std::vector<uint32_t> changes;
+    HeapDiffCommand::Pair total_before = {0, 0};
+    HeapDiffCommand::Pair total_after = {0, 0};
+    uint64_t total_news = 0;
+    for (uint32_t idx = 0; idx < descriptors.size(); ++idx) {
+        total_before.alloc_count += before[idx].alloc_count;
+        total_before.shallow_size += before[idx].shallow_size;
+        total_after.alloc_count += after[idx].alloc_count;
+        total_after.shallow_size += after[idx].shallow_size;
+        total_news += news_count[idx];
+
+        if (before[idx].alloc_count != after[idx].alloc_count
+                || before[idx].shallow_size != after[idx].shallow_size
+                || news_count[idx])
+            changes.push_back(idx);
+    }
+
+    auto alloc_delta = [&](uint32_t idx) -> int64_t {
+        return after[idx].alloc_count - before[idx].alloc_count;
+    };
+    auto shallow_delta = [&](uint32_t idx) -> int64_t {
+        return after[idx].shallow_size - before[idx].shallow_size;
+    };
+    auto compare = [&](uint32_t a, uint32_t b) -> bool {
+        int64_t da = options.order == ORDERBY_ALLOC ? alloc_delta(a) : shallow_delta(a);
+        int64_t db = options.order == ORDERBY_ALLOC ? alloc_delta(b) : shallow_delta(b);
+        return std::abs(da) > std::abs(db);
+    };
+    uint32_t num = std::min<uint32_t>(options.num, changes.size());
+    std::partial_sort(changes.begin(), changes.begin() + num, changes.end(), compare);
+
+    LOGI(ANSI_COLOR_LIGHTRED "  Count(%d)   Count(%d)        Delta     Shallow(%d)     Shallow(%d)          Delta        New  ClassName\n" ANSI_COLOR_RESET,
+         options.from, options.to, options.from, options.to);
+    LOGI("%10" PRId64 "  %10" PRId64 "  " ANSI_COLOR_LIGHTMAGENTA "%+11" PRId64 "" ANSI_COLOR_RESET "  %14" PRId64 "  %14" PRId64 "  " ANSI_COLOR_LIGHTBLUE "%+13" PRId64 "" ANSI_COLOR_RESET "  " ANSI_COLOR_LIGHTGREEN "%9" PRId64 "" ANSI_COLOR_RESET "  TOTAL\n",
+         total_before.alloc_count, total_after.alloc_count,
+         (int64_t)(total_after.alloc_count - total_before.alloc_count),
+         total_before.shallow_size, total_after.shallow_size,
+         (int64_t)(total_after.shallow_size - total_before.shallow_size), total_news);
+    LOGI("------------------------------------------------------------------------------------------------------\n");
+    for (uint32_t i = 0; i < num; ++i) {
+        uint32_t idx = changes[i];
+        LOGI("%10" PRId64 "  %10" PRId64 "  " ANSI_COLOR_LIGHTMAGENTA "%+11" PRId64 "" ANSI_COLOR_RESET "  %14" PRId64 "  %14" PRId64 "  " ANSI_COLOR_LIGHTBLUE "%+13" PRId64 "" ANSI_COLOR_RESET "  " ANSI_COLOR_LIGHTGREEN "%9" PRId64 "" ANSI_COLOR_RESET "  " ANSI_COLOR_LIGHTCYAN "%s\n" ANSI_COLOR_RESET,
+             before[idx].alloc_count, after[idx].alloc_count, alloc_delta(idx),
+             before[idx].shallow_size, after[idx].shallow_size, shallow_delta(idx),
+             news_count[idx], descriptors[idx].c_str());
+    }
+    LOGI("New only matches image, zygote, non moving and large object spaces, moving spaces compare by count and size.\n");
+
+    if (news.size()) {
+        ENTER();
+        LOGI(ANSI_COLOR_LIGHTRED "New objects in core(%d):\n" ANSI_COLOR_RESET, options.to);
+        for (const auto& value : news) {
+            LOGI(ANSI_COLOR_LIGHTYELLOW "0x%08" PRIx64 "" ANSI_COLOR_RESET "  " ANSI_COLOR_LIGHTCYAN "%s\n" ANSI_COLOR_RESET,
+                 value.first, descriptors[value.second].c_str());
+        }
+        if (total_news > news.size())
+            LOGI("... %" PRId64 " more\n", total_news - news.size());
+    }
+    return 0;
+}
+
+void HeapDiffCommand::usage() {
+    LOGI("Usage: heapdiff <CORE_A> <CORE_B> [OPTION]\n");
+    LOGI("Option:\n");
+    LOGI("    -n, --num <NUM>     show top classes by delta (default 32)\n");
+    LOGI("        --new <NUM>     show objects only in CORE_B (default 32)\n");
+    LOGI("    -a, --alloc         order by allocation count delta\n");
+    LOGI("    -s, --shallow       order by shallow size delta (default)\n");
+    ENTER();
+    LOGI("core-parser> core list\n");
+    LOGI("  0   /tmp/app_0.core\n");
+    LOGI("* 1   /tmp/app_1.core\n");
+    LOGI("core-parser> heapdiff 0 1 -n 3 --new 2\n");
+    LOGI("  Count(0)   Count(1)        Delta     Shallow(0)     Shallow(1)          Delta        New  ClassName\n");
+    LOGI("    419512      433261       +13749       31049168       32198216       +1149048        498  TOTAL\n");
+    LOGI("------------------------------------------------------------------------------------------------------\n");
+    LOGI("      1024        9216        +8192          32768         884736        +851968          0  android.graphics.Bitmap\n");
+    LOGI("     31602       34170        +2568        1516896        1640160        +123264          0  java.lang.String\n");
+    LOGI("      6130        6612         +482         294240         317376         +23136        490  byte[]\n");
+    LOGI("New only matches image, zygote, non moving and large object spaces, moving spaces compare by count and size.\n");
+    ENTER();
+    LOGI("New objects in core(1):\n");
+    LOGI("0x71a2c000  byte[]\n");
+    LOGI("0x71a6e000  byte[]\n");
+    LOGI("... 496 more\n");
+}
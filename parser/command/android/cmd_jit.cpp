@@ -0,0 +1,227 @@
+/*
+ * Copyright (C) 2024-present, Guanyou.Chen. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "logger/log.h"
+#include "api/core.h"
+#include "api/thread.h"
+#include "common/exception.h"
+#include "command/android/cmd_jit.h"
+#include "android.h"
+#include "runtime/runtime.h"
+#include "runtime/jit/jit.h"
+#include "runtime/art_method.h"
+#include <string.h>
+#include <unistd.h>
+#include <getopt.h>
+#include <algorithm>
+#include <memory>
+
+int JitCommand::prepare(int argc, char* const argv[]) {
+    if (!CoreApi::IsReady() || !Android::IsSdkReady())
+        return Command::FINISH;
+
+    options.perfmap = nullptr;
+    options.jitdump = nullptr;
+
+    int opt;
+    int option_index = 0;
+    optind = 0; // reset
+    static struct option long_options[] = {
+        {"export-perfmap",  required_argument, 0,  1 },
+        {"export-jitdump",  required_argument, 0,  2 },
+        {0,                 0,                 0,  0 },
+    };
+
+    while ((opt = getopt_long(argc, argv, "",
+                long_options, &option_index)) != -1) {
+        switch (opt) {
+            case 1:
+                options.perfmap = optarg;
+                break;
+            case 2:
+                options.jitdump = optarg;
+                break;
+        }
+    }
+    options.optind = optind;
+
+    Android::Prepare();
+    return Command::ONCHLD;
+}
+
+int JitCommand::main(int argc, char* const argv[]) {
+    art::Runtime& runtime = art::Runtime::Current();
+    art::jit::Jit& jit = runtime.GetJit();
+    if (!jit.Ptr()) {
+        LOGE("Not found jit.\n");
+        return 0;
+    }
+
+    art::jit::JitCodeCache& code_cache = jit.GetCodeCache();
+    std::vector<art::jit::JitCodeCache::CodeEntry>& entries = code_cache.GetCodeEntries();
+
+    if (!options.perfmap && !options.jitdump) {
+        ShowCodeEntries(entries);
+        return 0;
+    }
+
+    // symbol names go to files, keep them plain.
+    bool light = Logger::IsLight();
+    Logger::SetHighLight(false);
+    if (options.perfmap)
+        ExportPerfMap(entries);
+    if (options.jitdump)
+        ExportJitDump(entries);
+    Logger::SetHighLight(light);
+    return 0;
+}
+
+void JitCommand::ShowCodeEntries(std::vector<art::jit::JitCodeCache::CodeEntry>& entries) {
+    LOGI(ANSI_COLOR_LIGHTRED "CODE              SIZE      TYPE      ART_METHOD    METHOD\n" ANSI_COLOR_RESET);
+    for (auto& entry : entries) {
+        LOGI(ANSI_COLOR_LIGHTYELLOW "0x%-14" PRIx64 "" ANSI_COLOR_RESET "  0x%-6" PRIx64 "  %-8s  0x%-10" PRIx64 "  %s\n",
+             entry.code_start, entry.code_size, TypeToString(entry.type),
+             entry.method, PrettyEntryName(entry).c_str());
+    }
+}
+
+void JitCommand::ExportPerfMap(std::vector<art::jit::JitCodeCache::CodeEntry>& entries) {
+    FILE* fp = fopen(options.perfmap, "w");
+    if (!fp) {
+        LOGE("Can't open %s\n", options.perfmap);
+        return;
+    }
+
+    uint32_t count = 0;
+    for (auto& entry : entries) {
+        if (!entry.code_size)
+            continue;
+        fprintf(fp, "%" PRIx64 " %" PRIx64 " %s\n",
+                entry.code_start, entry.code_size, PrettyEntryName(entry).c_str());
+        count++;
+    }
+    fclose(fp);
+    LOGI("Saved [%s] %u symbols.\n", options.perfmap, count);
+}
+
+void JitCommand::ExportJitDump(std::vector<art::jit::JitCodeCache::CodeEntry>& entries) {
+    FILE* fp = fopen(options.jitdump, "wb");
+    if (!fp) {
+        LOGE("Can't open %s\n", options.jitdump);
+        return;
+    }
+
+    uint32_t pid = CoreApi::GetPid();
+
+    WriteJitDumpHeader(fp, CoreApi::GetMachine(), pid);
+
+    uint32_t count = 0;
+    for (auto& entry : entries) {
+        if (!entry.code_size)
+            continue;
+
+        // Read stops at the block end, only the bytes really copied go out.
+        LoadBlock* block = CoreApi::FindLoadBlock(entry.code_start, false);
+        if (!block)
+            continue;
+        uint64_t code_size = std::min<uint64_t>(entry.code_size,
+                block->vaddr() + block->size() - entry.code_start);
+        std::unique_ptr<uint8_t[]> code(new uint8_t[code_size]);
+        if (!CoreApi::Read(entry.code_start, code_size, code.get())) {
+            LOGD("Read jit code 0x%" PRIx64 " fail.\n", entry.code_start);
+            continue;
+        }
+        if (code_size < entry.code_size)
+            LOGD("Jit code 0x%" PRIx64 " truncated to 0x%" PRIx64 ".\n", entry.code_start, code_size);
+
+        std::string name = PrettyEntryName(entry);
+        WriteJitDumpCodeLoad(fp, pid, entry.code_start, name, code.get(), code_size, count);
+        count++;
+    }
+    fclose(fp);
+    LOGI("Saved [%s] %u code loads.\n", options.jitdump, count);
+}
+
+void JitCommand::WriteJitDumpHeader(FILE* fp, uint32_t elf_mach, uint32_t pid) {
+    // the core has no clock of the code loads, timestamp 0 makes every
+    // record visible from the start of a perf session.
+    JitDumpHeader header;
+    memset(&header, 0x0, sizeof(JitDumpHeader));
+    header.magic = JITDUMP_MAGIC;
+    header.version = JITDUMP_VERSION;
+    header.total_size = sizeof(JitDumpHeader);
+    header.elf_mach = elf_mach;
+    header.pid = pid;
+    fwrite(&header, sizeof(JitDumpHeader), 1, fp);
+}
+
+void JitCommand::WriteJitDumpCodeLoad(FILE* fp, uint32_t pid, uint64_t code_start, std::string& name,
+                                      uint8_t* code, uint64_t code_size, uint64_t index) {
+    JitDumpCodeLoad record;
+    memset(&record, 0x0, sizeof(JitDumpCodeLoad));
+    record.id = JIT_CODE_LOAD;
+    record.total_size = sizeof(JitDumpCodeLoad) + name.length() + 1 + code_size;
+    record.pid = pid;
+    record.tid = pid;
+    record.vma = code_start;
+    record.code_addr = code_start;
+    record.code_size = code_size;
+    record.code_index = index;
+    fwrite(&record, sizeof(JitDumpCodeLoad), 1, fp);
+    fwrite(name.c_str(), name.length() + 1, 1, fp);
+    fwrite(code, code_size, 1, fp);
+}
+
+std::string JitCommand::PrettyEntryName(art::jit::JitCodeCache::CodeEntry& entry) {
+    if (!entry.method)
+        return "<unknown>";
+
+    art::ArtMethod method = entry.method;
+    std::string name;
+    try {
+        name = method.ColorPrettyMethod();
+    } catch (InvalidAddressException& e) {}
+    if (name.empty())
+        return "<unknown>";
+    return name;
+}
+
+const char* JitCommand::TypeToString(int type) {
+    switch (type) {
+        case art::jit::JitCodeCache::CODE_METHOD: return "METHOD";
+        case art::jit::JitCodeCache::CODE_JNI_STUB: return "JNI_STUB";
+        case art::jit::JitCodeCache::CODE_ZYGOTE: return "ZYGOTE";
+    }
+    return "UNKNOWN";
+}
+
+void JitCommand::usage() {
+    LOGI("Usage: jit [OPTION]\n");
+    LOGI("Option:\n");
+    LOGI("        --export-perfmap <FILE>  write jit symbols as perf-<pid>.map lines\n");
+    LOGI("        --export-jitdump <FILE>  write jit symbols and code as perf jitdump\n");
+    ENTER();
+    LOGI("core-parser> jit\n");
+    LOGI("CODE              SIZE      TYPE      ART_METHOD    METHOD\n");
+    LOGI("0x7a3f1200        0x184     METHOD    0x7b21c3a0    void android.os.Looper.loop()\n");
+    LOGI("0x7a3f1400        0x60      JNI_STUB  0x7b1f0a18    long android.os.SystemClock.uptimeMillis()\n");
+    LOGI("...\n");
+    ENTER();
+    LOGI("core-parser> jit --export-perfmap /tmp/perf-7523.map --export-jitdump /tmp/jit-7523.dump\n");
+    LOGI("Saved [/tmp/perf-7523.map] 1532 symbols.\n");
+    LOGI("Saved [/tmp/jit-7523.dump] 1532 code loads.\n");
+}
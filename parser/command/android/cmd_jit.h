@@ -0,0 +1,82 @@
+/*
+ * Copyright (C) 2024-present, Guanyou.Chen. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef PARSER_COMMAND_ANDROID_CMD_JIT_H_
+#define PARSER_COMMAND_ANDROID_CMD_JIT_H_
+
+#include "command/command.h"
+#include "runtime/jit/jit_code_cache.h"
+#include <stdio.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+class JitCommand : public Command {
+public:
+    // perf jitdump format, tools/perf/Documentation/jitdump-specification.txt
+    static constexpr uint32_t JITDUMP_MAGIC = 0x4A695444;
+    static constexpr uint32_t JITDUMP_VERSION = 1;
+    static constexpr uint32_t JIT_CODE_LOAD = 0;
+
+    struct JitDumpHeader {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t total_size;
+        uint32_t elf_mach;
+        uint32_t pad1;
+        uint32_t pid;
+        uint64_t timestamp;
+        uint64_t flags;
+    };
+
+    struct JitDumpCodeLoad {
+        uint32_t id;
+        uint32_t total_size;
+        uint64_t timestamp;
+        uint32_t pid;
+        uint32_t tid;
+        uint64_t vma;
+        uint64_t code_addr;
+        uint64_t code_size;
+        uint64_t code_index;
+    };
+
+    JitCommand() : Command("jit") {}
+    ~JitCommand() {}
+
+    struct Options : Command::Options {
+        char* perfmap;
+        char* jitdump;
+    };
+
+    int main(int argc, char* const argv[]);
+    int prepare(int argc, char* const argv[]);
+    void usage();
+    void ShowCodeEntries(std::vector<art::jit::JitCodeCache::CodeEntry>& entries);
+    void ExportPerfMap(std::vector<art::jit::JitCodeCache::CodeEntry>& entries);
+    void ExportJitDump(std::vector<art::jit::JitCodeCache::CodeEntry>& entries);
+    static void WriteJitDumpHeader(FILE* fp, uint32_t elf_mach, uint32_t pid);
+    // record, then the NUL terminated name, then code_size bytes of code.
+    static void WriteJitDumpCodeLoad(FILE* fp, uint32_t pid, uint64_t code_start, std::string& name,
+                                     uint8_t* code, uint64_t code_size, uint64_t index);
+    static std::string PrettyEntryName(art::jit::JitCodeCache::CodeEntry& entry);
+    static const char* TypeToString(int type);
+private:
+    Options options;
+};
+
+#endif // PARSER_COMMAND_ANDROID_CMD_JIT_H_
@@ -20,11 +20,14 @@
 #include "command/core/backtrace/cmd_frame.h"
 #include "command/command_manager.h"
 #include "base/utils.h"
+#include "common/exception.h"
 #include "dalvik_vm_bytecode.h"
 #include "dexdump/dexdump.h"
 #include "runtime/oat.h"
 #include "runtime/oat/stack_map.h"
 #include "runtime/nterp_helpers.h"
+#include "runtime/dex_pc_index.h"
+#include "runtime/method_index.h"
 #include "runtime/interpreter/quick_frame.h"
 #include "common/disassemble/capstone.h"
 #include "common/elf.h"
@@ -32,6 +35,7 @@
 #include <getopt.h>
 #include <iomanip>
 #include <stdlib.h>
+#include <regex>
 
 int MethodCommand::prepare(int argc, char* const argv[]) {
     if (!CoreApi::IsReady()
@@ -45,6 +49,9 @@ int MethodCommand::prepare(int argc, char* const argv[]) {
     options.count = 0;
     options.pc = 0x0;
     options.dexpc = 0x0;
+    options.find = nullptr;
+    options.find_idx = -1;
+    options.threads = 0;
 
     int opt;
     int option_index = 0;
@@ -58,10 +65,13 @@ int MethodCommand::prepare(int argc, char* const argv[]) {
         {"verbose",     no_argument,       0, 'v'},
         {"binary",      no_argument,       0, 'b'},
         {"search",      required_argument, 0, 's'},
+        {"find",        required_argument, 0,  4 },
+        {"find-idx",    required_argument, 0,  5 },
+        {"threads",     required_argument, 0, 't'},
         {0,             0,                 0,  0 },
     };
 
-    while ((opt = getopt_long(argc, argv, "i:n:012bvs:",
+    while ((opt = getopt_long(argc, argv, "i:n:012bvs:t:",
                 long_options, &option_index)) != -1) {
         switch (opt) {
             case 'i':
@@ -88,10 +98,25 @@ int MethodCommand::prepare(int argc, char* const argv[]) {
             case 's':
                 options.dexpc = Utils::atol(optarg);
                 break;
+            case 4:
+                options.find = optarg;
+                break;
+            case 5:
+                options.find_idx = std::atoi(optarg);
+                break;
+            case 't':
+                options.threads = std::atoi(optarg);
+                break;
         }
     }
     options.optind = optind;
 
+    if (options.find || options.find_idx >= 0) {
+        Android::Prepare();
+        art::MethodIndex::Prepare(options.threads);
+        return Command::ONCHLD;
+    }
+
     if (options.optind >= argc && !options.dexpc) {
         usage();
         return Command::FINISH;
@@ -100,46 +125,30 @@ int MethodCommand::prepare(int argc, char* const argv[]) {
     if (options.dump_opt & METHOD_DUMP_OATCODE)
         Android::OatPrepare();
 
-    if (options.dexpc)
+    if (options.dexpc) {
         Android::Prepare();
+        art::DexPcIndex::Prepare();
+    }
 
     return Command::ONCHLD;
 }
 
 int MethodCommand::main(int argc, char* const argv[]) {
+    if (options.find || options.find_idx >= 0) {
+        Find();
+        return 0;
+    }
+
     art::ArtMethod method = 0x0;
     if (!options.dexpc) {
         method = Utils::atol(argv[options.optind]) & CoreApi::GetVabitsMask();
     } else {
-        bool found = false;
-        auto search_method = [&](art::ArtMethod& tmp) -> bool {
-            art::dex::CodeItem item = tmp.GetCodeItem();
-            art::DexFile& dex_file = tmp.GetDexFile();
-            if (item.Ptr()) {
-                uint64_t start = item.Ptr() + item.code_offset_;
-                uint64_t end = start + (item.insns_count_ << 1);
-                if (options.dexpc >= start && options.dexpc < end) {
-                    found = true;
-                    method = tmp;
-                    LOGI(ANSI_COLOR_LIGHTYELLOW "[0x%" PRIx64 "]\n" ANSI_COLOR_RESET, method.Ptr());
-                }
-            }
-            return found;
-        };
-
-        auto callback = [&](art::mirror::Object& object) -> bool {
-            if (!object.IsClass())
-                return false;
-
-            art::mirror::Class current = object;
-            Android::ForeachArtMethods(current, search_method);
-            return found;
-        };
-        Android::ForeachObjects(callback);
-        if (!found) {
+        method = art::DexPcIndex::Lookup(options.dexpc);
+        if (!method.Ptr()) {
             LOGE("Not found ArtMethod include dexpc 0x%" PRIx64 "\n", options.dexpc);
             return 0;
         }
+        LOGI(ANSI_COLOR_LIGHTYELLOW "[0x%" PRIx64 "]\n" ANSI_COLOR_RESET, method.Ptr());
     }
 
     uint32_t dex_method_idx = method.GetDexMethodIndex();
@@ -161,6 +170,39 @@ int MethodCommand::main(int argc, char* const argv[]) {
     return 0;
 }
 
+void MethodCommand::Find() {
+    art::MethodIndex::Prepare(options.threads);
+    if (!art::MethodIndex::IsReady()) {
+        LOGE("MethodIndex unavailable.\n");
+        return;
+    }
+
+    uint32_t count = 0;
+    auto callback = [&](art::MethodIndex::Entry& entry) -> bool {
+        art::ArtMethod method = entry.method;
+        std::string flags;
+        try {
+            flags = art::PrettyJavaAccessFlags(method.access_flags());
+        } catch (InvalidAddressException& e) {}
+        LOGI(ANSI_COLOR_LIGHTYELLOW "[0x%" PRIx64 "]" ANSI_COLOR_RESET " %-11s 0x%" PRIx64 "  " ANSI_COLOR_LIGHTGREEN "%s" ANSI_COLOR_LIGHTRED "%s" ANSI_COLOR_RESET " [dex_method_idx=%d]\n",
+             entry.method, art::MethodIndex::CodeToString(entry.code), entry.entry_point,
+             flags.c_str(), entry.name.c_str(), entry.dex_method_idx);
+        ++count;
+        return false;
+    };
+
+    try {
+        if (options.find)
+            art::MethodIndex::FindByRegex(options.find, callback);
+        else
+            art::MethodIndex::FindByDexMethodIndex(options.find_idx, callback);
+    } catch (std::regex_error& e) {
+        LOGE("Invalid regex \"%s\".\n", options.find);
+        return;
+    }
+    LOGI("Found %d of %d methods.\n", count, art::MethodIndex::Size());
+}
+
 void MethodCommand::Dexdump(art::ArtMethod& method) {
     art::dex::CodeItem item = method.GetCodeItem();
     art::DexFile& dex_file = method.GetDexFile();
@@ -295,7 +337,7 @@ void MethodCommand::Binarydump(art::ArtMethod& method) {
 }
 
 void MethodCommand::usage() {
-    LOGI("Usage: method [<ART_METHOD>|-s, --search <DEXPC>] [OPTIONE...]\n");
+    LOGI("Usage: method [<ART_METHOD>|-s, --search <DEXPC>|--find <REGEX>] [OPTIONE...]\n");
     LOGI("Option:\n");
     LOGI("    --dex-dump            show dalvik byte codes\n");
     LOGI("    -i, --inst <PC>       only dex-dump, show instpc byte code\n");
@@ -305,6 +347,9 @@ void MethodCommand::usage() {
     LOGI("    -b, --binary          show ArtMethod memory\n");
     LOGI("    -v, --verbaose        show more info\n");
     LOGI("    -s, --search <dexpc>  search all ArtMethod include that dexpc\n");
+    LOGI("        --find <REGEX>    find methods whose pretty name matches\n");
+    LOGI("        --find-idx <IDX>  find methods by dex_method_idx\n");
+    LOGI("    -t, --threads <NUM>   only find, index threads (default hardware concurrency)\n");
     ENTER();
     LOGI("core-parser> method 0x70b509c0 -v --dex-dump --oat-dump\n");
     LOGI("public static void com.android.internal.os.ZygoteInit.main(java.lang.String[]) [dex_method_idx=49967]\n");
@@ -364,4 +409,9 @@ void MethodCommand::usage() {
     LOGI("public static void android.os.Looper.loop() [dex_method_idx=9185]\n");
     LOGI("DEX CODE:\n");
     LOGI("  0x786c528044a8: 4071 23e2 3210           | invoke-static {v0, v1, v2, v3}, boolean android.os.Looper.loopOnce(android.os.Looper, long, int) // method@9186\n");
+    ENTER();
+    LOGI("core-parser> method --find \"android.os.Looper.loop\"\n");
+    LOGI("[0x6fe055e8] OAT         0x71a6c0f0  public static void android.os.Looper.loop() [dex_method_idx=9185]\n");
+    LOGI("[0x6fe05610] JIT         0x7a3f1200  private static boolean android.os.Looper.loopOnce(android.os.Looper, long, int) [dex_method_idx=9186]\n");
+    LOGI("Found 2 of 412870 methods.\n");
 }
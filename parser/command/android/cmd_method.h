@@ -38,6 +38,9 @@ public:
         uint64_t pc;
         uint64_t dexpc;
         uint64_t instpc;
+        const char* find;
+        int64_t find_idx;
+        int threads;
     };
 
     int main(int argc, char* const argv[]);
@@ -45,6 +48,7 @@ public:
     void Dexdump(art::ArtMethod& method);
     void Oatdump(art::ArtMethod& method);
     void Binarydump(art::ArtMethod& method);
+    void Find();
     void usage();
 private:
     Options options;
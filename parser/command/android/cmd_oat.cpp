@@ -0,0 +1,249 @@
+/*
+ * Copyright (C) 2024-present, Guanyou.Chen. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "logger/log.h"
+#include "api/core.h"
+#include "base/utils.h"
+#include "command/env.h"
+#include "command/android/cmd_oat.h"
+#include <string.h>
+#include <unistd.h>
+#include <getopt.h>
+#include <algorithm>
+#include <atomic>
+#include <filesystem>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+int OatCommand::prepare(int argc, char* const argv[]) {
+    if (!CoreApi::IsReady())
+        return Command::FINISH;
+
+    options.dir = nullptr;
+    options.all = false;
+    options.threads = 0;
+
+    int opt;
+    int option_index = 0;
+    optind = 0; // reset
+    static struct option long_options[] = {
+        {"extract",  required_argument, 0,   1 },
+        {"all",      no_argument,       0,  'a'},
+        {"threads",  required_argument, 0,  't'},
+        {0,          0,                 0,   0 },
+    };
+
+    while ((opt = getopt_long(argc, argv, "at:",
+                long_options, &option_index)) != -1) {
+        switch (opt) {
+            case 1:
+                options.dir = optarg;
+                break;
+            case 'a':
+                options.all = true;
+                break;
+            case 't':
+                options.threads = std::atoi(optarg);
+                break;
+        }
+    }
+    options.optind = optind;
+    return Command::ONCHLD;
+}
+
+int OatCommand::main(int argc, char* const argv[]) {
+    if (!options.dir) {
+        ShowOatBlocks();
+        return 0;
+    }
+
+    std::error_code ec;
+    std::filesystem::create_directories(options.dir, ec);
+    if (ec) {
+        LOGE("Can't create %s: %s\n", options.dir, ec.message().c_str());
+        return 0;
+    }
+
+    std::string output = options.dir;
+    output.append("/index.txt");
+    FILE* index = fopen(output.c_str(), "w");
+    if (!index) {
+        LOGE("Can't open %s\n", output.c_str());
+        return 0;
+    }
+    fprintf(index, "CORE  REGION                            SIZE        CRC32       FILE  NAME\n");
+
+    // checksum -> extracted file, shared by all cores of the batch.
+    std::unordered_map<std::string, std::string> files;
+    if (options.all) {
+        int origin = Env::CurrentSlot();
+        for (int slot = 0; slot < Env::NumSlots(); ++slot) {
+            if (!Env::SwitchSlot(slot) || !CoreApi::IsReady())
+                continue;
+            Extract(slot, files, index);
+        }
+        Env::SwitchSlot(origin);
+    } else {
+        Extract(Env::CurrentSlot(), files, index);
+    }
+
+    fclose(index);
+    LOGI("Saved [%s].\n", output.c_str());
+    return 0;
+}
+
+void OatCommand::ShowOatBlocks() {
+    LOGI(ANSI_COLOR_LIGHTRED "REGION                            FLAGS  SIZE        NAME\n" ANSI_COLOR_RESET);
+    auto callback = [&](LoadBlock* block) -> bool {
+        if (!IsOatBlock(block))
+            return false;
+
+        LOGI(ANSI_COLOR_CYAN "[%" PRIx64 ", %" PRIx64 ")" ANSI_COLOR_RESET "  %s    %010" PRIx64 "  " ANSI_COLOR_GREEN "%s" ANSI_COLOR_RESET " %s\n",
+             block->vaddr(), block->vaddr() + block->memsz(), block->convertFlags().c_str(),
+             block->size(), block->name().c_str(), block->convertValids().c_str());
+        return false;
+    };
+    CoreApi::ForeachLoadBlock(callback, false, false);
+}
+
+void OatCommand::Extract(int slot, std::unordered_map<std::string, std::string>& files, FILE* index) {
+    std::vector<ExtractTask> tasks;
+    auto callback = [&](LoadBlock* block) -> bool {
+        if (!IsOatBlock(block) || !block->size(LoadBlock::OPT_READ_OR))
+            return false;
+
+        ExtractTask task;
+        task.slot = slot;
+        task.block = block;
+        task.name = block->name();
+        task.crc32 = 0;
+        task.dup = false;
+        task.saved = false;
+        tasks.push_back(std::move(task));
+        return false;
+    };
+    CoreApi::ForeachLoadBlock(callback, true, false);
+
+    std::vector<uint32_t> order(tasks.size());
+    for (uint32_t i = 0; i < order.size(); ++i) order[i] = i;
+    std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+        return tasks[a].block->size(LoadBlock::OPT_READ_OR) > tasks[b].block->size(LoadBlock::OPT_READ_OR);
+    });
+
+    int nthreads = options.threads > 0 ? options.threads : std::thread::hardware_concurrency();
+    nthreads = std::max(1, std::min<int>(nthreads, tasks.size()));
+
+    // the first range of a checksum claims the file, others only reference it.
+    std::mutex lock;
+    std::atomic<uint32_t> next(0);
+    auto worker = [&]() {
+        uint32_t i;
+        while ((i = next.fetch_add(1)) < order.size()) {
+            ExtractTask& task = tasks[order[i]];
+            // the core's own bytes, never the sysroot file mapped over them.
+            uint8_t* data = reinterpret_cast<uint8_t *>(task.block->begin(LoadBlock::OPT_READ_OR));
+            uint64_t size = task.block->size(LoadBlock::OPT_READ_OR);
+            task.crc32 = Utils::CRC32(data, size);
+
+            std::string key = Utils::ToHex(task.crc32);
+            key.append("_").append(Utils::ToHex(size));
+            std::filesystem::path path(task.name);
+            task.file = path.filename().string();
+            task.file.append("_").append(Utils::ToHex(task.block->vaddr()));
+            task.file.append("_").append(Utils::ToHex(task.crc32));
+            {
+                std::lock_guard<std::mutex> guard(lock);
+                auto it = files.find(key);
+                if (it != files.end()) {
+                    task.file = it->second;
+                    task.dup = true;
+                    continue;
+                }
+                files[key] = task.file;
+            }
+
+            std::string output = options.dir;
+            output.append("/").append(task.file);
+            FILE* fp = fopen(output.c_str(), "wb");
+            if (!fp)
+                continue;
+            task.saved = fwrite(data, size, 1, fp) == 1;
+            fclose(fp);
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (int i = 1; i < nthreads; ++i)
+        workers.emplace_back(worker);
+    worker();
+    for (auto& thread : workers)
+        thread.join();
+
+    uint32_t saved = 0;
+    uint32_t dups = 0;
+    for (auto& task : tasks) {
+        LoadBlock* block = task.block;
+        if (task.dup) {
+            dups++;
+        } else if (task.saved) {
+            saved++;
+            LOGI("Saved [%s/%s].\n", options.dir, task.file.c_str());
+        } else {
+            LOGE("Can't write %s/%s\n", options.dir, task.file.c_str());
+            continue;
+        }
+        fprintf(index, "%4d  [%" PRIx64 ", %" PRIx64 ")  %010" PRIx64 "  0x%08x  %s  %s\n",
+                slot, block->vaddr(), block->vaddr() + block->memsz(), block->size(LoadBlock::OPT_READ_OR),
+                task.crc32, task.file.c_str(), task.name.c_str());
+    }
+    LOGI("core(%d) extract %ld ranges, %u saved, %u duplicated.\n", slot, tasks.size(), saved, dups);
+}
+
+bool OatCommand::IsOatBlock(LoadBlock* block) {
+    std::string& name = block->name();
+    static const char* suffixes[] = { ".oat", ".odex", ".vdex", ".art" };
+    for (const auto& suffix : suffixes) {
+        uint32_t len = strlen(suffix);
+        if (name.length() > len && !name.compare(name.length() - len, len, suffix))
+            return true;
+    }
+    return false;
+}
+
+void OatCommand::usage() {
+    LOGI("Usage: oat [OPTION]\n");
+    LOGI("Option:\n");
+    LOGI("        --extract <DIR_PATH>  write mapped oat/odex/vdex/art ranges to files\n");
+    LOGI("    -a, --all                 extract from every core of \"core list\"\n");
+    LOGI("    -t, --threads <NUM>       extract worker threads (default cpu count)\n");
+    ENTER();
+    LOGI("core-parser> oat\n");
+    LOGI("REGION                            FLAGS  SIZE        NAME\n");
+    LOGI("[6f2a9000, 6f8c2000)  r--    0000619000  /apex/com.android.art/javalib/arm64/boot.art [*]\n");
+    LOGI("[70e52000, 71204000)  r--    00003b2000  /system/framework/arm64/boot-framework.oat [*]\n");
+    LOGI("[71204000, 7202b000)  r-x    0000e27000  /system/framework/arm64/boot-framework.oat [*]\n");
+    LOGI("[79185b4dc000, 79185be08000)  r--    000092c000  /system/framework/framework.vdex [*]\n");
+    LOGI("...\n");
+    ENTER();
+    LOGI("core-parser> oat --extract /tmp/oat --all\n");
+    LOGI("Saved [/tmp/oat/boot-framework.oat_0x71204000_0x5a3c1f2e].\n");
+    LOGI("...\n");
+    LOGI("core(0) extract 86 ranges, 86 saved, 0 duplicated.\n");
+    LOGI("core(1) extract 86 ranges, 3 saved, 83 duplicated.\n");
+    LOGI("Saved [/tmp/oat/index.txt].\n");
+}
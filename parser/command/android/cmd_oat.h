@@ -0,0 +1,60 @@
+/*
+ * Copyright (C) 2024-present, Guanyou.Chen. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef PARSER_COMMAND_ANDROID_CMD_OAT_H_
+#define PARSER_COMMAND_ANDROID_CMD_OAT_H_
+
+#include "command/command.h"
+#include "common/load_block.h"
+#include <stdio.h>
+#include <stdint.h>
+#include <string>
+#include <unordered_map>
+
+class OatCommand : public Command {
+public:
+    OatCommand() : Command("oat") {}
+    ~OatCommand() {}
+
+    struct Options : Command::Options {
+        char* dir;
+        bool all;
+        int threads;
+    };
+
+    // one mapped oat/vdex/art range of a core.
+    struct ExtractTask {
+        int slot;
+        LoadBlock* block;
+        std::string name;
+        std::string file;
+        uint32_t crc32;
+        bool dup;
+        bool saved;
+    };
+
+    int main(int argc, char* const argv[]);
+    int prepare(int argc, char* const argv[]);
+    void usage();
+    void ShowOatBlocks();
+    void Extract(int slot, std::unordered_map<std::string, std::string>& files, FILE* index);
+    static bool IsOatBlock(LoadBlock* block);
+private:
+    Options options;
+};
+
+#endif // PARSER_COMMAND_ANDROID_CMD_OAT_H_
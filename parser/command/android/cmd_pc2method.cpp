@@ -0,0 +1,127 @@
+/*
+ * Copyright (C) 2024-present, Guanyou.Chen. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "logger/log.h"
+#include "api/core.h"
+#include "base/utils.h"
+#include "common/exception.h"
+#include "command/android/cmd_pc2method.h"
+#include "android.h"
+#include "runtime/code_index.h"
+#include "runtime/art_method.h"
+#include "runtime/oat_quick_method_header.h"
+#include <unistd.h>
+#include <getopt.h>
+
+int Pc2MethodCommand::prepare(int argc, char* const argv[]) {
+    if (!CoreApi::IsReady()
+            || !Android::IsSdkReady()
+            || !(argc > 1))
+        return Command::FINISH;
+
+    options.verbose = false;
+
+    int opt;
+    int option_index = 0;
+    optind = 0; // reset
+    static struct option long_options[] = {
+        {"verbose",    no_argument,       0,  'v'},
+        {0,            0,                 0,   0 },
+    };
+
+    while ((opt = getopt_long(argc, argv, "v",
+                long_options, &option_index)) != -1) {
+        switch (opt) {
+            case 'v':
+                options.verbose = true;
+                break;
+        }
+    }
+    options.optind = optind;
+
+    if (options.optind >= argc) {
+        usage();
+        return Command::FINISH;
+    }
+
+    Android::Prepare();
+    Android::OatPrepare();
+    art::CodeIndex::Prepare();
+    return Command::ONCHLD;
+}
+
+int Pc2MethodCommand::main(int argc, char* const argv[]) {
+    for (int i = options.optind; i < argc; ++i) {
+        uint64_t pc = Utils::atol(argv[i]) & CoreApi::GetVabitsMask();
+        try {
+            Resolve(pc);
+        } catch (InvalidAddressException& e) {
+            LOGE("Resolve pc 0x%" PRIx64 " interrupted.\n", pc);
+        }
+    }
+    return 0;
+}
+
+void Pc2MethodCommand::Resolve(uint64_t pc) {
+    const art::CodeIndex::Entry* entry = art::CodeIndex::Lookup(pc);
+    if (!entry) {
+        LOGI(ANSI_COLOR_LIGHTYELLOW "0x%" PRIx64 "" ANSI_COLOR_RESET "  not managed code.\n", pc);
+        return;
+    }
+
+    uint64_t offset = pc - entry->code_start;
+    if (!entry->method) {
+        LOGI(ANSI_COLOR_LIGHTYELLOW "0x%" PRIx64 "" ANSI_COLOR_RESET "  [%s]  [0x%" PRIx64 ", 0x%" PRIx64 ")  " ANSI_COLOR_LIGHTGREEN "%s" ANSI_COLOR_RESET "+0x%" PRIx64 "\n",
+             pc, art::CodeIndex::TypeToString(entry->type),
+             entry->code_start, entry->code_start + entry->code_size, entry->name, offset);
+        return;
+    }
+
+    art::ArtMethod method = entry->method;
+    std::string dex_pc_desc;
+    art::OatQuickMethodHeader method_header = art::OatQuickMethodHeader::FromCodePointer(entry->code_start);
+    if (entry->type != art::CodeIndex::TYPE_JNI_STUB && !method.IsNative()) {
+        try {
+            if (method_header.IsOptimized()) {
+                uint32_t dex_pc = method_header.NativePc2DexPc(offset);
+                if (dex_pc != art::dex::kDexNoIndex)
+                    dex_pc_desc.append("  dex_pc: ").append(Utils::ToHex(dex_pc));
+            }
+        } catch (InvalidAddressException& e) {}
+    }
+
+    LOGI(ANSI_COLOR_LIGHTYELLOW "0x%" PRIx64 "" ANSI_COLOR_RESET "  [%s]  [0x%" PRIx64 ", 0x%" PRIx64 ")  +0x%" PRIx64 "%s  %s\n",
+         pc, art::CodeIndex::TypeToString(entry->type),
+         entry->code_start, entry->code_start + entry->code_size, offset,
+         dex_pc_desc.c_str(), method.ColorPrettyMethod().c_str());
+
+    if (options.verbose) {
+        LOGI("  ArtMethod(0x%" PRIx64 ")\n", method.Ptr());
+        method_header.Dump("  ");
+    }
+}
+
+void Pc2MethodCommand::usage() {
+    LOGI("Usage: pc2method <PC..> [OPTION]\n");
+    LOGI("Option:\n");
+    LOGI("    -v, --verbose       show method header.\n");
+    ENTER();
+    LOGI("core-parser> pc2method 0x7a3f12c4 0x71c8f0b8 0x7ad1b6a0\n");
+    LOGI("0x7a3f12c4  [JIT]  [0x7a3f1200, 0x7a3f1384)  +0xc4  dex_pc: 0x1a  void android.os.Looper.loop()\n");
+    LOGI("0x71c8f0b8  [OAT]  [0x71c8f000, 0x71c8f2c0)  +0xb8  dex_pc: 0x2c  java.lang.Object java.lang.reflect.Method.invoke(java.lang.Object, java.lang.Object[])\n");
+    LOGI("0x7ad1b6a0  [STUB]  [0x7ad1b640, 0x7ad1b7a0)  art_quick_generic_jni_trampoline+0x60\n");
+}
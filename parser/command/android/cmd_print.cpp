@@ -24,6 +24,7 @@
 #include "base/utils.h"
 #include "api/core.h"
 #include "runtime/runtime_globals.h"
+#include "runtime/class_layout.h"
 #include "dex/modifiers.h"
 #include "dex/primitive.h"
 #include <stdlib.h>
@@ -162,33 +163,54 @@ bool PrintCommand::PrintReference(art::mirror::Object& object, art::mirror::Obje
     if (cur_deep >= options.deep)
         return true;
 
-    uint64_t real_size = RoundUp(reference.SizeOf(), art::kObjectAlignment);
-    uint64_t count = real_size / sizeof(uint32_t);
     std::string prefix;
     for (int cur = -1; cur < cur_deep; ++cur) {
         prefix.append("  ");
     }
 
-    for (int pos = 0; pos < count; ++pos) {
-        if (object.Ptr() == reference.value32Of(pos * sizeof(uint32_t))) {
-            art::mirror::Class ref_thiz = 0x0;
-            if (reference.IsClass()) {
-                ref_thiz = reference;
-            } else {
-                ref_thiz = reference.GetClass();
-            }
-            LOGI("%s--> " ANSI_COLOR_LIGHTYELLOW "0x%" PRIx64 " " ANSI_COLOR_LIGHTCYAN "%s\n" ANSI_COLOR_RESET,
-                    prefix.c_str(), reference.Ptr(), ref_thiz.PrettyDescriptor().c_str());
-            if (cur_deep + 1 < options.deep) {
-                auto callback = [&](art::mirror::Object& second) -> bool {
-                    return PrintReference(reference, second, cur_deep + 1);
-                };
-                Android::ForeachObjects(callback);
-            }
-            break;
+    // only reference slots, instance fields first, then array elements or statics.
+    bool found = false;
+    auto visitor = [&](uint32_t offset, uint32_t ref) -> bool {
+        found = object.Ptr() == ref;
+        return found;
+    };
+    art::mirror::Class klass = reference.GetClass();
+    art::ClassLayout::VisitReferences(reference, klass, visitor);
+    if (!found && reference.IsObjectArray()) {
+        art::mirror::Array array = reference;
+        int32_t length = array.GetLength();
+        api::MemoryRef data(array.GetRawData(sizeof(uint32_t), 0), array);
+        for (int32_t i = 0; i < length && !found; ++i) {
+            found = object.Ptr() == data.value32Of(i * sizeof(uint32_t));
+        }
+    } else if (!found && reference.IsClass()) {
+        art::mirror::Class thiz = reference;
+        auto callback = [&](art::ArtField& field) -> bool {
+            if (Android::SignatureToBasicTypeAndSize(field.GetTypeDescriptor(), nullptr, "B") != Android::basic_object)
+                return false;
+            found = object.Ptr() == thiz.value32Of(field.offset());
+            return found;
+        };
+        Android::ForeachStaticField(thiz, callback);
+    }
+
+    if (found) {
+        art::mirror::Class ref_thiz = 0x0;
+        if (reference.IsClass()) {
+            ref_thiz = reference;
+        } else {
+            ref_thiz = klass;
+        }
+        LOGI("%s--> " ANSI_COLOR_LIGHTYELLOW "0x%" PRIx64 " " ANSI_COLOR_LIGHTCYAN "%s\n" ANSI_COLOR_RESET,
+                prefix.c_str(), reference.Ptr(), ref_thiz.PrettyDescriptor().c_str());
+        if (cur_deep + 1 < options.deep) {
+            auto callback = [&](art::mirror::Object& second) -> bool {
+                return PrintReference(reference, second, cur_deep + 1);
+            };
+            Android::ForeachObjects(callback);
         }
     }
-    return false;;
+    return false;
 }
 
 void PrintCommand::DumpClass(art::mirror::Class& clazz, bool format_hex) {
@@ -279,8 +301,9 @@ void PrintCommand::DumpInstance(art::mirror::Object& object, bool format_hex) {
     LOGI("Object Name: " ANSI_COLOR_LIGHTMAGENTA "%s\n" ANSI_COLOR_RESET, clazz.PrettyDescriptor().c_str());
 
     std::string format = FormatSize(object.SizeOf());
-    art::mirror::Class super = clazz;
-    do {
+    const art::ClassLayout::Layout& layout = art::ClassLayout::Get(clazz);
+    for (const auto& segment : layout.segments) {
+        art::mirror::Class super(segment.klass, clazz);
         if (clazz != super) {
             LOGI(ANSI_COLOR_LIGHTCYAN "  // extends %s\n" ANSI_COLOR_RESET, super.PrettyDescriptor().c_str());
         }
@@ -294,19 +317,15 @@ void PrintCommand::DumpInstance(art::mirror::Object& object, bool format_hex) {
         }
 
         std::vector<art::ArtField> fields;
-        auto callback = [&](art::ArtField& field) -> bool {
-            fields.push_back(field);
-            return false;
-        };
-        Android::ForeachInstanceField(super, callback);
+        for (uint32_t i = segment.begin; i < segment.end; ++i) {
+            fields.push_back(art::ArtField(layout.fields[i].field, super));
+        }
         std::sort(fields.begin(), fields.end(), art::ArtField::Compare);
 
         for (auto& field : fields) {
             PrintCommand::PrintField(format.c_str(), super, object, field, format_hex);
         }
-
-        super = super.GetSuperClass();
-    } while (super.Ptr());
+    }
 }
 
 void PrintCommand::PrintField(const char* format, art::mirror::Class& clazz,
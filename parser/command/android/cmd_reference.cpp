@@ -88,14 +88,13 @@ int ReferenceCommand::main(int argc, char* const argv[]) {
     art::mirror::Object reference = 0x0;
 
     auto callback = [&](art::mirror::Object& object, int type, uint64_t iref) -> bool {
-        std::string descriptor;
         art::mirror::Class thiz = 0x0;
         if (object.IsClass()) {
             thiz = object;
         } else {
             thiz = object.GetClass();
         }
-        descriptor = thiz.PrettyDescriptor();
+        const std::string& descriptor = thiz.CachedDescriptor();
 
         art::IndirectRefKind kind = static_cast<art::IndirectRefKind>(type & ((1 << Android::EACH_LOCAL_REFERENCES_BY_TID_SHIFT) - 1));
         if (kind == art::IndirectRefKind::kLocal)
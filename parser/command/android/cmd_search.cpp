@@ -19,10 +19,12 @@
 #include "command/command_manager.h"
 #include "command/android/cmd_print.h"
 #include "command/android/cmd_search.h"
-#include "java/lang/Object.h"
+#include "runtime/class_index.h"
+#include "runtime/class_hierarchy.h"
 #include "base/utils.h"
 #include "api/core.h"
 #include "android.h"
+#include "heap_walk.h"
 #include <string.h>
 #include <unistd.h>
 #include <getopt.h>
@@ -39,6 +41,7 @@ int SearchCommand::prepare(int argc, char* const argv[]) {
     options.obj_each_flags = 0;
     options.ref_each_flags = 0;
     options.regex = false;
+    options.instof = false;
     options.show = false;
     options.format_hex = false;
     options.total_objects = 0;
@@ -131,6 +134,9 @@ int SearchCommand::prepare(int argc, char* const argv[]) {
     }
 
     Android::Prepare();
+    // -i resolves targets and subclasses from indexes built before fork.
+    if (options.instof)
+        art::ClassHierarchy::Prepare();
     return Command::ONCHLD;
 }
 
@@ -141,9 +147,30 @@ int SearchCommand::main(int argc, char* const argv[]) {
         return SearchObjects(classname, object);
     };
 
+    matches.clear();
+    if (options.regex) {
+        try {
+            pattern = std::regex(classname, std::regex::optimize);
+        } catch (std::regex_error& e) {
+            LOGE("Invalid regex %s\n", classname);
+            return 0;
+        }
+    }
+
+    targets.clear();
+    if (options.instof) {
+        auto add_target = [&](art::mirror::Class& clazz) -> bool {
+            targets.push_back(clazz);
+            return false;
+        };
+        art::ClassIndex::Find(classname, add_target);
+        if (!targets.size())
+            return 0;
+    }
+
     try {
         if (!options.ref_each_flags) {
-            Android::ForeachObjects(callback, options.obj_each_flags, false);
+            Android::ForEachObject(callback, options.obj_each_flags, false);
         } else {
             Android::ForeachReferences(callback, options.ref_each_flags);
         }
@@ -158,19 +185,27 @@ bool SearchCommand::SearchObjects(const char* classsname, art::mirror::Object& o
     if (!(options.type_flag & mask))
         return false;
 
-    std::string descriptor;
     art::mirror::Class thiz = 0x0;
     if (object.IsClass()) {
         thiz = object;
     } else {
         thiz = object.GetClass();
     }
-    descriptor = thiz.PrettyDescriptor();
+    const std::string& descriptor = thiz.CachedDescriptor();
+
+    bool match;
+    uint64_t key = thiz.Ptr() | (mask == SEARCH_CLASS);
+    auto it = matches.find(key);
+    if (it != matches.end()) {
+        match = it->second;
+    } else {
+        match = options.regex && std::regex_search(descriptor, pattern)
+                || descriptor == classsname
+                || (options.instof && InstanceOf(object));
+        matches[key] = match;
+    }
 
-    java::lang::Object java = object;
-    if (options.regex && std::regex_search(descriptor, std::regex(classsname))
-            || descriptor == classsname
-            || (options.instof && java.instanceof(classsname))) {
+    if (match) {
         options.total_objects++;
         LOGI("[%" PRId64 "] " ANSI_COLOR_LIGHTYELLOW  "0x%" PRIx64 "" ANSI_COLOR_LIGHTCYAN " %s\n" ANSI_COLOR_RESET,
                 options.total_objects, object.Ptr(), descriptor.c_str());
@@ -180,6 +215,15 @@ bool SearchCommand::SearchObjects(const char* classsname, art::mirror::Object& o
     return false;
 }
 
+bool SearchCommand::InstanceOf(art::mirror::Object& object) {
+    art::mirror::Class thiz = object.GetClass();
+    for (auto& target : targets) {
+        if (art::ClassHierarchy::InstanceOf(thiz, target))
+            return true;
+    }
+    return false;
+}
+
 void SearchCommand::usage() {
     LOGI("Usage: search <CLASSNAME> [OPTION..] [TYPE] [REF]\n");
     LOGI("Option:\n");
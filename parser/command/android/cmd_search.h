@@ -19,6 +19,10 @@
 
 #include "command/command.h"
 #include "runtime/mirror/object.h"
+#include "runtime/mirror/class.h"
+#include <vector>
+#include <regex>
+#include <unordered_map>
 
 class SearchCommand : public Command {
 public:
@@ -43,8 +47,14 @@ public:
     int prepare(int argc, char* const argv[]);
     void usage();
     bool SearchObjects(const char* classsname, art::mirror::Object& object);
+    bool InstanceOf(art::mirror::Object& object);
 private:
     Options options;
+    // classes named CLASSNAME, may come from several class loaders
+    std::vector<art::mirror::Class> targets;
+    std::regex pattern;
+    // match result per class, the low bit tags class objects
+    std::unordered_map<uint64_t, bool> matches;
 };
 
 #endif // PARSER_COMMAND_ANDROID_CMD_SEARCH_H_
@@ -18,18 +18,28 @@
 #include "android.h"
 #include "command/android/cmd_space.h"
 #include "api/core.h"
+#include "common/exception.h"
 #include "runtime/runtime.h"
 #include "runtime/gc/heap.h"
 #include "runtime/gc/space/space.h"
 #include "runtime/gc/space/large_object_space.h"
+#include "runtime/gc/space/region_space.h"
+#include "runtime/gc/verification.h"
+#include <stdlib.h>
 #include <unistd.h>
 #include <getopt.h>
+#include <algorithm>
+#include <vector>
 
 int SpaceCommand::prepare(int argc, char* const argv[]) {
     if (!CoreApi::IsReady() || !Android::IsSdkReady())
         return Command::FINISH;
 
     options.check = false;
+    options.verify = false;
+    options.regions = false;
+    options.threads = 0;
+    options.num = 16;
     options.flag = 0;
 
     int opt;
@@ -41,10 +51,14 @@ int SpaceCommand::prepare(int argc, char* const argv[]) {
         {"zygote",   no_argument,       0,   2 },
         {"image",    no_argument,       0,   3 },
         {"fake",     no_argument,       0,   4 },
+        {"verify",   no_argument,       0,   5 },
+        {"threads",  required_argument, 0,  't'},
+        {"regions",  no_argument,       0,   6 },
+        {"num",      required_argument, 0,  'n'},
         {0,          0,                 0,   0 },
     };
 
-    while ((opt = getopt_long(argc, argv, "c",
+    while ((opt = getopt_long(argc, argv, "ct:n:",
                 long_options, &option_index)) != -1) {
         switch (opt) {
             case 'c':
@@ -62,6 +76,18 @@ int SpaceCommand::prepare(int argc, char* const argv[]) {
             case 4:
                 options.flag |= Android::EACH_FAKE_OBJECTS;
                 break;
+            case 5:
+                options.verify = true;
+                break;
+            case 't':
+                options.threads = std::atoi(optarg);
+                break;
+            case 6:
+                options.regions = true;
+                break;
+            case 'n':
+                options.num = std::atoi(optarg);
+                break;
         }
     }
     options.optind = optind;
@@ -78,7 +104,11 @@ int SpaceCommand::prepare(int argc, char* const argv[]) {
 }
 
 int SpaceCommand::main(int argc, char* const argv[]) {
-    if (options.check) {
+    if (options.regions) {
+        ShowRegions();
+    } else if (options.verify) {
+        Verify();
+    } else if (options.check) {
         auto callback = [&](art::mirror::Object& object) -> bool {
             // do nothing
             return false;
@@ -109,10 +139,225 @@ int SpaceCommand::main(int argc, char* const argv[]) {
     return 0;
 }
 
+void SpaceCommand::Verify() {
+    art::gc::Verification verification(options.flag);
+    verification.Verify(options.threads);
+
+    uint64_t objects = 0;
+    uint64_t bytes = 0;
+    uint64_t ranges = 0;
+    uint64_t bad_units = 0;
+    for (auto& unit : verification.GetUnits()) {
+        objects += unit.objects;
+        bytes += unit.bytes;
+
+        bool mismatch = unit.mode == art::gc::Verification::UNIT_BITMAP
+                && unit.bytes != unit.live_bytes;
+        if (!unit.corruptions.size() && !mismatch)
+            continue;
+
+        bad_units++;
+        ranges += unit.corruptions.size();
+        if (unit.region) {
+            LOGI(ANSI_COLOR_LIGHTRED "Region" ANSI_COLOR_RESET " " ANSI_COLOR_LIGHTYELLOW "0x%" PRIx64 "" ANSI_COLOR_RESET " " ANSI_COLOR_LIGHTCYAN "[0x%" PRIx64 ", 0x%" PRIx64 ")" ANSI_COLOR_RESET " " ANSI_COLOR_LIGHTGREEN "%s\n" ANSI_COLOR_RESET,
+                    unit.region, unit.begin, unit.end, unit.name);
+        } else {
+            LOGI(ANSI_COLOR_LIGHTRED "Space" ANSI_COLOR_RESET " " ANSI_COLOR_LIGHTCYAN "[0x%" PRIx64 ", 0x%" PRIx64 ")" ANSI_COLOR_RESET " " ANSI_COLOR_LIGHTGREEN "%s\n" ANSI_COLOR_RESET,
+                    unit.begin, unit.end, unit.name);
+        }
+        if (mismatch)
+            LOGI("    live bytes %" PRIu64 " but bitmap marks %" PRIu64 "\n", unit.live_bytes, unit.bytes);
+        for (const auto& corruption : unit.corruptions) {
+            LOGI("    " ANSI_COLOR_LIGHTCYAN "[0x%" PRIx64 ", 0x%" PRIx64 ")" ANSI_COLOR_RESET "  " ANSI_COLOR_LIGHTMAGENTA "%-16s" ANSI_COLOR_RESET "  0x%-10" PRIx64 "  prev 0x%-10" PRIx64 "  next 0x%" PRIx64 "\n",
+                    corruption.begin, corruption.end,
+                    art::gc::Verification::ReasonToString(corruption.reason).c_str(),
+                    corruption.detail, corruption.prev, corruption.next);
+        }
+    }
+
+    LOGI("Verified %" PRIu64 " units with %d threads, %" PRIu64 " objects, %" PRIu64 " bytes.\n",
+            (uint64_t)verification.GetUnits().size(), verification.GetThreads(), objects, bytes);
+    if (bad_units) {
+        LOGE("Found %" PRIu64 " corrupt ranges in %" PRIu64 " units.\n", ranges, bad_units);
+    } else {
+        LOGI("No corruption found.\n");
+    }
+}
+
+void SpaceCommand::ShowRegions() {
+    art::Runtime& runtime = art::Runtime::Current();
+    art::gc::Heap& heap = runtime.GetHeap();
+    art::gc::space::RegionSpace* region_space = nullptr;
+    for (const auto& space : heap.GetContinuousSpaces()) {
+        if (space->IsRegionSpace()) {
+            region_space = static_cast<art::gc::space::RegionSpace*>(space.get());
+            break;
+        }
+    }
+    if (!region_space) {
+        LOGE("No region space.\n");
+        return;
+    }
+
+    // same as art kEvacuateLivePercentThreshold
+    static constexpr uint64_t kEvacuateLivePercent = 75;
+    static constexpr int kBuckets = 10;
+    static const char* kStates[] = {"Free", "Allocated", "Large", "LargeTail"};
+    static const char* kTypes[] = {"All", "FromSpace", "UnevacFromSpace", "ToSpace", "None"};
+
+    struct Bucket {
+        uint64_t regions;
+        uint64_t allocated;
+        uint64_t live;
+    };
+    struct Fragment {
+        uint64_t region;
+        uint64_t begin;
+        uint64_t top;
+        uint64_t live;
+    };
+
+    uint64_t unknown_live = static_cast<uint64_t>(-1) & CoreApi::GetPointMask();
+    uint64_t states[4] = {0};
+    uint64_t state_bytes[4] = {0};
+    uint64_t types[5] = {0};
+    Bucket buckets[kBuckets] = {};
+    std::vector<Fragment> fragments;
+    uint64_t region_size = 0;
+    uint64_t unallocated = 0;
+    uint64_t large_objects = 0;
+    uint64_t large_regions = 0;
+    uint64_t large_waste = 0;
+    uint64_t large_used = 0;
+    uint64_t large_span = 0;
+    uint64_t evacuated = 0;
+    uint64_t copied = 0;
+    uint64_t reclaim = 0;
+
+    // a large object spans its first region and the following tails
+    auto finish_large = [&]() {
+        if (large_span) {
+            large_waste += large_span - std::min(large_used, large_span);
+            large_span = 0;
+        }
+    };
+
+    art::gc::space::RegionSpace::Region regions(region_space->regions(), region_space);
+    uint64_t num_regions = region_space->num_regions();
+    for (uint64_t i = 0; i < num_regions; ++i) {
+        art::gc::space::RegionSpace::Region r(regions.Ptr() + i * SIZEOF(Region), regions);
+        uint8_t state = r.state();
+        uint8_t type = r.type();
+        uint64_t size = r.End() - r.Begin();
+        region_size = std::max(region_size, size);
+        if (state < 4) {
+            states[state]++;
+            state_bytes[state] += size;
+        }
+        if (type < 5) types[type]++;
+
+        if (r.IsLargeTail()) {
+            large_span += size;
+            large_regions++;
+            continue;
+        }
+        finish_large();
+
+        if (r.IsFree())
+            continue;
+
+        uint64_t allocated = r.Top() - r.Begin();
+        if (r.IsLarge()) {
+            large_objects++;
+            large_regions++;
+            large_span = size;
+            // top is rounded up to the whole span, the object tells the used bytes
+            large_used = r.LiveBytes();
+            try {
+                art::mirror::Object object = r.Begin();
+                if (object.GetClass().Ptr())
+                    large_used = object.SizeOf();
+            } catch (InvalidAddressException& e) {}
+            if (large_used == unknown_live) large_used = allocated;
+            continue;
+        }
+
+        // not marked since allocated, take it as fully live
+        uint64_t live = r.LiveBytes();
+        if (live == unknown_live) live = allocated;
+        live = std::min(live, allocated);
+        unallocated += r.End() - r.Top();
+
+        int idx = allocated ? live * kBuckets / allocated : 0;
+        idx = std::min(idx, kBuckets - 1);
+        buckets[idx].regions++;
+        buckets[idx].allocated += allocated;
+        buckets[idx].live += live;
+
+        if (live * 100 < kEvacuateLivePercent * size) {
+            evacuated++;
+            copied += live;
+            reclaim += size - live;
+        }
+        fragments.push_back({r.Ptr(), r.Begin(), r.Top(), live});
+    }
+    finish_large();
+
+    LOGI("Region space " ANSI_COLOR_LIGHTCYAN "[0x%" PRIx64 ", 0x%" PRIx64 ")" ANSI_COLOR_RESET " " ANSI_COLOR_LIGHTYELLOW "0x%" PRIx64 "" ANSI_COLOR_RESET ", %" PRIu64 " regions of %" PRIu64 "K\n",
+            region_space->Begin(), region_space->End(), region_space->Ptr(), num_regions, region_size / 1024);
+    LOGI(ANSI_COLOR_LIGHTRED "STATE              REGIONS           BYTES\n" ANSI_COLOR_RESET);
+    for (int i = 0; i < 4; ++i) {
+        LOGI("%-16s  %8" PRIu64 "  %14" PRIu64 "\n", kStates[i], states[i], state_bytes[i]);
+    }
+    LOGI(ANSI_COLOR_LIGHTRED "TYPE               REGIONS\n" ANSI_COLOR_RESET);
+    for (int i = 1; i < 5; ++i) {
+        LOGI("%-16s  %8" PRIu64 "\n", kTypes[i], types[i]);
+    }
+
+    ENTER();
+    LOGI(ANSI_COLOR_LIGHTRED "LIVE/ALLOC      REGIONS       ALLOCATED            LIVE         GARBAGE\n" ANSI_COLOR_RESET);
+    for (int i = 0; i < kBuckets; ++i) {
+        LOGI("[%3d%%, %3d%%%c  %8" PRIu64 "  %14" PRIu64 "  %14" PRIu64 "  " ANSI_COLOR_LIGHTMAGENTA "%14" PRIu64 "\n" ANSI_COLOR_RESET,
+                i * 100 / kBuckets, (i + 1) * 100 / kBuckets, i == kBuckets - 1 ? ']' : ')',
+                buckets[i].regions, buckets[i].allocated, buckets[i].live,
+                buckets[i].allocated - buckets[i].live);
+    }
+
+    ENTER();
+    LOGI("Unallocated in allocated regions: %" PRIu64 "\n", unallocated);
+    LOGI("Large objects: %" PRIu64 " over %" PRIu64 " regions, tail waste %" PRIu64 "\n",
+            large_objects, large_regions, large_waste);
+    uint64_t needed = region_size ? (copied + region_size - 1) / region_size : 0;
+    LOGI("Compaction estimate (evacuate < %" PRIu64 "%% live): %" PRIu64 " regions, copy %" PRIu64 ", reclaim " ANSI_COLOR_LIGHTGREEN "%" PRIu64 "" ANSI_COLOR_RESET " (%" PRIu64 " regions)\n",
+            kEvacuateLivePercent, evacuated, copied, reclaim, evacuated - std::min(needed, evacuated));
+
+    uint32_t num = std::min<uint32_t>(std::max(options.num, 0), fragments.size());
+    if (!num)
+        return;
+
+    auto compare = [](const Fragment& a, const Fragment& b) {
+        return (a.top - a.begin - a.live) > (b.top - b.begin - b.live);
+    };
+    std::partial_sort(fragments.begin(), fragments.begin() + num, fragments.end(), compare);
+    ENTER();
+    LOGI(ANSI_COLOR_LIGHTRED "REGION            RANGE                        ALLOCATED        LIVE   RATIO\n" ANSI_COLOR_RESET);
+    for (uint32_t i = 0; i < num; ++i) {
+        const Fragment& fragment = fragments[i];
+        uint64_t allocated = fragment.top - fragment.begin;
+        LOGI(ANSI_COLOR_LIGHTYELLOW "0x%" PRIx64 "" ANSI_COLOR_RESET "  " ANSI_COLOR_LIGHTCYAN "[0x%" PRIx64 ", 0x%" PRIx64 ")" ANSI_COLOR_RESET "  %10" PRIu64 "  %10" PRIu64 "  %5.1f%%\n",
+                fragment.region, fragment.begin, fragment.top, allocated, fragment.live,
+                allocated ? fragment.live * 100.0 / allocated : 0.0);
+    }
+}
+
 void SpaceCommand::usage() {
     LOGI("Usage: space [OPTION] [TYPE]\n");
     LOGI("Option:\n");
-    LOGI("    -c, --check   check space bad object.\n");
+    LOGI("    -c, --check            check space bad object.\n");
+    LOGI("        --verify           verify class, size, alignment, live bitmap and references of all objects.\n");
+    LOGI("    -t, --threads <NUM>    verify threads (default hardware concurrency)\n");
+    LOGI("        --regions          show region space fragmentation from region metadata.\n");
+    LOGI("    -n, --num <NUM>        show the most fragmented regions (default 16)\n");
     LOGI("Type: {--app, --zygote, --image, --fake}\n");
     ENTER();
     LOGI("core-parser> space\n");
@@ -124,4 +369,39 @@ void SpaceCommand::usage() {
     ENTER();
     LOGI("core-parser> space --check --app\n");
     LOGI("ERROR: Region:[0x12c00000, 0x12c00018) main space (region space) has bad object!!\n");
+    ENTER();
+    LOGI("core-parser> space --verify --app\n");
+    LOGI("Region 0x75db0d6c2f40 [0x13180000, 0x131bfff8) main space (region space)\n");
+    LOGI("    [0x13183a10, 0x13183a48)  class             0xdeadbeef    prev 0x131839e8    next 0x13183a48\n");
+    LOGI("    [0x1319c020, 0x1319c040)  reference         0x98765430    prev 0x1319bff0    next 0x1319c040\n");
+    LOGI("Region 0x75db0d6c3c80 [0x13c00000, 0x13c3ffe0) main space (region space)\n");
+    LOGI("    live bytes 189336 but bitmap marks 189304\n");
+    LOGI("Verified 2843 units with 8 threads, 406271 objects, 29873960 bytes.\n");
+    LOGI("ERROR: Found 2 corrupt ranges in 2 units.\n");
+    ENTER();
+    LOGI("core-parser> space --regions -n 2\n");
+    LOGI("Region space [0x12c00000, 0x2ac00000) 0x75db0d608820, 1536 regions of 256K\n");
+    LOGI("STATE              REGIONS           BYTES\n");
+    LOGI("Free                  1402       367525888\n");
+    LOGI("Allocated              121        31719424\n");
+    LOGI("Large                    5         1310720\n");
+    LOGI("LargeTail                8         2097152\n");
+    LOGI("TYPE               REGIONS\n");
+    LOGI("FromSpace                0\n");
+    LOGI("UnevacFromSpace         97\n");
+    LOGI("ToSpace                 37\n");
+    LOGI("None                  1402\n");
+    ENTER();
+    LOGI("LIVE/ALLOC      REGIONS       ALLOCATED            LIVE         GARBAGE\n");
+    LOGI("[  0%%,  10%%)         3          786432           41288          745144\n");
+    LOGI("...\n");
+    LOGI("[ 90%%, 100%%]        88        23068672        22915436          153236\n");
+    ENTER();
+    LOGI("Unallocated in allocated regions: 18032\n");
+    LOGI("Large objects: 5 over 13 regions, tail waste 411296\n");
+    LOGI("Compaction estimate (evacuate < 75%% live): 17 regions, copy 1382104, reclaim 3074344 (11 regions)\n");
+    ENTER();
+    LOGI("REGION            RANGE                        ALLOCATED        LIVE   RATIO\n");
+    LOGI("0x75db0d6c2f40  [0x13180000, 0x131bfff8)      262136       20480    7.8%%\n");
+    LOGI("0x75db0d6c3c80  [0x13c00000, 0x13c3ffe0)      262112       41288   15.8%%\n");
 }
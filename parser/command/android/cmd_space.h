@@ -27,11 +27,17 @@ public:
     struct Options : Command::Options {
         int flag;
         bool check;
+        bool verify;
+        bool regions;
+        int threads;
+        int num;
     };
 
     int main(int argc, char* const argv[]);
     int prepare(int argc, char* const argv[]);
     void usage();
+    void Verify();
+    void ShowRegions();
 private:
     Options options;
 };
@@ -18,17 +18,22 @@
 #include "runtime/mirror/class.h"
 #include "command/command_manager.h"
 #include "command/android/cmd_top.h"
+#include "command/android/heap_histogram.h"
+#include "runtime/gc/walk_sampler.h"
 #include "common/exception.h"
 #include "sun/misc/Cleaner.h"
 #include "libcore/util/NativeAllocationRegistry.h"
 #include "api/core.h"
 #include "android.h"
+#include "heap_walk.h"
 #include <string.h>
 #include <unistd.h>
 #include <getopt.h>
 #include <sstream>
 #include <regex>
-#include <map>
+#include <unordered_map>
+#include <math.h>
+#include <time.h>
 #include <vector>
 
 int TopCommand::prepare(int argc, char* const argv[]) {
@@ -40,6 +45,10 @@ int TopCommand::prepare(int argc, char* const argv[]) {
     options.num = std::atoi(argv[1]);
     options.order = ORDERBY_ALLOC;
     options.show = false;
+    options.group = HeapHistogram::GROUP_CLASS;
+    options.sample = 1.0;
+    // a new sample per run, rerun with --seed to repeat one.
+    options.seed = static_cast<uint64_t>(time(nullptr)) ^ (static_cast<uint64_t>(getpid()) << 32);
     options.obj_each_flags = 0;
     options.ref_each_flags = 0;
 
@@ -51,6 +60,9 @@ int TopCommand::prepare(int argc, char* const argv[]) {
         {"shallow",    no_argument,       0,  's'},
         {"native",     no_argument,       0,  'n'},
         {"display",    no_argument,       0,  'd'},
+        {"group",      required_argument, 0,  'g'},
+        {"sample",     required_argument, 0,   8 },
+        {"seed",       required_argument, 0,   9 },
         {"app",        no_argument,       0,   1 },
         {"zygote",     no_argument,       0,   2 },
         {"image",      no_argument,       0,   3 },
@@ -62,7 +74,7 @@ int TopCommand::prepare(int argc, char* const argv[]) {
         {0,            0,                 0,   0 },
     };
 
-    while ((opt = getopt_long(argc, argv, "asndt:",
+    while ((opt = getopt_long(argc, argv, "asndg:t:",
                 long_options, &option_index)) != -1) {
         switch (opt) {
             case 'a':
@@ -77,6 +89,28 @@ int TopCommand::prepare(int argc, char* const argv[]) {
             case 'd':
                 options.show = true;
                 break;
+            case 'g':
+                if (!strcmp(optarg, "package")) {
+                    options.group = HeapHistogram::GROUP_PACKAGE;
+                } else if (!strcmp(optarg, "loader")) {
+                    options.group = HeapHistogram::GROUP_CLASSLOADER;
+                } else if (!strcmp(optarg, "class")) {
+                    options.group = HeapHistogram::GROUP_CLASS;
+                } else {
+                    LOGE("Unknown group %s, {class, package, loader}\n", optarg);
+                    return Command::FINISH;
+                }
+                break;
+            case 8:
+                options.sample = std::atof(optarg) / 100;
+                if (options.sample <= 0 || options.sample > 1) {
+                    LOGE("Invalid sample percent %s, (0, 100]\n", optarg);
+                    return Command::FINISH;
+                }
+                break;
+            case 9:
+                options.seed = std::strtoull(optarg, nullptr, 0);
+                break;
             case 1:
                 options.obj_each_flags |= Android::EACH_APP_OBJECTS;
                 break;
@@ -118,137 +152,134 @@ int TopCommand::prepare(int argc, char* const argv[]) {
 }
 
 int TopCommand::main(int argc, char* const argv[]) {
-    std::map<art::mirror::Class, TopCommand::Pair> classes;
+    HeapHistogram histogram;
+    // objects read from sampled units, extrapolated after the walk
+    HeapHistogram sampled;
+    // per class sum of squared unit totals, for the sampling variance
+    std::unordered_map<uint64_t, std::pair<double, double>> squares;
+    std::unordered_map<uint64_t, std::pair<uint64_t, uint64_t>> unit_rows;
+    uint64_t last_unit = 0;
+    auto flush_unit = [&]() {
+        for (const auto& value : unit_rows) {
+            std::pair<double, double>& square = squares[value.first];
+            square.first += static_cast<double>(value.second.first) * value.second.first;
+            square.second += static_cast<double>(value.second.second) * value.second.second;
+        }
+        unit_rows.clear();
+    };
+
     art::mirror::Class cleaner = 0;
-    std::vector<art::mirror::Object> cleaners;
+    // native sizes are joined after the walk, a referent may sit in an unwalked space
+    std::unordered_map<uint64_t, uint64_t> natives;
     auto callback = [&](art::mirror::Object& object) -> bool {
         if (object.IsClass())
             return false;
 
         art::mirror::Class thiz = object.GetClass();
-        if (!cleaner.Ptr()) {
-            if (thiz.PrettyDescriptor() == "sun.misc.Cleaner") {
-                cleaner = thiz;
-                cleaners.push_back(object);
+        uint64_t unit = art::gc::WalkSampler::Unit();
+        if (!unit) {
+            histogram.Add(thiz.Ptr(), object.SizeOf());
+        } else {
+            uint64_t size = object.SizeOf();
+            sampled.Add(thiz.Ptr(), size);
+            if (unit != last_unit) {
+                flush_unit();
+                last_unit = unit;
             }
-        } else if (cleaner == thiz) {
-            cleaners.push_back(object);
+            std::pair<uint64_t, uint64_t>& row = unit_rows[thiz.Ptr()];
+            row.first += 1;
+            row.second += size;
         }
 
-        auto it = classes.find(thiz.Ptr());
-        if (it == classes.end()) {
-            TopCommand::Pair pair = {
-                .alloc_count = 1,
-                .shallow_size = object.SizeOf(),
-            };
-            classes.insert(std::pair<art::mirror::Class, TopCommand::Pair>(thiz, pair));
-        } else {
-            TopCommand::Pair& pair = it->second;
-            pair.alloc_count += 1;
-            pair.shallow_size += object.SizeOf();
+        if (!cleaner.Ptr()) {
+            if (thiz.CachedDescriptor() != "sun.misc.Cleaner")
+                return false;
+            cleaner = thiz;
+        } else if (cleaner != thiz) {
+            return false;
         }
 
+        try {
+            sun::misc::Cleaner cleaner_object = object;
+            java::lang::Object referent = cleaner_object.getReferent();
+            if (referent.isNull())
+                return false;
+
+            libcore::util::NativeAllocationRegistry::CleanerThunk thunk = cleaner_object.getThunk();
+            if (thunk.isNull())
+                return false;
+
+            libcore::util::NativeAllocationRegistry registry = thunk.getRegistry();
+            if (registry.isNull())
+                return false;
+
+            natives[referent.klass().Ptr()] += registry.getSize() * art::gc::WalkSampler::Weight();
+        } catch (InvalidAddressException& e) {}
         return false;
     };
 
+    art::gc::WalkSampler::Enable(options.sample, options.seed);
     try {
         if (!options.ref_each_flags) {
-            Android::ForeachObjects(callback, options.obj_each_flags, false);
+            Android::ForEachObject(callback, options.obj_each_flags, false);
         } else {
             Android::ForeachReferences(callback, options.ref_each_flags);
         }
     } catch(InvalidAddressException& e) {
         LOGW("The statistical process was interrupted!\n");
     }
+    art::gc::WalkSampler::Disable();
+    flush_unit();
 
-    LOGI(ANSI_COLOR_LIGHTRED "Address       Allocations      ShallowSize        NativeSize     %s\n" ANSI_COLOR_RESET, options.show ? "ClassName" : "");
-    art::mirror::Class cur_max_thiz = 0;
-    TopCommand::Pair cur_max_pair = {
-        .alloc_count = 0,
-        .shallow_size = 0,
-        .native_size = 0,
-    };
-
-    for (int i = 0; i < cleaners.size(); i++) {
-        sun::misc::Cleaner cleaner = cleaners[i];
-        java::lang::Object referent = cleaner.getReferent();
-
-        if (referent.isNull())
-            continue;
+    bool sampling = sampled.Size() > 0;
+    double rate = options.sample;
+    histogram.Merge(sampled, 1.0 / rate);
+    for (const auto& value : natives)
+        histogram.AddNative(value.first, value.second);
 
-        auto it = classes.find(referent.klass());
-        if (it == classes.end())
-            continue;
-
-        try {
-            libcore::util::NativeAllocationRegistry::CleanerThunk thunk = cleaner.getThunk();
-            if (thunk.isNull())
-                continue;
-
-            libcore::util::NativeAllocationRegistry registry = thunk.getRegistry();
-            if (registry.isNull())
-                continue;
+    // 95% interval of a Horvitz-Thompson total under Bernoulli unit sampling
+    auto interval = [&](double square) -> uint64_t {
+        return static_cast<uint64_t>(1.96 * sqrt((1.0 - rate) / (rate * rate) * square) + 0.5);
+    };
 
-            TopCommand::Pair& pair = it->second;
-            pair.native_size += registry.getSize();
-        } catch (InvalidAddressException& e) {}
+    int column = HeapHistogram::COLUMN_ALLOC;
+    if (options.order == ORDERBY_SHALLOW) {
+        column = HeapHistogram::COLUMN_SHALLOW;
+    } else if (options.order == ORDERBY_NATIVE) {
+        column = HeapHistogram::COLUMN_NATIVE;
     }
 
-    uint64_t total_count = 0;
-    uint64_t total_shallow = 0;
-    uint64_t total_native = 0;
-
-    for (const auto& value : classes) {
-        const art::mirror::Class& thiz = value.first;
-        const TopCommand::Pair& pair = value.second;
-
-        total_count += pair.alloc_count;
-        total_shallow += pair.shallow_size;
-        total_native += pair.native_size;
+    HeapHistogram result = histogram.GroupBy(options.group);
+    HeapHistogram::Entry total = result.Total();
+    bool show = options.show || options.group == HeapHistogram::GROUP_PACKAGE;
+    bool show_interval = sampling && options.group == HeapHistogram::GROUP_CLASS;
+    if (sampling) {
+        LOGI("Sampled %" PRId64 "/%" PRId64 " units, scaled by %.2f, seed 0x%" PRIx64 "\n",
+             art::gc::WalkSampler::PickedUnits(), art::gc::WalkSampler::TotalUnits(), 1.0 / rate, options.seed);
     }
-
+    LOGI(ANSI_COLOR_LIGHTRED "Address       Allocations      ShallowSize        NativeSize     %s%s\n" ANSI_COLOR_RESET,
+         show_interval ? "  ±Allocations     ±ShallowSize     " : "",
+         show ? (options.group == HeapHistogram::GROUP_CLASS ? "ClassName" : "Group") : "");
     LOGI("TOTAL            " ANSI_COLOR_LIGHTMAGENTA "%8" PRId64 "      " ANSI_COLOR_LIGHTBLUE "%11" PRId64 "       " ANSI_COLOR_LIGHTGREEN "%11" PRId64 "\n" ANSI_COLOR_RESET,
-         total_count, total_shallow, total_native);
+         total.alloc_count, total.shallow_size, total.native_size);
     LOGI("------------------------------------------------------------\n");
 
-    for (int i = 0; i < options.num; ++i) {
-        for (const auto& value : classes) {
-            const art::mirror::Class& thiz = value.first;
-            const TopCommand::Pair& pair = value.second;
-
-            switch (options.order) {
-                case ORDERBY_ALLOC: {
-                   if (pair.alloc_count >= cur_max_pair.alloc_count) {
-                       cur_max_thiz = thiz;
-                       cur_max_pair = pair;
-                   }
-                } break;
-                case ORDERBY_SHALLOW: {
-                   if (pair.shallow_size >= cur_max_pair.shallow_size) {
-                       cur_max_thiz = thiz;
-                       cur_max_pair = pair;
-                   }
-                } break;
-                case ORDERBY_NATIVE: {
-                   if (pair.native_size >= cur_max_pair.native_size) {
-                       cur_max_thiz = thiz;
-                       cur_max_pair = pair;
-                   }
-                } break;
-            }
+    for (const auto& row : result.Top(options.num, column)) {
+        const HeapHistogram::Entry& entry = row.second;
+        if (options.group == HeapHistogram::GROUP_PACKAGE) {
+            LOGI("                 %8" PRId64 "      " "%11" PRId64 "       " "%11" PRId64 "     " ANSI_COLOR_LIGHTCYAN "%s\n" ANSI_COLOR_RESET,
+                 entry.alloc_count, entry.shallow_size, entry.native_size, result.Name(row.first).c_str());
+        } else if (show_interval) {
+            std::pair<double, double>& square = squares[row.first];
+            LOGI(ANSI_COLOR_LIGHTYELLOW "0x%08" PRIx64 "" ANSI_COLOR_RESET "       " "%8" PRId64 "      " "%11" PRId64 "       " "%11" PRId64 "     " "%14" PRId64 "   %14" PRId64 "     " ANSI_COLOR_LIGHTCYAN "%s\n" ANSI_COLOR_RESET,
+                 row.first, entry.alloc_count, entry.shallow_size, entry.native_size,
+                 interval(square.first), interval(square.second),
+                 show ? result.Name(row.first).c_str() : "");
+        } else {
+            LOGI(ANSI_COLOR_LIGHTYELLOW "0x%08" PRIx64 "" ANSI_COLOR_RESET "       " "%8" PRId64 "      " "%11" PRId64 "       " "%11" PRId64 "     " ANSI_COLOR_LIGHTCYAN "%s\n" ANSI_COLOR_RESET,
+                 row.first, entry.alloc_count, entry.shallow_size, entry.native_size,
+                 show ? result.Name(row.first).c_str() : "");
         }
-
-        if (!cur_max_thiz.Ptr())
-            break;
-
-        LOGI(ANSI_COLOR_LIGHTYELLOW "0x%08" PRIx64 "" ANSI_COLOR_RESET "       " "%8" PRId64 "      " "%11" PRId64 "       " "%11" PRId64 "     " ANSI_COLOR_LIGHTCYAN "%s\n" ANSI_COLOR_RESET,
-             cur_max_thiz.Ptr(), cur_max_pair.alloc_count,
-             cur_max_pair.shallow_size, cur_max_pair.native_size,
-             options.show ? cur_max_thiz.PrettyDescriptor().c_str() : "");
-
-        classes.erase(cur_max_thiz);
-        cur_max_thiz = 0;
-        cur_max_pair = {0, 0, 0};
     }
     return 0;
 }
@@ -260,6 +291,9 @@ void TopCommand::usage() {
     LOGI("    -s, --shallow   order by shallow\n");
     LOGI("    -n, --native    order by native\n");
     LOGI("    -d, --display   show class name\n");
+    LOGI("    -g, --group <class|package|loader>  aggregate by class, package or class loader\n");
+    LOGI("        --sample <PERCENT>  walk a random PERCENT of heap regions, scale up and show 95%% intervals\n");
+    LOGI("        --seed <SEED>       sample seed, default a new one per run, printed with the result\n");
     LOGI("Type: {--app, --zygote, --image, --fake}\n");
     LOGI("Ref: {--local, --global, --weak, --thread <TID>}\n");
     ENTER();
@@ -292,4 +326,23 @@ void TopCommand::usage() {
     LOGI("0x6f79ba88            174             6264                 0     sun.misc.Cleaner\n");
     LOGI("0x70101c18            258             6192                 0     android.graphics.Rect\n");
     LOGI("0x70360328             40             5600                 0     android.animation.ObjectAnimator\n");
+    ENTER();
+    LOGI("core-parser> top 5 -s -g package\n");
+    LOGI("Address       Allocations      ShallowSize        NativeSize     Group\n");
+    LOGI("TOTAL              136939          8045084            108415\n");
+    LOGI("------------------------------------------------------------\n");
+    LOGI("                    35106          4312870                 0     <default>\n");
+    LOGI("                    47233          2872616                 0     java.lang\n");
+    LOGI("                    17950           498512                 0     java.util\n");
+    LOGI("                     3892           155680            104175     android.graphics\n");
+    LOGI("                     2293            45860                 0     android.icu.util\n");
+    ENTER();
+    LOGI("core-parser> top 3 -d --sample 10\n");
+    LOGI("Sampled 52/508 units, scaled by 10.00, seed 0x3a7c0000671256e1\n");
+    LOGI("Address       Allocations      ShallowSize        NativeSize       ±Allocations     ±ShallowSize     ClassName\n");
+    LOGI("TOTAL              137410          8061230            108415\n");
+    LOGI("------------------------------------------------------------\n");
+    LOGI("0x6f817d58          43790          2641120                 0               2284             139502     java.lang.String\n");
+    LOGI("0x6f7fdd30          14120          1398440                 0               1310             128716     long[]\n");
+    LOGI("0x6f7992c0          12260           486520                 0                982              40117     java.lang.Object[]\n");
 }
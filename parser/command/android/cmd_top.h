@@ -34,6 +34,9 @@ public:
         int num;
         int order;
         bool show;
+        int group;
+        double sample;
+        uint64_t seed;
         int obj_each_flags;
         int ref_each_flags;
     };
@@ -42,12 +45,6 @@ public:
     int prepare(int argc, char* const argv[]);
     void usage();
 
-    class Pair {
-    public:
-        uint64_t alloc_count;
-        uint64_t shallow_size;
-        uint64_t native_size;
-    };
 private:
     Options options;
 };
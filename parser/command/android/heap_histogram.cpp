@@ -0,0 +1,135 @@
+/*
+ * Copyright (C) 2024-present, Guanyou.Chen. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "logger/log.h"
+#include "command/android/heap_histogram.h"
+#include "common/exception.h"
+#include <inttypes.h>
+#include <algorithm>
+
+uint64_t HeapHistogram::Entry::Value(int column) const {
+    switch (column) {
+        case COLUMN_SHALLOW: return shallow_size;
+        case COLUMN_NATIVE: return native_size;
+        default: return alloc_count;
+    }
+}
+
+void HeapHistogram::Entry::Merge(const Entry& other) {
+    alloc_count += other.alloc_count;
+    shallow_size += other.shallow_size;
+    native_size += other.native_size;
+}
+
+void HeapHistogram::AddNative(uint64_t klass, uint64_t native) {
+    auto it = entries.find(klass);
+    if (it != entries.end())
+        it->second.native_size += native;
+}
+
+void HeapHistogram::Merge(const HeapHistogram& other) {
+    for (const auto& value : other.entries)
+        entries[value.first].Merge(value.second);
+}
+
+void HeapHistogram::Merge(const HeapHistogram& other, double scale) {
+    for (const auto& value : other.entries) {
+        Entry& entry = entries[value.first];
+        entry.alloc_count += static_cast<uint64_t>(value.second.alloc_count * scale + 0.5);
+        entry.shallow_size += static_cast<uint64_t>(value.second.shallow_size * scale + 0.5);
+        entry.native_size += static_cast<uint64_t>(value.second.native_size * scale + 0.5);
+    }
+}
+
+HeapHistogram HeapHistogram::GroupBy(int by) {
+    HeapHistogram result;
+    result.group = by;
+    if (by == GROUP_CLASS) {
+        result.entries = entries;
+        return result;
+    }
+
+    std::unordered_map<std::string, uint64_t> packages;
+    for (const auto& value : entries) {
+        art::mirror::Class thiz = value.first;
+        uint64_t key = KEY_UNKNOWN;
+        try {
+            if (by == GROUP_PACKAGE) {
+                std::string descriptor = thiz.CachedDescriptor();
+                std::size_t pos = descriptor.find_last_of('.');
+                std::string package = pos != std::string::npos ? descriptor.substr(0, pos) : "";
+                auto it = packages.find(package);
+                if (it == packages.end()) {
+                    key = result.names.size();
+                    packages[package] = key;
+                    result.names.push_back(package);
+                } else {
+                    key = it->second;
+                }
+            } else {
+                key = thiz.GetClassLoader().Ptr();
+            }
+        } catch (InvalidAddressException& e) {
+            LOGD("Unknown group of class 0x%" PRIx64 "\n", thiz.Ptr());
+        }
+        result.entries[key].Merge(value.second);
+    }
+    return result;
+}
+
+HeapHistogram::Entry HeapHistogram::Total() {
+    Entry total = {0, 0, 0};
+    for (const auto& value : entries)
+        total.Merge(value.second);
+    return total;
+}
+
+std::vector<HeapHistogram::Row> HeapHistogram::Top(uint32_t k, int column) {
+    std::vector<Row> rows(entries.begin(), entries.end());
+    auto compare = [column](const Row& a, const Row& b) -> bool {
+        uint64_t va = a.second.Value(column);
+        uint64_t vb = b.second.Value(column);
+        return va != vb ? va > vb : a.first < b.first;
+    };
+    k = std::min<uint32_t>(k, rows.size());
+    std::partial_sort(rows.begin(), rows.begin() + k, rows.end(), compare);
+    rows.resize(k);
+    return rows;
+}
+
+std::string HeapHistogram::Name(uint64_t key) {
+    if (group != GROUP_CLASS && key == KEY_UNKNOWN)
+        return "<unknown>";
+
+    try {
+        switch (group) {
+            case GROUP_PACKAGE:
+                return key < names.size() && names[key].length() ? names[key] : "<default>";
+            case GROUP_CLASSLOADER: {
+                if (!key) return "BootClassLoader";
+                art::mirror::Object loader = key;
+                art::mirror::Class thiz = loader.GetClass();
+                return thiz.CachedDescriptor();
+            }
+            default: {
+                art::mirror::Class thiz = key;
+                return thiz.CachedDescriptor();
+            }
+        }
+    } catch (InvalidAddressException& e) {}
+    return "";
+}
@@ -0,0 +1,84 @@
+/*
+ * Copyright (C) 2024-present, Guanyou.Chen. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef PARSER_COMMAND_ANDROID_HEAP_HISTOGRAM_H_
+#define PARSER_COMMAND_ANDROID_HEAP_HISTOGRAM_H_
+
+#include "runtime/mirror/class.h"
+#include <stdint.h>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/*
+ * Per-class allocation histogram. Rows are hash aggregated by class
+ * pointer, GroupBy folds them into packages or class loaders, Top picks
+ * the k largest rows of a column by partial sort. Histograms built by
+ * separate walkers can be merged.
+ */
+class HeapHistogram {
+public:
+    static constexpr int COLUMN_ALLOC = 0;
+    static constexpr int COLUMN_SHALLOW = 1;
+    static constexpr int COLUMN_NATIVE = 2;
+
+    static constexpr int GROUP_CLASS = 0;
+    static constexpr int GROUP_PACKAGE = 1;
+    static constexpr int GROUP_CLASSLOADER = 2;
+
+    // group key of classes whose package or loader can't be read.
+    static constexpr uint64_t KEY_UNKNOWN = UINT64_MAX;
+
+    struct Entry {
+        uint64_t alloc_count;
+        uint64_t shallow_size;
+        uint64_t native_size;
+
+        uint64_t Value(int column) const;
+        void Merge(const Entry& other);
+    };
+    typedef std::pair<uint64_t, Entry> Row;
+
+    HeapHistogram() : group(GROUP_CLASS) {}
+
+    inline void Add(uint64_t klass, uint64_t shallow) {
+        Entry& entry = entries[klass];
+        entry.alloc_count += 1;
+        entry.shallow_size += shallow;
+    }
+    // only joins classes already seen
+    void AddNative(uint64_t klass, uint64_t native);
+    void Merge(const HeapHistogram& other);
+    // merge rows multiplied by scale, used to extrapolate a sampled walk
+    void Merge(const HeapHistogram& other, double scale);
+    HeapHistogram GroupBy(int by);
+    Entry Total();
+    std::vector<Row> Top(uint32_t k, int column);
+    // class descriptor, package name or class loader
+    std::string Name(uint64_t key);
+
+    inline int Group() { return group; }
+    inline uint32_t Size() { return entries.size(); }
+private:
+    int group;
+    std::unordered_map<uint64_t, Entry> entries;
+    // package names, keyed by index
+    std::vector<std::string> names;
+};
+
+#endif // PARSER_COMMAND_ANDROID_HEAP_HISTOGRAM_H_
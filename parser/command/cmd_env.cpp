@@ -19,12 +19,15 @@
 #include "runtime/cache_helpers.h"
 #include "command/cmd_env.h"
 #include "command/env.h"
+#include "command/session.h"
 #include "api/core.h"
 #include "api/elf.h"
 #include "common/elf.h"
 #include "common/disassemble/capstone.h"
+#include "common/xz/seekable.h"
 #include "base/utils.h"
 #include "base/macros.h"
+#include "base/time_profile.h"
 #include <linux/elf.h>
 #include <unistd.h>
 #include <getopt.h>
@@ -42,12 +45,31 @@ static EnvOption env_option[] = {
     { "core", EnvCommand::showCoreEnv },
     { "offset", EnvCommand::onOffsetChanged },
     { "size", EnvCommand::onSizeChanged },
+    { "save-session", EnvCommand::onSaveSession },
 };
 
 int EnvCommand::main(int argc, char* const argv[]) {
     if (!(argc > 1))
         return dumpEnv();
 
+    if (argv[1][0] == '-') {
+        int opt;
+        int option_index = 0;
+        optind = 0; // reset
+        static struct option long_options[] = {
+            {"startup-profile", no_argument, 0, 1},
+            {0,                 0,           0, 0},
+        };
+
+        while ((opt = getopt_long(argc, argv, "",
+                    long_options, &option_index)) != -1) {
+            switch (opt) {
+                case 1: return showStartupProfile();
+            }
+        }
+        return 0;
+    }
+
     int count = sizeof(env_option)/sizeof(env_option[0]);
     for (int index = 0; index < count; ++index) {
         if (!strcmp(argv[1], env_option[index].cmd)) {
@@ -233,6 +255,7 @@ int EnvCommand::showCoreEnv(int argc, char* const argv[]) {
         {"num",    required_argument, 0,'n'},
         {"quick-load", no_argument,   0, 4},
         {"note",   no_argument,       0, 5},
+        {"seekable-cache", required_argument, 0, 6},
         {"clean-cache",   no_argument, 0, 'c'},
         {0,        0,                 0, 0},
     };
@@ -251,6 +274,9 @@ int EnvCommand::showCoreEnv(int argc, char* const argv[]) {
                 break;
             case 4: return showLoadEnv(true);
             case 5: return showNoteEnv();
+            case 6:
+                xz::Seekable::SetCacheLimit(Utils::atol(optarg));
+                return 0;
             case 'n':
                 num = std::atoi(optarg);
                 break;
@@ -268,6 +294,7 @@ int EnvCommand::showCoreEnv(int argc, char* const argv[]) {
         LOGI("  * mLoad: " ANSI_COLOR_LIGHTMAGENTA "%ld\n" ANSI_COLOR_RESET, CoreApi::GetLoads(false).size());
         LOGI("  * mQuickLoad: " ANSI_COLOR_LIGHTMAGENTA "%ld\n" ANSI_COLOR_RESET, CoreApi::GetLoads(true).size());
         LOGI("  * mLinkMap: " ANSI_COLOR_LIGHTMAGENTA "%ld\n" ANSI_COLOR_RESET, CoreApi::GetLinkMaps().size());
+        LOGI("  * seekable cache: " ANSI_COLOR_LIGHTMAGENTA "0x%" PRIx64 "\n" ANSI_COLOR_RESET, xz::Seekable::GetCacheLimit());
     }
     return 0;
 }
@@ -414,10 +441,34 @@ int EnvCommand::onSizeChanged(int argc, char* const argv[]) {
     return 0;
 }
 
+int EnvCommand::onSaveSession(int argc, char* const argv[]) {
+    if (!CoreApi::IsReady())
+        return 0;
+
+    if (argc < 2) {
+        LOGI("Usage: env save-session <FILE>\n");
+        return 0;
+    }
+    Session::Save(argv[1]);
+    return 0;
+}
+
+int EnvCommand::showStartupProfile() {
+    LOGI(ANSI_COLOR_LIGHTRED "  Count        Time(ms)  Phase\n" ANSI_COLOR_RESET);
+    auto callback = [&](TimeProfile::Phase& phase) {
+        LOGI("%7" PRId64 "  " ANSI_COLOR_LIGHTMAGENTA "%14.3f" ANSI_COLOR_RESET "  %s\n",
+             phase.count, phase.nanos / 1000000.0, phase.name.c_str());
+    };
+    TimeProfile::Foreach(callback);
+    return 0;
+}
+
 void EnvCommand::usage() {
-    LOGI("Usage: env <COMMAND> [OPTION] ...\n");
+    LOGI("Usage: env [<COMMAND>] [OPTION] ...\n");
     LOGI("Command:\n");
-    LOGI("    config  logger  art  core\n");
+    LOGI("    config  logger  art  core  save-session\n");
+    LOGI("Option:\n");
+    LOGI("        --startup-profile  show time cost of core load and init phases\n");
     ENTER();
 
     LOGI("Usage: env config <OPTION> ..\n");
@@ -448,7 +499,7 @@ void EnvCommand::usage() {
 
     LOGI("Usage: env art [OPTION] ...\n");
     LOGI("Option:\n");
-    LOGI("    -c, --clean-cache     clean art::Runtime cache\n");
+    LOGI("    -c, --clean-cache     clean art::Runtime and class descriptor cache\n");
     LOGI("    -e, --entry-points    show art quick entry points\n");
     LOGI("    -n, --nterp           show art nterp cache\n");
     ENTER();
@@ -478,6 +529,8 @@ void EnvCommand::usage() {
     LOGI("        --quick-load      show corefile quick load segments\n");
     LOGI("        --arm <thumb|arm> set arm disassemble mode\n");
     LOGI("        --crc             check consistency of mmap file data\n");
+    LOGI("        --seekable-cache <SIZE>  set seekable core decoded cache size,\n");
+    LOGI("                          trimmed between commands, not during one\n");
     LOGI("    -c, --clean-cache     clean link_map cache\n");
     ENTER();
     LOGI("core-parser> env core\n");
@@ -487,4 +540,25 @@ void EnvCommand::usage() {
     LOGI("  * mLoad: 1985\n");
     LOGI("  * mQuickLoad: 1802\n");
     LOGI("  * mLinkMap: 271\n");
+    LOGI("  * seekable cache: 0x20000000\n");
+    ENTER();
+
+    LOGI("Usage: env save-session <FILE>\n");
+    ENTER();
+    LOGI("core-parser> env save-session /tmp/tmp.core.session\n");
+    LOGI("Saved session /tmp/tmp.core.session\n");
+    ENTER();
+
+    LOGI("Usage: env --startup-profile\n");
+    ENTER();
+    LOGI("core-parser> env --startup-profile\n");
+    LOGI("  Count        Time(ms)  Phase\n");
+    LOGI("      1          95.114  core: load\n");
+    LOGI("      1           0.071  llvm: init\n");
+    LOGI("      1           0.112  android: preload\n");
+    LOGI("     17          38.407  android: property\n");
+    LOGI("      1          38.626  android: properties\n");
+    LOGI("      1          38.851  android: init\n");
+    LOGI("      1           0.954  android: art offsets\n");
+    LOGI("    206          12.330  core: dynsyms\n");
 }
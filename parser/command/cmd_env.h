@@ -30,6 +30,8 @@ public:
     static int onLoggerChanged(int argc, char* const argv[]);
     static int onOffsetChanged(int argc, char* const argv[]);
     static int onSizeChanged(int argc, char* const argv[]);
+    static int onSaveSession(int argc, char* const argv[]);
+    static int showStartupProfile();
     static int showArtEnv(int argc, char* const argv[]);
     static int showCoreEnv(int argc, char* const argv[]);
     static int showLoadEnv(bool quick);
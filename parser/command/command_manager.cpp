@@ -43,9 +43,14 @@
 #include "command/android/cmd_search.h"
 #include "command/android/cmd_class.h"
 #include "command/android/cmd_top.h"
+#include "command/android/cmd_heapdiff.h"
 #include "command/android/cmd_space.h"
 #include "command/android/cmd_dex.h"
 #include "command/android/cmd_method.h"
+#include "command/android/cmd_pc2method.h"
+#include "command/android/cmd_jit.h"
+#include "command/android/cmd_oat.h"
+#include "command/android/cmd_exceptions.h"
 #include "command/android/cmd_logcat.h"
 #include "command/android/cmd_dumpsys.h"
 #include "command/android/cmd_fdtrack.h"
@@ -119,9 +124,14 @@ void CommandManager::Init() {
     CommandManager::PushInlineCommand(new SearchCommand());
     CommandManager::PushInlineCommand(new ClassCommand());
     CommandManager::PushInlineCommand(new TopCommand());
+    CommandManager::PushInlineCommand(new HeapDiffCommand());
     CommandManager::PushInlineCommand(new SpaceCommand());
     CommandManager::PushInlineCommand(new DexCommand());
     CommandManager::PushInlineCommand(new MethodCommand());
+    CommandManager::PushInlineCommand(new Pc2MethodCommand());
+    CommandManager::PushInlineCommand(new JitCommand());
+    CommandManager::PushInlineCommand(new OatCommand());
+    CommandManager::PushInlineCommand(new ExceptionsCommand());
     CommandManager::PushInlineCommand(new LogcatCommand());
     CommandManager::PushInlineCommand(new DumpsysCommand());
     CommandManager::PushInlineCommand(new FdtrackCommand());
@@ -27,6 +27,8 @@
 #include "runtime/stack.h"
 #include "runtime/monitor.h"
 #include "runtime/thread.h"
+#include "runtime/code_index.h"
+#include "runtime/jit/jit_code_cache.h"
 #include "android.h"
 #include <unistd.h>
 #include <getopt.h>
@@ -38,6 +40,7 @@ int BacktraceCommand::prepare(int argc, char* const argv[]) {
 
     options.dump_all = false;
     options.dump_detail = false;
+    options.dump_managed = false;
     options.dump_fps.clear();
     options.threads.clear();
 
@@ -47,11 +50,12 @@ int BacktraceCommand::prepare(int argc, char* const argv[]) {
     static struct option long_options[] = {
         {"all",    no_argument,       0,  'a'},
         {"detail", no_argument,       0,  'd'},
+        {"managed", no_argument,      0,  'm'},
         {"fp",     required_argument, 0,  'f'},
         {0,        0,                 0,   0 },
     };
 
-    while ((opt = getopt_long(argc, (char* const*)argv, "adf:",
+    while ((opt = getopt_long(argc, (char* const*)argv, "admf:",
                 long_options, &option_index)) != -1) {
         switch (opt) {
             case 'a':
@@ -60,6 +64,9 @@ int BacktraceCommand::prepare(int argc, char* const argv[]) {
             case 'd':
                 options.dump_detail = true;
                 break;
+            case 'm':
+                options.dump_managed = true;
+                break;
             case 'f': {
                 std::unique_ptr<char[], void(*)(void*)> newpath(strdup(optarg), free);
                 char *token = strtok(newpath.get(), ":");
@@ -75,6 +82,9 @@ int BacktraceCommand::prepare(int argc, char* const argv[]) {
 #if defined(__AOSP_PARSER__)
     Android::Prepare();
     Android::OatPrepare();
+    art::jit::JitCodeCache::PrepareCodeEntries();
+    if (options.dump_managed && Android::IsSdkReady() && art::Runtime::Current().Ptr())
+        art::CodeIndex::Prepare();
 #endif
     return Command::ONCHLD;
 }
@@ -188,6 +198,32 @@ void BacktraceCommand::DumpTrace() {
     }
 }
 
+#if defined(__AOSP_PARSER__)
+// name oat, jit and nterp frames that the unwinder found without symbol.
+static std::string ManagedFrameDesc(uint64_t pc) {
+    std::string desc;
+    if (!Android::IsSdkReady() || !art::Runtime::Current().Ptr())
+        return desc;
+
+    try {
+        const art::CodeIndex::Entry* entry = art::CodeIndex::Lookup(pc);
+        if (!entry)
+            return desc;
+
+        desc.append("[").append(art::CodeIndex::TypeToString(entry->type)).append("] ");
+        if (entry->method) {
+            art::ArtMethod method = entry->method;
+            desc.append(method.ColorPrettyMethodSimple());
+        } else {
+            desc.append(entry->name);
+        }
+    } catch(InvalidAddressException& e) {
+        desc.clear();
+    }
+    return desc;
+}
+#endif
+
 void BacktraceCommand::DumpNativeStack(void *thread, ThreadApi* api) {
     if (!api) {
         LOGI("  (NOT EXIST THREAD)\n");
@@ -205,6 +241,11 @@ void BacktraceCommand::DumpNativeStack(void *thread, ThreadApi* api) {
             if (offset && native_frame->GetMethodOffset())
                 method_desc.append("+").append(Utils::ToHex(offset));
 
+#if defined(__AOSP_PARSER__)
+            if (!method_desc.length() && options.dump_managed)
+                method_desc = ManagedFrameDesc(native_frame->GetFramePc() & CoreApi::GetVabitsMask());
+#endif
+
             if (!method_desc.length() && native_frame->GetLinkMap()
                     && native_frame->GetLinkMap()->begin()) {
                 method_desc.append(native_frame->GetLibrary());
@@ -437,6 +478,7 @@ void BacktraceCommand::usage() {
     LOGI("Option:\n");
     LOGI("    -a, --all           show thread stack.\n");
     LOGI("    -d, --detail        show more info.\n");
+    LOGI("    -m, --managed       name managed frames found in native stack.\n");
     LOGI("        --fp <FP_REG>   only support arm64\n");
     ENTER();
     LOGI("core-parser> bt\n");
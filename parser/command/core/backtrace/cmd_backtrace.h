@@ -33,6 +33,7 @@ public:
     struct Options : Command::Options {
         bool dump_all;
         bool dump_detail;
+        bool dump_managed;
         std::vector<uint64_t> dump_fps;
         std::vector<std::unique_ptr<ThreadRecord>> threads;
     };
@@ -26,6 +26,7 @@
 #include "command/core/backtrace/cmd_backtrace.h"
 #include "runtime/thread_list.h"
 #include "runtime/stack.h"
+#include "runtime/jit/jit_code_cache.h"
 #include "dalvik_vm_bytecode.h"
 #include "dexdump/dexdump.h"
 #include "common/disassemble/capstone.h"
@@ -71,6 +72,7 @@ int FrameCommand::prepare(int argc, char* const argv[]) {
 #if defined(__AOSP_PARSER__)
     Android::Prepare();
     Android::OatPrepare();
+    art::jit::JitCodeCache::PrepareCodeEntries();
 #endif
 
     return Command::ONCHLD;
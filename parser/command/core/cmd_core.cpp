@@ -18,6 +18,12 @@
 #include "command/env.h"
 #include "command/core/cmd_core.h"
 #include "api/core.h"
+#include "common/xz/seekable.h"
+#include "base/utils.h"
+#include <stdlib.h>
+#include <limits.h>
+#include <unistd.h>
+#include <getopt.h>
 
 int CoreCommand::Load(const char* path) {
     return Load(path, false);
@@ -28,9 +34,121 @@ int CoreCommand::Load(const char* path, bool remote) {
 }
 
 int CoreCommand::main(int argc, char* const argv[]) {
+    if (!(argc > 1))
+        return List();
+
+    if (!strcmp(argv[1], "repack"))
+        return Repack(argc - 1, &argv[1]);
+
+    if (!strcmp(argv[1], "list"))
+        return List();
+
+    if (!strcmp(argv[1], "add")) {
+        if (argc > 2) return Add(argv[2]);
+        return 0;
+    }
+
+    if (!strcmp(argv[1], "switch")) {
+        if (argc > 2) {
+            char* end = nullptr;
+            long idx = strtol(argv[2], &end, 10);
+            if (end == argv[2] || *end != '\0' || idx < 0 || idx > INT_MAX) {
+                LOGE("Invalid core index %s\n", argv[2]);
+                return 0;
+            }
+            return Switch(idx);
+        }
+        return 0;
+    }
+
     return Load(argv[1]);
 }
 
+int CoreCommand::Repack(int argc, char* const argv[]) {
+    int opt;
+    int option_index = 0;
+    optind = 0; // reset
+    static struct option long_options[] = {
+        {"block",   required_argument, 0, 'b'},
+        {"level",   required_argument, 0, 'l'},
+        {0,         0,                 0,  0 },
+    };
+
+    uint64_t block_size = xz::Seekable::kDefaultBlockSize;
+    uint32_t preset = xz::Seekable::kDefaultPreset;
+    while ((opt = getopt_long(argc, argv, "b:l:",
+                long_options, &option_index)) != -1) {
+        switch (opt) {
+            case 'b':
+                block_size = Utils::atol(optarg);
+                break;
+            case 'l':
+                preset = std::atoi(optarg);
+                break;
+        }
+    }
+
+    if (optind + 1 >= argc) {
+        LOGE("Usage: core repack <COREFILE> <OUTPUT> [OPTION]\n");
+        return 0;
+    }
+
+    if (!block_size || preset > 9) {
+        LOGE("Invalid block size 0x%" PRIx64 " or level %d\n", block_size, preset);
+        return 0;
+    }
+
+    xz::Seekable::Repack(argv[optind], argv[optind + 1], block_size, preset);
+    return 0;
+}
+
+int CoreCommand::Add(const char* path) {
+    int slots = Env::NumSlots();
+    Env::NewSlot();
+    int ret = Load(path);
+    if (!ret && Env::NumSlots() > slots)
+        Env::DropSlot();
+    return ret;
+}
+
+int CoreCommand::Switch(int idx) {
+    if (Env::SwitchSlot(idx))
+        LOGI("Switch core(%d) %s\n", idx, CoreApi::GetName());
+    return 0;
+}
+
+int CoreCommand::List() {
+    auto callback = [](int idx, const char* name) -> bool {
+        if (idx == Env::CurrentSlot()) {
+            LOGI("* %-3d " ANSI_COLOR_LIGHTGREEN "%s\n" ANSI_COLOR_RESET, idx, name);
+        } else {
+            LOGI("  %-3d %s\n", idx, name);
+        }
+        return false;
+    };
+    Env::ForeachSlot(callback);
+    return 0;
+}
+
 void CoreCommand::usage() {
-    LOGI("Usage: core /tmp/default.core\n");
+    LOGI("Usage: core <COREFILE>\n");
+    LOGI("       core add <COREFILE>\n");
+    LOGI("       core switch <INDEX>\n");
+    LOGI("       core list\n");
+    LOGI("       core repack <COREFILE> <OUTPUT> [OPTION]\n");
+    LOGI("Option:\n");
+    LOGI("    -b, --block <SIZE>    xz block size (default 0x100000), same as xz -T0 --block-size\n");
+    LOGI("    -l, --level <0~9>     xz compress level (default 6)\n");
+    ENTER();
+    LOGI("core-parser> core /tmp/default.core\n");
+    LOGI("core-parser> core repack /tmp/default.core /tmp/default.core.xz\n");
+    LOGI("Repack /tmp/default.core -> /tmp/default.core.xz (0x2e5b4000 -> 0x7a3c1e8)\n");
+    LOGI("core-parser> core /tmp/default.core.xz\n");
+    LOGI("Seekable core /tmp/default.core.xz (xz blocks 742, cache 0x20000000)\n");
+    LOGI("core-parser> core add /tmp/second.core\n");
+    LOGI("core-parser> core list\n");
+    LOGI("  0   /tmp/default.core.xz\n");
+    LOGI("* 1   /tmp/second.core\n");
+    LOGI("core-parser> core switch 0\n");
+    LOGI("Switch core(0) /tmp/default.core.xz\n");
 }
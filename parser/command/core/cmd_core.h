@@ -27,6 +27,10 @@ public:
     void usage();
     static int Load(const char* path);
     static int Load(const char* path, bool remote);
+    static int Repack(int argc, char* const argv[]);
+    static int Add(const char* path);
+    static int Switch(int idx);
+    static int List();
 };
 
 #endif // PARSER_COMMAND_CORE_CMD_CORE_H_
@@ -114,7 +114,7 @@ int DisassembleCommand::main(int argc, char* const argv[]) {
                         capstone::Disassember::Option::MODE_THUMB : capstone::Disassember::Option::MODE_ARM);
             }
 
-            uint8_t* data = reinterpret_cast<uint8_t*>(CoreApi::GetReal(vaddr, options.read_opt));
+            uint8_t* data = reinterpret_cast<uint8_t*>(CoreApi::GetReal(vaddr, entry.size, options.read_opt));
             if (data) {
                 LOGI(ANSI_COLOR_YELLOW "%s" ANSI_COLOR_RESET ": [%" PRIx64 ", %" PRIx64 "]\n",
                         d_symbol.c_str(), vaddr, vaddr + entry.size);
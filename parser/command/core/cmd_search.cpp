@@ -128,6 +128,7 @@ void CoreSearchCommand::WalkLoadBlock(const char* value, int flags) {
                 const_cast<char*>("grep"),
                 const_cast<char*>(value),
                 nullptr};
+            CoreApi::PrefetchScope prefetch(block->vaddr(), block->size());
             CommandManager::Execute(argv[0], argc, argv);
         }
         return false;
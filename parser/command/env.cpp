@@ -15,12 +15,15 @@
  */
 
 #include "logger/log.h"
+#include "base/time_profile.h"
 #include "command/env.h"
 #include "api/core.h"
 #include "android.h"
 #include "llvm.h"
 
 std::unique_ptr<Env> Env::INSTANCE = nullptr;
+std::vector<std::unique_ptr<Env::Slot>> Env::kSlots;
+int Env::kCurrent = 0;
 
 bool Env::setCurrentPid(int p) {
     ThreadApi *api = CoreApi::FindThread(p);
@@ -32,7 +35,7 @@ bool Env::setCurrentPid(int p) {
     return true;
 }
 
-void Env::init() {
+void Env::init(int sdk, int oat) {
     auto callback = [&](ThreadApi *api) -> bool {
         pid = api->pid();
         if (CoreApi::IsRemote())
@@ -44,17 +47,107 @@ void Env::init() {
     CoreApi::Dump();
     Env::Dump();
 
-    LLVM::Init();
+    {
+        TimeProfile::Scope scope("llvm: init");
+        LLVM::Init();
+    }
 
 #if defined(__AOSP_PARSER__)
-    Android::Init();
+    {
+        TimeProfile::Scope scope("android: init");
+        Android::Init(sdk, oat);
+    }
     Android::Dump();
 #endif
 }
 
-void Env::Init() {
+void Env::InitWith(int sdk, int oat) {
+    if (kSlots.empty()) {
+        kSlots.push_back(std::make_unique<Slot>());
+        kCurrent = 0;
+    }
     INSTANCE = std::make_unique<Env>();
-    INSTANCE->init();
+    INSTANCE->init(sdk, oat);
+}
+
+void Env::Park() {
+    Slot* slot = kSlots[kCurrent].get();
+    slot->name = CoreApi::IsReady() ? CoreApi::GetName() : "";
+    slot->bits = CoreApi::IsReady() ? CoreApi::Bits() : 0;
+    slot->sdk = 0;
+    slot->oat = 0;
+#if defined(__AOSP_PARSER__)
+    if (Android::IsReady()) {
+        slot->sdk = Android::Sdk();
+        slot->oat = Android::Oat();
+    }
+    slot->android = Android::Detach();
+#endif
+    slot->env = std::move(INSTANCE);
+    slot->core = CoreApi::Detach();
+}
+
+void Env::Restore(int idx) {
+    Slot* prev = kSlots[kCurrent].get();
+    Slot* slot = kSlots[idx].get();
+    CoreApi::Attach(slot->core);
+    LLVM::Init();
+#if defined(__AOSP_PARSER__)
+    bool reload = prev->bits != slot->bits
+                      || prev->sdk != slot->sdk
+                      || prev->oat != slot->oat;
+    Android::Attach(slot->android, reload);
+#endif
+    INSTANCE = std::move(slot->env);
+    kCurrent = idx;
+}
+
+void Env::NewSlot() {
+    if (kSlots.empty() || !CoreApi::IsReady())
+        return;
+
+    Park();
+    kSlots.push_back(std::make_unique<Slot>());
+    kCurrent = kSlots.size() - 1;
+}
+
+void Env::DropSlot() {
+    if (kSlots.size() < 2)
+        return;
+
+    int prev = kCurrent;
+    Park();
+    Restore(kCurrent ? kCurrent - 1 : 1);
+    kSlots.erase(kSlots.begin() + prev);
+    if (kCurrent > prev) kCurrent--;
+}
+
+bool Env::SwitchSlot(int idx) {
+    if (idx < 0 || idx >= kSlots.size()) {
+        LOGE("Invalid core index %d\n", idx);
+        return false;
+    }
+
+    if (idx == kCurrent)
+        return true;
+
+    if (!kSlots[idx]->core) {
+        LOGE("Core index %d not loaded\n", idx);
+        return false;
+    }
+
+    Park();
+    Restore(idx);
+    return true;
+}
+
+void Env::ForeachSlot(std::function<bool (int idx, const char* name)> callback) {
+    for (int idx = 0; idx < kSlots.size(); ++idx) {
+        const char* name = idx == kCurrent ?
+                (CoreApi::IsReady() ? CoreApi::GetName() : "") : kSlots[idx]->name.c_str();
+        if (callback(idx, name))
+            break;
+    }
 }
 
 void Env::Dump() {
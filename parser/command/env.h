@@ -18,6 +18,9 @@
 #define PARSER_COMMAND_ENV_H_
 
 #include <memory>
+#include <string>
+#include <vector>
+#include <functional>
 
 #if defined(__ANDROID__)
 #define CURRENT_DIR_DEF "/data/local/tmp"
@@ -25,22 +28,52 @@
 #define CURRENT_DIR_DEF "."
 #endif
 
+class CoreApi;
+class Android;
+
 class Env {
 public:
+    /*
+     * Every loaded core owns one slot, the current slot is held by the
+     * CoreApi/Android/Env singletons and the others are parked here.
+     */
+    struct Slot {
+        std::string name;
+        std::unique_ptr<CoreApi> core;
+        std::unique_ptr<Android> android;
+        std::unique_ptr<Env> env;
+        int bits = 0;
+        int sdk = 0;
+        int oat = 0;
+    };
+
     Env() : pid(0), remote_pid(0) {}
-    void init();
+    void init(int sdk, int oat);
     bool setCurrentPid(int p);
     inline int current() { return pid; }
     inline int remote() { return remote_pid; }
 
-    static void Init();
+    static void Init() { InitWith(0, 0); }
+    // restored session hands in its sdk and oat, skips probing them again
+    static void InitWith(int sdk, int oat);
     static void Dump();
     static bool SetCurrentPid(int p) { return INSTANCE->setCurrentPid(p); }
     static int CurrentPid() { return INSTANCE->current(); }
     static int CurrentRemotePid() { return INSTANCE->remote(); }
     static const char* CurrentDir() { return CURRENT_DIR_DEF; }
+
+    static int CurrentSlot() { return kCurrent; }
+    static int NumSlots() { return kSlots.size(); }
+    static void NewSlot();
+    static void DropSlot();
+    static bool SwitchSlot(int idx);
+    static void ForeachSlot(std::function<bool (int idx, const char* name)> callback);
 private:
+    static void Park();
+    static void Restore(int idx);
     static std::unique_ptr<Env> INSTANCE;
+    static std::vector<std::unique_ptr<Slot>> kSlots;
+    static int kCurrent;
     int pid;
     int remote_pid;
 };
@@ -0,0 +1,366 @@
+/*
+ * Copyright (C) 2024-present, Guanyou.Chen. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "logger/log.h"
+#include "base/utils.h"
+#include "command/session.h"
+#include "command/env.h"
+#include "api/core.h"
+#include "common/exception.h"
+#if defined(__AOSP_PARSER__)
+#include "android.h"
+#include "runtime/runtime.h"
+#include "runtime/gc/heap.h"
+#include "runtime/thread_list.h"
+#include "runtime/class_index.h"
+#include "runtime/method_index.h"
+#endif
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+#include <unordered_map>
+#include <unordered_set>
+
+static constexpr int SESSION_LINE_MAX = 4096;
+
+uint32_t Session::CoreCRC32() {
+    uint64_t size = CoreApi::GetSize();
+    uint64_t header = size < 4096 ? size : 4096;
+    std::vector<std::unique_ptr<NoteBlock>>& notes = CoreApi::GetNotes();
+    if (notes.size() && notes[0]->offset() < size)
+        header = notes[0]->offset();
+
+    uint32_t crc = Utils::CRC32(reinterpret_cast<uint8_t *>(CoreApi::GetBegin()), header);
+    for (const auto& note : notes) {
+        if (!note->begin(NoteBlock::OPT_READ_OR))
+            continue;
+        crc ^= Utils::CRC32(reinterpret_cast<uint8_t *>(note->begin(NoteBlock::OPT_READ_OR)), note->realSize());
+    }
+
+    // the last page of every slice, so the core tail is always sampled.
+    uint64_t slice = size / SAMPLES;
+    for (int i = 0; i < SAMPLES && slice >= SAMPLE_SIZE; ++i) {
+        uint64_t raddr = CoreApi::GetBegin() + (i + 1) * slice - SAMPLE_SIZE;
+        CoreApi::Fill(raddr, SAMPLE_SIZE);
+        crc = ((crc << 1) | (crc >> 31)) ^ Utils::CRC32(reinterpret_cast<uint8_t *>(raddr), SAMPLE_SIZE);
+    }
+    return crc;
+}
+
+bool Session::Save(const char* file) {
+    if (!CoreApi::IsReady() || !file)
+        return false;
+
+    FILE* fp = fopen(file, "w");
+    if (!fp) {
+        LOGE("Can't open %s\n", file);
+        return false;
+    }
+
+    fprintf(fp, "%s %d\n", MAGIC, VERSION);
+    fprintf(fp, "core %" PRIx64 " %x %s\n", CoreApi::GetSize(), CoreCRC32(), CoreApi::GetName());
+    fprintf(fp, "pid %d\n", Env::CurrentPid());
+
+    auto link_callback = [&](LinkMap* map) -> bool {
+        LoadBlock* block = map->block();
+        if (block && block->isMmapBlock())
+            fprintf(fp, "link %" PRIx64 " %" PRIx64 "\n", map->map(), map->begin());
+        return false;
+    };
+    CoreApi::ForeachLinkMap(link_callback);
+
+    auto mmap_callback = [&](LoadBlock* block) -> bool {
+        if (!block->isMmapBlock())
+            return false;
+        fprintf(fp, "mmap %" PRIx64 " %" PRIx64 " %" PRIx64 " %s\n",
+                block->vaddr(), block->GetMmapOffset(),
+                block->handle() ? block->handle()->map() : 0x0, block->name().c_str());
+        return false;
+    };
+    CoreApi::ForeachLoadBlock(mmap_callback, false);
+
+#if defined(__AOSP_PARSER__)
+    if (Android::IsSdkReady()) {
+        fprintf(fp, "sdk %d\n", Android::Sdk());
+        if (Android::IsOatReady())
+            fprintf(fp, "oat %d\n", Android::Oat());
+
+        try {
+            art::Runtime& runtime = art::Runtime::Current();
+            if (runtime.Ptr()) {
+                fprintf(fp, "runtime %" PRIx64 "\n", runtime.Ptr());
+                art::gc::Heap& heap = runtime.GetHeap();
+                if (heap.Ptr()) {
+                    fprintf(fp, "heap %" PRIx64 " %" PRIx64 " %" PRIx64 "\n", heap.Ptr(),
+                            heap.GetContinuousSpacesCache().Ptr(),
+                            heap.GetDiscontinuousSpacesCache().Ptr());
+                }
+                art::ThreadList& thread_list = runtime.GetThreadList();
+                if (thread_list.Ptr()) {
+                    fprintf(fp, "thread_list %" PRIx64 " %" PRIx64 "\n", thread_list.Ptr(),
+                            thread_list.GetListCache().Ptr());
+                }
+            }
+        } catch (InvalidAddressException& e) {
+            LOGW("art::Runtime not resolved, skip art session.\n");
+        }
+
+        // a name longer than a session line is left to the next build.
+        static constexpr uint32_t NAME_MAX_LENGTH = SESSION_LINE_MAX - 128;
+        if (art::ClassIndex::IsReady()) {
+            for (const auto& entry : art::ClassIndex::GetEntries()) {
+                if (entry.descriptor.length() < NAME_MAX_LENGTH)
+                    fprintf(fp, "class %" PRIx64 " %s\n", entry.klass, entry.descriptor.c_str());
+            }
+        }
+        if (art::MethodIndex::IsReady()) {
+            for (const auto& entry : art::MethodIndex::GetEntries()) {
+                if (entry.name.length() < NAME_MAX_LENGTH)
+                    fprintf(fp, "method %" PRIx64 " %" PRIx64 " %x %d %s\n", entry.method,
+                            entry.entry_point, entry.dex_method_idx, entry.code, entry.name.c_str());
+            }
+        }
+    }
+#endif
+
+    fclose(fp);
+    LOGI("Saved session %s\n", file);
+    return true;
+}
+
+static bool ReadHeader(FILE* fp, const char* file) {
+    char line[SESSION_LINE_MAX];
+    char magic[32];
+    int version = 0;
+    if (!fgets(line, sizeof(line), fp)
+            || sscanf(line, "%31s %d", magic, &version) != 2
+            || strcmp(magic, Session::MAGIC)) {
+        LOGE("%s is not session file.\n", file);
+        return false;
+    }
+    if (version != Session::VERSION) {
+        LOGE("Not support session version(%d).\n", version);
+        return false;
+    }
+    return true;
+}
+
+static char* ReadTail(char* line, int pos) {
+    char* tail = line + pos;
+    while (*tail == ' ') tail++;
+    tail[strcspn(tail, "\r\n")] = '\0';
+    return tail;
+}
+
+bool Session::CoreFile(const char* file, std::string* corefile) {
+    FILE* fp = fopen(file, "r");
+    if (!fp) {
+        LOGE("Can't open %s\n", file);
+        return false;
+    }
+
+    bool found = false;
+    if (ReadHeader(fp, file)) {
+        char line[SESSION_LINE_MAX];
+        while (fgets(line, sizeof(line), fp)) {
+            uint64_t size;
+            uint32_t crc;
+            int pos = 0;
+            if (sscanf(line, "core %" SCNx64 " %x%n", &size, &crc, &pos) == 2) {
+                *corefile = ReadTail(line, pos);
+                found = corefile->length() > 0;
+                break;
+            }
+        }
+    }
+    fclose(fp);
+    return found;
+}
+
+bool Session::LoadCore(const char* corefile, const char* file, bool remote) {
+    auto callback = [file]() {
+        Saved saved;
+        bool restored = Load(file, PHASE_CORE, &saved);
+        if (!restored) saved = Saved();
+        Env::InitWith(saved.sdk, saved.oat);
+        if (restored) Load(file, PHASE_ENV);
+    };
+    return CoreApi::Load(corefile, remote, callback);
+}
+
+bool Session::Load(const char* file, int phase, Saved* saved) {
+    if (!CoreApi::IsReady() || !file)
+        return false;
+
+    FILE* fp = fopen(file, "r");
+    if (!fp) {
+        LOGE("Can't open %s\n", file);
+        return false;
+    }
+
+    if (!ReadHeader(fp, file)) {
+        fclose(fp);
+        return false;
+    }
+
+    std::unordered_map<uint64_t, LinkMap*> maps;
+    auto map_callback = [&](LinkMap* map) -> bool {
+        maps[map->map()] = map;
+        return false;
+    };
+    CoreApi::ForeachLinkMap(map_callback);
+    std::unordered_set<LinkMap*> bound;
+#if defined(__AOSP_PARSER__)
+    std::vector<art::ClassIndex::Entry> classes;
+    std::vector<art::MethodIndex::Entry> methods;
+#endif
+
+    bool verified = false;
+    char line[SESSION_LINE_MAX];
+    try {
+        while (fgets(line, sizeof(line), fp)) {
+            char key[32];
+            int pos = 0;
+            if (sscanf(line, "%31s%n", key, &pos) != 1)
+                continue;
+
+            if (!strcmp(key, "core")) {
+                uint64_t size = 0x0;
+                uint32_t crc = 0x0;
+                if (sscanf(line, "core %" SCNx64 " %x", &size, &crc) != 2
+                        || size != CoreApi::GetSize()
+                        || ((phase & PHASE_CORE) && crc != CoreCRC32())) {
+                    LOGE("Session %s not match current core.\n", file);
+                    break;
+                }
+                verified = true;
+                continue;
+            }
+
+            if (!verified) {
+                LOGE("Session %s not found core record.\n", file);
+                break;
+            }
+
+            if (saved && !strcmp(key, "sdk"))
+                sscanf(line, "sdk %d", &saved->sdk);
+            else if (saved && !strcmp(key, "oat"))
+                sscanf(line, "oat %d", &saved->oat);
+
+            bool core_record = !strcmp(key, "link") || !strcmp(key, "mmap");
+            if (!(phase & (core_record ? PHASE_CORE : PHASE_ENV)))
+                continue;
+
+            if (!strcmp(key, "pid")) {
+                int pid = 0;
+                if (sscanf(line, "pid %d", &pid) == 1 && pid)
+                    Env::SetCurrentPid(pid);
+            } else if (!strcmp(key, "link")) {
+                uint64_t addr, begin;
+                if (sscanf(line, "link %" SCNx64 " %" SCNx64, &addr, &begin) != 2)
+                    continue;
+                auto it = maps.find(addr);
+                if (it != maps.end())
+                    it->second->GetAddrCache() = begin;
+            } else if (!strcmp(key, "mmap")) {
+                uint64_t vaddr, offset, addr;
+                if (sscanf(line, "mmap %" SCNx64 " %" SCNx64 " %" SCNx64 "%n", &vaddr, &offset, &addr, &pos) != 3)
+                    continue;
+                LoadBlock* block = CoreApi::FindLoadBlock(vaddr, false);
+                if (!block || block->vaddr() != vaddr)
+                    continue;
+                block->setMmapFile(ReadTail(line, pos), offset);
+                auto it = maps.find(addr);
+                if (block->isMmapBlock() && it != maps.end()) {
+                    block->bind(it->second);
+                    bound.insert(it->second);
+                }
+            }
+#if defined(__AOSP_PARSER__)
+            else if (!Android::IsReady()) {
+                continue;
+            } else if (!strcmp(key, "sdk")) {
+                int sdk = 0;
+                if (sscanf(line, "sdk %d", &sdk) == 1)
+                    Android::OnSdkChanged(sdk);
+            } else if (!strcmp(key, "oat")) {
+                int oat = 0;
+                if (sscanf(line, "oat %d", &oat) == 1)
+                    Android::OnOatChanged(oat);
+            } else if (!strcmp(key, "runtime")) {
+                uint64_t addr;
+                if (sscanf(line, "runtime %" SCNx64, &addr) == 1) {
+                    art::Runtime& runtime = Android::GetRuntime();
+                    if (runtime.Ptr()) runtime.CleanCache();
+                    runtime = addr;
+                }
+            } else if (!strcmp(key, "heap")) {
+                uint64_t addr, continuous, discontinuous;
+                if (sscanf(line, "heap %" SCNx64 " %" SCNx64 " %" SCNx64, &addr, &continuous, &discontinuous) != 3)
+                    continue;
+                art::Runtime& runtime = Android::GetRuntime();
+                // raw field, a cached heap of a stale runtime must not pass.
+                if (!runtime.Ptr() || runtime.heap() != addr)
+                    continue;
+                runtime.GetHeap().SetContinuousSpacesCache(continuous);
+                runtime.GetHeap().SetDiscontinuousSpacesCache(discontinuous);
+            } else if (!strcmp(key, "thread_list")) {
+                uint64_t addr, list;
+                if (sscanf(line, "thread_list %" SCNx64 " %" SCNx64, &addr, &list) != 2)
+                    continue;
+                art::Runtime& runtime = Android::GetRuntime();
+                if (!runtime.Ptr() || runtime.thread_list() != addr)
+                    continue;
+                runtime.GetThreadList().SetListCache(list);
+            } else if (!strcmp(key, "class")) {
+                art::ClassIndex::Entry entry;
+                if (sscanf(line, "class %" SCNx64 "%n", &entry.klass, &pos) != 1)
+                    continue;
+                entry.descriptor = ReadTail(line, pos);
+                classes.push_back(std::move(entry));
+            } else if (!strcmp(key, "method")) {
+                art::MethodIndex::Entry entry;
+                if (sscanf(line, "method %" SCNx64 " %" SCNx64 " %x %d%n", &entry.method,
+                           &entry.entry_point, &entry.dex_method_idx, &entry.code, &pos) != 4)
+                    continue;
+                entry.name = ReadTail(line, pos);
+                methods.push_back(std::move(entry));
+            }
+#endif
+            else {
+                LOGD("Session skip record (%s)\n", key);
+            }
+        }
+    } catch (InvalidAddressException& e) {
+        LOGE("Session %s was interrupted!\n", file);
+    }
+    fclose(fp);
+
+    for (const auto& map : bound)
+        map->ReadSymbols();
+
+#if defined(__AOSP_PARSER__)
+    // after the sdk record, an env switch cleans the indexes.
+    if (classes.size())
+        art::ClassIndex::Load(classes);
+    if (methods.size())
+        art::MethodIndex::Load(methods);
+#endif
+
+    if (verified && (phase & PHASE_ENV))
+        LOGI("Loaded session %s\n", file);
+    return verified;
+}
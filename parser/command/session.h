@@ -0,0 +1,74 @@
+/*
+ * Copyright (C) 2024-present, Guanyou.Chen. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef PARSER_COMMAND_SESSION_H_
+#define PARSER_COMMAND_SESSION_H_
+
+#include <stdint.h>
+#include <string>
+
+/*
+ * session file (text, one record per line):
+ *
+ *   OpenCoreSession <VERSION>
+ *   core <SIZE> <CRC32> <COREFILE>
+ *   pid <PID>
+ *   link <MAP> <BEGIN>
+ *   mmap <VADDR> <OFFSET> <MAP> <FILE>
+ *   sdk <SDK>
+ *   oat <OAT>
+ *   runtime <ADDR>
+ *   heap <ADDR> <CONTINUOUS_SPACES> <DISCONTINUOUS_SPACES>
+ *   thread_list <ADDR> <LIST>
+ *   class <KLASS> <DESCRIPTOR>
+ *   method <METHOD> <ENTRY_POINT> <DEX_METHOD_IDX> <CODE> <NAME>
+ *
+ * CRC32 covers elf header, program headers, notes and SAMPLES pages
+ * spread over the whole core file, so a core rewritten or truncated
+ * in place no longer matches, and it is still cheap on multi-GB cores.
+ * Unknown records are skipped, so newer sections stay loadable.
+ *
+ * link and mmap records are restored before Env::Init, so the android
+ * init already sees the attached files, the rest right after it. sdk
+ * and oat are handed to the init itself, so it builds the art offsets
+ * once and skips the property and kOatVersion lookups.
+ * class and method records are the built ClassIndex and MethodIndex,
+ * restored as ready indexes so commands skip the heap walk.
+ */
+
+class Session {
+public:
+    static constexpr const char* MAGIC = "OpenCoreSession";
+    static constexpr int VERSION = 2;
+    static constexpr int SAMPLES = 64;
+    static constexpr int SAMPLE_SIZE = 4096;
+
+    static constexpr int PHASE_CORE = 1 << 0;
+    static constexpr int PHASE_ENV = 1 << 1;
+
+    struct Saved {
+        int sdk = 0;
+        int oat = 0;
+    };
+
+    static bool Save(const char* file);
+    static bool Load(const char* file, int phase, Saved* saved = nullptr);
+    static bool LoadCore(const char* corefile, const char* file, bool remote);
+    static bool CoreFile(const char* file, std::string* corefile);
+    static uint32_t CoreCRC32();
+};
+
+#endif  // PARSER_COMMAND_SESSION_H_
@@ -21,6 +21,7 @@
 #include "android.h"
 #include "common/elf.h"
 #include "command/env.h"
+#include "command/session.h"
 #include "command/core/cmd_core.h"
 #include "command/command.h"
 #include "command/command_manager.h"
@@ -89,12 +90,14 @@ void show_parser_usage() {
     LOGI("        --page_size <SIZE>   set target core page size\n");
     LOGI("        --no-load            no auto load corefile\n");
     LOGI("        --no-fake-phdr [EXE] rebuild fakecore phdr\n");
+    LOGI("        --session <FILE>     restore env save-session state\n");
     LOGI("Exp:\n");
     LOGI("    core-parser -c /tmp/tmp.core\n");
 #if !defined(__MACOS__)
     LOGI("    core-parser -p 1 -m arm64\n");
 #endif
     LOGI("    core-parser -t tombstone_00 --sysroot symbols\n");
+    LOGI("    core-parser --session /tmp/tmp.core.session\n");
 }
 
 class QuitCommand : public Command {
@@ -128,6 +131,7 @@ int command_preload(int argc, char* const argv[]) {
         {"no-filter-any", no_argument,     0,  2 },
         {"no-load",   no_argument,         0,  6 },
         {"no-fake-phdr",no_argument,       0,  7 },
+        {"session",   required_argument,   0,  8 },
         {"help",      no_argument,         0, 'h'},
         {0,           0,                   0,  0 },
     };
@@ -136,6 +140,7 @@ int command_preload(int argc, char* const argv[]) {
     char* machine = const_cast<char *>(NONE_MACHINE);
     char* tombstone = nullptr;
     char* sysroot = nullptr;
+    char* session = nullptr;
     uint64_t page_size = 0;
     uint64_t va_bits = 0;
     int current_sdk = 0;
@@ -181,6 +186,9 @@ int command_preload(int argc, char* const argv[]) {
             case 7:
                 no_fake_phdr = true;
                 break;
+            case 8:
+                session = optarg;
+                break;
             case 'h':
                 show_parser_usage();
                 return -1;
@@ -233,8 +241,16 @@ int command_preload(int argc, char* const argv[]) {
         corefile = output.data();
     }
 
+    std::string session_core;
+    if (session && !corefile && need_load) {
+        if (Session::CoreFile(session, &session_core))
+            corefile = session_core.data();
+    }
+
     if (corefile && need_load) {
-        if (CoreCommand::Load(corefile, remote)) {
+        bool loaded = session ? Session::LoadCore(corefile, session, remote)
+                              : CoreCommand::Load(corefile, remote);
+        if (loaded) {
 #if defined(__AOSP_PARSER__)
             if (current_sdk) Android::OnSdkChanged(current_sdk);
 #endif
@@ -16,6 +16,7 @@
 
 #include "work/work_thread.h"
 #include "command/command_manager.h"
+#include "common/xz/seekable.h"
 #include <string.h>
 #include <unistd.h>
 #include <getopt.h>
@@ -51,6 +52,8 @@ void WorkThread::run() {
     prepare();
     int optind_backup = optind;
     optind = 0; // reset
+    // nothing reads the decoded core between two commands.
+    xz::Seekable::Trim();
     CommandManager::Execute(cmd, argc, argv);
     if (newline) free(newline);
     optind = optind_backup;
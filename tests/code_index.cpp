@@ -0,0 +1,66 @@
+/*
+ * Copyright (C) 2024-present, Guanyou.Chen. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "runtime/code_index.h"
+#include <inttypes.h>
+#include <stdio.h>
+#include <vector>
+
+static int failures = 0;
+
+static void CheckFind(std::vector<art::CodeIndex::Entry>& entries, uint64_t pc, int expect) {
+    const art::CodeIndex::Entry* entry = art::CodeIndex::Find(entries, pc);
+    int found = entry ? entry - entries.data() : -1;
+    if (found != expect) {
+        printf("FAIL: pc 0x%" PRIx64 " found entry %d, expect %d\n", pc, found, expect);
+        failures++;
+    }
+}
+
+int main() {
+    std::vector<art::CodeIndex::Entry> empty;
+    CheckFind(empty, 0x1000, -1);
+
+    // sorted by code_start like Build() leaves them, with a gap after the
+    // first range and two ranges that touch.
+    std::vector<art::CodeIndex::Entry> entries = {
+        {0x1000, 0x100, 0x70000000, art::CodeIndex::TYPE_OAT, nullptr},
+        {0x1200, 0x80, 0x0, art::CodeIndex::TYPE_STUB, "art_quick_to_interpreter_bridge"},
+        {0x1280, 0x40, 0x70000040, art::CodeIndex::TYPE_JIT, nullptr},
+        {0x2000, 0x1, 0x0, art::CodeIndex::TYPE_NTERP, "nterp"},
+    };
+
+    CheckFind(entries, 0x0, -1);
+    CheckFind(entries, 0xfff, -1);
+    // start is inside, end is outside.
+    CheckFind(entries, 0x1000, 0);
+    CheckFind(entries, 0x10ff, 0);
+    CheckFind(entries, 0x1100, -1);
+    CheckFind(entries, 0x11ff, -1);
+    CheckFind(entries, 0x1200, 1);
+    CheckFind(entries, 0x127f, 1);
+    // the end of one range is the start of the next.
+    CheckFind(entries, 0x1280, 2);
+    CheckFind(entries, 0x12bf, 2);
+    CheckFind(entries, 0x12c0, -1);
+    CheckFind(entries, 0x2000, 3);
+    CheckFind(entries, 0x2001, -1);
+    CheckFind(entries, UINT64_MAX, -1);
+
+    if (!failures)
+        printf("PASS\n");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,124 @@
+/*
+ * Copyright (C) 2024-present, Guanyou.Chen. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "command/android/cmd_jit.h"
+#include <linux/elf.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+// tools/perf/Documentation/jitdump-specification.txt
+static_assert(sizeof(JitCommand::JitDumpHeader) == 40, "jitdump header size");
+static_assert(offsetof(JitCommand::JitDumpHeader, magic) == 0, "header magic");
+static_assert(offsetof(JitCommand::JitDumpHeader, version) == 4, "header version");
+static_assert(offsetof(JitCommand::JitDumpHeader, total_size) == 8, "header total_size");
+static_assert(offsetof(JitCommand::JitDumpHeader, elf_mach) == 12, "header elf_mach");
+static_assert(offsetof(JitCommand::JitDumpHeader, pad1) == 16, "header pad1");
+static_assert(offsetof(JitCommand::JitDumpHeader, pid) == 20, "header pid");
+static_assert(offsetof(JitCommand::JitDumpHeader, timestamp) == 24, "header timestamp");
+static_assert(offsetof(JitCommand::JitDumpHeader, flags) == 32, "header flags");
+
+static_assert(sizeof(JitCommand::JitDumpCodeLoad) == 56, "code load size");
+static_assert(offsetof(JitCommand::JitDumpCodeLoad, id) == 0, "record id");
+static_assert(offsetof(JitCommand::JitDumpCodeLoad, total_size) == 4, "record total_size");
+static_assert(offsetof(JitCommand::JitDumpCodeLoad, timestamp) == 8, "record timestamp");
+static_assert(offsetof(JitCommand::JitDumpCodeLoad, pid) == 16, "code load pid");
+static_assert(offsetof(JitCommand::JitDumpCodeLoad, tid) == 20, "code load tid");
+static_assert(offsetof(JitCommand::JitDumpCodeLoad, vma) == 24, "code load vma");
+static_assert(offsetof(JitCommand::JitDumpCodeLoad, code_addr) == 32, "code load code_addr");
+static_assert(offsetof(JitCommand::JitDumpCodeLoad, code_size) == 40, "code load code_size");
+static_assert(offsetof(JitCommand::JitDumpCodeLoad, code_index) == 48, "code load code_index");
+
+static int failures = 0;
+
+static void Check(bool cond, const char* what) {
+    if (!cond) {
+        printf("FAIL: %s\n", what);
+        failures++;
+    }
+}
+
+struct Load {
+    uint64_t code_start;
+    std::string name;
+    std::vector<uint8_t> code;
+};
+
+int main() {
+    static constexpr uint32_t kPid = 1234;
+    std::vector<Load> loads = {
+        {0x7000001000, "void com.example.Foo.run()", {0xfd, 0x7b, 0xbf, 0xa9, 0xc0, 0x03, 0x5f, 0xd6}},
+        {0x7000002000, "<unknown>", {0x1f, 0x20, 0x03, 0xd5}},
+        // a load clamped to its block carries the bytes read, odd sized.
+        {0x7000003000, "int com.example.Bar.get(int)", {0x01, 0x02, 0x03}},
+    };
+
+    FILE* fp = tmpfile();
+    if (!fp) {
+        printf("FAIL: tmpfile\n");
+        return 1;
+    }
+    JitCommand::WriteJitDumpHeader(fp, EM_AARCH64, kPid);
+    for (uint64_t i = 0; i < loads.size(); ++i) {
+        JitCommand::WriteJitDumpCodeLoad(fp, kPid, loads[i].code_start, loads[i].name,
+                                         loads[i].code.data(), loads[i].code.size(), i);
+    }
+
+    long size = ftell(fp);
+    std::vector<uint8_t> data(size);
+    rewind(fp);
+    Check(fread(data.data(), size, 1, fp) == 1, "read back jitdump");
+    fclose(fp);
+
+    JitCommand::JitDumpHeader header;
+    memcpy(&header, data.data(), sizeof(header));
+    Check(header.magic == JitCommand::JITDUMP_MAGIC, "header magic");
+    Check(header.version == JitCommand::JITDUMP_VERSION, "header version");
+    Check(header.total_size == sizeof(JitCommand::JitDumpHeader), "header total_size");
+    Check(header.elf_mach == EM_AARCH64, "header elf_mach");
+    Check(header.pid == kPid, "header pid");
+
+    // walking by total_size must land on every record and end on the file end.
+    uint64_t pos = header.total_size;
+    for (uint64_t i = 0; i < loads.size(); ++i) {
+        if (pos + sizeof(JitCommand::JitDumpCodeLoad) > data.size()) {
+            Check(false, "record inside the file");
+            break;
+        }
+        JitCommand::JitDumpCodeLoad record;
+        memcpy(&record, data.data() + pos, sizeof(record));
+        Load& load = loads[i];
+        Check(record.id == JitCommand::JIT_CODE_LOAD, "record id");
+        Check(record.total_size == sizeof(record) + load.name.length() + 1 + load.code.size(), "record total_size");
+        Check(record.pid == kPid && record.tid == kPid, "record pid and tid");
+        Check(record.vma == load.code_start && record.code_addr == load.code_start, "record vma and code_addr");
+        Check(record.code_size == load.code.size(), "record code_size");
+        Check(record.code_index == i, "record code_index");
+
+        const char* name = reinterpret_cast<const char *>(data.data() + pos + sizeof(record));
+        Check(load.name == name, "record name");
+        const uint8_t* code = data.data() + pos + sizeof(record) + load.name.length() + 1;
+        Check(!memcmp(code, load.code.data(), load.code.size()), "record code");
+        pos += record.total_size;
+    }
+    Check(pos == data.size(), "records end on the file end");
+
+    if (!failures)
+        printf("PASS\n");
+    return failures ? 1 : 0;
+}
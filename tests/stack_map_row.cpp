@@ -0,0 +1,99 @@
+/*
+ * Copyright (C) 2024-present, Guanyou.Chen. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "runtime/oat/stack_map.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <vector>
+
+static int failures = 0;
+
+/*
+ * The row walk NativePc2DexPc did before the binary search, it stops on
+ * the first stack map after native_pc and otherwise keeps the last row.
+ */
+static int32_t LinearRow(std::vector<art::GeneralStackMap>& maps, uint32_t native_pc) {
+    int32_t current = -1;
+    for (int32_t row = 0; row < static_cast<int32_t>(maps.size()); row++) {
+        current = row;
+        if (maps[row].native_pc > native_pc)
+            break;
+    }
+    return current;
+}
+
+static void CheckRows(std::vector<art::GeneralStackMap>& maps, bool sorted, const char* what) {
+    std::vector<uint32_t> pcs = {0, UINT32_MAX};
+    for (const auto& map : maps) {
+        pcs.push_back(map.native_pc);
+        pcs.push_back(map.native_pc - 1);
+        pcs.push_back(map.native_pc + 1);
+    }
+
+    for (uint32_t pc : pcs) {
+        int32_t expect = LinearRow(maps, pc);
+        int32_t row = art::CodeInfo::FindRow(maps, sorted, pc);
+        if (row != expect) {
+            printf("FAIL: %s native_pc 0x%x row %d, linear row %d\n", what, pc, row, expect);
+            failures++;
+            return;
+        }
+    }
+}
+
+static std::vector<art::GeneralStackMap> MakeMaps(std::vector<uint32_t> pcs) {
+    std::vector<art::GeneralStackMap> maps;
+    for (uint32_t i = 0; i < pcs.size(); ++i)
+        maps.push_back({pcs[i], i});
+    return maps;
+}
+
+int main() {
+    std::vector<art::GeneralStackMap> empty;
+    CheckRows(empty, true, "empty");
+    if (art::CodeInfo::FindRow(empty, true, 0x10) != -1) {
+        printf("FAIL: empty maps must have no row\n");
+        failures++;
+    }
+
+    std::vector<art::GeneralStackMap> one = MakeMaps({0x20});
+    CheckRows(one, true, "one row");
+
+    std::vector<art::GeneralStackMap> dups = MakeMaps({0x0, 0x8, 0x8, 0x8, 0x40, 0x40, 0x100});
+    CheckRows(dups, true, "duplicate native pcs");
+
+    std::vector<art::GeneralStackMap> unsorted = MakeMaps({0x40, 0x8, 0x100, 0x20});
+    CheckRows(unsorted, false, "unsorted linear scan");
+
+    srand(0x5eed);
+    for (int round = 0; round < 200; ++round) {
+        std::vector<uint32_t> pcs(1 + rand() % 64);
+        uint32_t pc = rand() % 16;
+        for (auto& value : pcs) {
+            value = pc;
+            pc += rand() % 3 ? rand() % 0x40 : 0;
+        }
+        std::vector<art::GeneralStackMap> maps = MakeMaps(pcs);
+        CheckRows(maps, true, "random sorted");
+        if (failures)
+            break;
+    }
+
+    if (!failures)
+        printf("PASS\n");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,129 @@
+/*
+ * Copyright (C) 2024-present, Guanyou.Chen. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "common/xz/seekable.h"
+#include "base/memory_map.h"
+#include <linux/elf.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+static int failures = 0;
+
+#if defined(__LZMA__)
+static void Check(bool cond, const char* what) {
+    if (!cond) {
+        printf("FAIL: %s\n", what);
+        failures++;
+    }
+}
+
+static constexpr uint64_t kBlockSize = 64 * 1024;
+static constexpr uint64_t kCoreSize = 64 * kBlockSize;
+static constexpr uint64_t kCacheLimit = 8 * kBlockSize;
+
+static bool WriteCore(const char* file, std::vector<uint8_t>& raw) {
+    raw.resize(kCoreSize);
+    uint64_t seed = 0x9e3779b97f4a7c15ULL;
+    for (uint64_t i = 0; i < kCoreSize; i += sizeof(uint64_t)) {
+        // half pattern, half noise, so blocks are neither empty nor incompressible.
+        seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+        uint64_t value = (i & 0x100) ? seed : i;
+        memcpy(raw.data() + i, &value, sizeof(value));
+    }
+    memcpy(raw.data(), ELFMAG, SELFMAG);
+
+    FILE* fp = fopen(file, "wb");
+    if (!fp)
+        return false;
+    bool ok = fwrite(raw.data(), raw.size(), 1, fp) == 1;
+    fclose(fp);
+    return ok;
+}
+
+static bool Same(xz::SeekableMap* map, std::vector<uint8_t>& raw, uint64_t offset, uint64_t size) {
+    if (!map->Fill(map->data() + offset, size))
+        return false;
+    return !memcmp(reinterpret_cast<void *>(map->data() + offset), raw.data() + offset, size);
+}
+
+static void TestWindow(xz::SeekableMap* map, std::vector<uint8_t>& raw) {
+    Check(map->size() == kCoreSize, "decoded size");
+    Check(map->numBlocks() == kCoreSize / kBlockSize, "block count");
+    Check(Same(map, raw, 0, 4096), "first page");
+    Check(Same(map, raw, kBlockSize - 100, 200), "window across a block boundary");
+    Check(Same(map, raw, kCoreSize - 4096, 4096), "last page");
+    Check(Same(map, raw, 3 * kBlockSize + 17, 2 * kBlockSize), "window over three blocks");
+}
+
+static void TestEviction(xz::SeekableMap* map, std::vector<uint8_t>& raw) {
+    // every block twice, far more than the cache holds.
+    for (int pass = 0; pass < 2; ++pass) {
+        for (uint64_t offset = 0; offset < kCoreSize; offset += kBlockSize / 2) {
+            if (!Same(map, raw, offset, kBlockSize / 2)) {
+                Check(false, "window after the cache cycled");
+                return;
+            }
+        }
+    }
+
+    xz::Seekable::Trim();
+    Check(map->residentSize() <= kCacheLimit, "resident bytes under the limit after Trim");
+    // evicted blocks are paged back in or decoded again.
+    Check(Same(map, raw, 0, kBlockSize), "first block after Trim");
+    Check(Same(map, raw, kCoreSize / 2, kBlockSize), "middle block after Trim");
+}
+#endif
+
+int main() {
+#if defined(__LZMA__)
+    const char* tmpdir = getenv("TMPDIR");
+    std::string dir = tmpdir ? tmpdir : "/tmp";
+    std::string input = dir + "/xz_seekable_" + std::to_string(getpid()) + ".core";
+    std::string output = input + ".xz";
+
+    std::vector<uint8_t> raw;
+    if (!WriteCore(input.c_str(), raw)
+            || !xz::Seekable::Repack(input.c_str(), output.c_str(), kBlockSize, 0)) {
+        printf("FAIL: repack %s\n", input.c_str());
+        unlink(input.c_str());
+        return 1;
+    }
+    unlink(input.c_str());
+    Check(xz::Seekable::IsSeekable(output.c_str()), "repacked core is seekable");
+
+    xz::Seekable::SetCacheLimit(kCacheLimit);
+    std::unique_ptr<MemoryMap> map(xz::Seekable::MmapFile(output.c_str()));
+    unlink(output.c_str());
+    if (!map) {
+        printf("FAIL: open %s\n", output.c_str());
+        return 1;
+    }
+
+    xz::SeekableMap* seekable = static_cast<xz::SeekableMap*>(map.get());
+    TestWindow(seekable, raw);
+    TestEviction(seekable, raw);
+#else
+    printf("SKIP: built without liblzma\n");
+#endif
+    if (!failures)
+        printf("PASS\n");
+    return failures ? 1 : 0;
+}
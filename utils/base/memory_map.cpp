@@ -77,6 +77,7 @@ MemoryMap* MemoryMap::MmapMem(uint64_t addr, uint64_t size, uint64_t realSize) {
     void* mem = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANON, 0, 0);
     if (mem != MAP_FAILED) {
         map = new MemoryMap(mem, size, 0, size);
+        map->mAnon = true;
         memcpy(mem, reinterpret_cast<void *>(addr), realSize);
     }
     return map;
@@ -87,6 +88,7 @@ MemoryMap* MemoryMap::MmapZeroMem(uint64_t size) {
     void* mem = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANON, 0, 0);
     if (mem != MAP_FAILED) {
         map = new MemoryMap(mem, size, 0, size);
+        map->mAnon = true;
         memset(mem, 0x0, size);
     }
     return map;
@@ -98,6 +100,29 @@ void MemoryMap::setFile(const char* file, uint64_t off) {
     mOffset = off;
 }
 
+void MemoryMap::Advise(uint64_t addr, uint64_t size, int advice) {
+    /*
+     * anon memory holds the only copy of its data (overlay, decoded
+     * or copied mmap), dropping it would lose the content.
+     */
+    if (mAnon && advice == ADVICE_DONTNEED)
+        return;
+
+    uint64_t page_size = sysconf(_SC_PAGE_SIZE);
+    uint64_t begin = std::max(addr, data()) & ~(page_size - 1);
+    uint64_t end = std::min(addr + size, data() + mSize);
+    if (begin >= end)
+        return;
+
+    int madv = MADV_NORMAL;
+    switch (advice) {
+        case ADVICE_SEQUENTIAL: madv = MADV_SEQUENTIAL; break;
+        case ADVICE_WILLNEED: madv = MADV_WILLNEED; break;
+        case ADVICE_DONTNEED: madv = MADV_DONTNEED; break;
+    }
+    madvise(reinterpret_cast<void *>(begin), end - begin, madv);
+}
+
 uint32_t MemoryMap::GetCRC32() {
     return Utils::CRC32(reinterpret_cast<uint8_t *>(mBegin), mSize);
 }
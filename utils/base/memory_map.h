@@ -23,6 +23,11 @@
 
 class MemoryMap {
 public:
+    static constexpr int ADVICE_NORMAL = 0;
+    static constexpr int ADVICE_SEQUENTIAL = 1;
+    static constexpr int ADVICE_WILLNEED = 2;
+    static constexpr int ADVICE_DONTNEED = 3;
+
     static MemoryMap* MmapFile(const char* file);
     static MemoryMap* MmapFile(const char* file, uint64_t off);
     static MemoryMap* MmapFile(const char* file, uint64_t size, uint64_t off);
@@ -36,17 +41,24 @@ public:
     inline std::string& getName() { return mName; }
     uint32_t GetCRC32();
     void setFile(const char* file, uint64_t off);
-    ~MemoryMap();
+    virtual void Advise(uint64_t addr, uint64_t size, int advice);
+    // lazily decoded maps fill [addr, addr + size) before it is read,
+    // a new epoch means filled ranges may have been dropped since.
+    virtual bool Fill(uint64_t /*addr*/, uint64_t /*size*/) { return true; }
+    virtual uint64_t Epoch() { return 0; }
+    virtual ~MemoryMap();
 private:
     static MemoryMap* MmapFile(int fd, uint64_t size, uint64_t off);
+protected:
     MemoryMap(void *m, uint64_t s, uint64_t off, uint64_t max)
-        : mBegin(m), mSize(s), mOffset(off), mMaxSize(max) {}
+        : mBegin(m), mSize(s), mOffset(off), mMaxSize(max), mAnon(false) {}
 
     std::string mName;
     void* mBegin;
     uint64_t mSize;
     uint64_t mOffset;
     uint64_t mMaxSize;
+    bool mAnon;
 };
 
 #endif  // UTILS_BASE_MEMORY_MAP_H_
@@ -0,0 +1,36 @@
+/*
+ * Copyright (C) 2024-present, Guanyou.Chen. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "base/time_profile.h"
+#include <string.h>
+
+std::vector<TimeProfile::Phase> TimeProfile::kPhases;
+
+void TimeProfile::Record(const char* name, uint64_t nanos) {
+    for (auto& phase : kPhases) {
+        if (!strcmp(phase.name.c_str(), name)) {
+            phase.count++;
+            phase.nanos += nanos;
+            return;
+        }
+    }
+    kPhases.push_back({name, 1, nanos});
+}
+
+void TimeProfile::Foreach(std::function<void (Phase& phase)> callback) {
+    for (auto& phase : kPhases)
+        callback(phase);
+}
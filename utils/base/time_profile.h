@@ -0,0 +1,61 @@
+/*
+ * Copyright (C) 2024-present, Guanyou.Chen. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef UTILS_BASE_TIME_PROFILE_H_
+#define UTILS_BASE_TIME_PROFILE_H_
+
+#include <stdint.h>
+#include <chrono>
+#include <functional>
+#include <string>
+#include <vector>
+
+/*
+ * Accumulated wall time of named init phases, in first-seen order.
+ *
+ *   {
+ *       TimeProfile::Scope scope("android: properties");
+ *       ...
+ *   }
+ */
+class TimeProfile {
+public:
+    struct Phase {
+        std::string name;
+        uint64_t count;
+        uint64_t nanos;
+    };
+
+    class Scope {
+    public:
+        Scope(const char* n) : name(n), start(std::chrono::steady_clock::now()) {}
+        ~Scope() {
+            auto diff = std::chrono::steady_clock::now() - start;
+            TimeProfile::Record(name, std::chrono::duration_cast<std::chrono::nanoseconds>(diff).count());
+        }
+    private:
+        const char* name;
+        std::chrono::steady_clock::time_point start;
+    };
+
+    static void Record(const char* name, uint64_t nanos);
+    static void Foreach(std::function<void (Phase& phase)> callback);
+    static void Clean() { kPhases.clear(); }
+private:
+    static std::vector<Phase> kPhases;
+};
+
+#endif // UTILS_BASE_TIME_PROFILE_H_